@@ -6,6 +6,7 @@
 #endif
 #include <execinfo.h>
 #include <pthread.h>
+#include <sched.h>
 #include <sys/syscall.h>
 #include <unistd.h>
 
@@ -94,6 +95,28 @@ void sleepUsec(int64_t usec) {
   std::this_thread::sleep_for(std::chrono::microseconds(usec));
 }
 
+bool setCpuAffinity(std::span<const int> cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (const int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &set);
+    }
+  }
+  return CPU_COUNT(&set) > 0 &&
+         ::pthread_setaffinity_np(::pthread_self(), sizeof set, &set) == 0;
+}
+
+bool setLocalMemoryPolicy() {
+#ifdef SYS_set_mempolicy
+  // MPOL_LOCAL from <linux/mempolicy.h>, without requiring libnuma.
+  constexpr int kMpolLocal = 4;
+  return ::syscall(SYS_set_mempolicy, kMpolLocal, nullptr, 0) == 0;
+#else
+  return false;
+#endif
+}
+
 string stackTrace(bool demangle) {
 #if MUDUO_HAS_CPP23_STACKTRACE
   (void)demangle;
@@ -5,6 +5,7 @@
 #include <array>
 #include <cstdint>
 #include <pthread.h>
+#include <span>
 #include <string_view>
 
 namespace muduo::CurrentThread {
@@ -35,6 +36,12 @@ void setName(const char *name);
 
 [[nodiscard]] bool isMainThread();
 void sleepUsec(int64_t usec);
+// Restricts the calling thread to cpus; false, changing nothing, if none of
+// them is usable.
+bool setCpuAffinity(std::span<const int> cpus);
+// Makes the calling thread's new pages come from the NUMA node of the CPU
+// that touches them first (MPOL_LOCAL); false if the kernel lacks NUMA.
+bool setLocalMemoryPolicy();
 
 [[nodiscard]] string stackTrace(bool demangle);
 
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "muduo/base/noncopyable.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace muduo {
+
+// Intrusive multi-producer/single-consumer queue (Vyukov's design). push()
+// is lock-free and does not allocate once the node pool has grown to the
+// peak number of queued elements; consume() must only be called from one
+// thread at a time.
+//
+// Nodes live in chunks owned by the queue and are addressed by index, so the
+// free list can carry an ABA tag in the same 64-bit word. Chunks are only
+// released with the queue.
+//
+// A producer preempted between its two push steps hides the elements behind
+// it until it resumes; consume() then stops early and the caller picks them
+// up on a later call. push() always completes before it returns, so a
+// consumer woken after push() sees the element.
+template <typename T>
+  requires std::movable<T> && std::default_initializable<T>
+class MpscQueue : noncopyable {
+public:
+  MpscQueue() : head_(&stub_), tail_(&stub_) {}
+
+  ~MpscQueue() {
+    (void)consume([](T &) {});
+    const auto chunks =
+        std::min(numChunks_.load(std::memory_order_acquire), kMaxChunks);
+    for (std::uint32_t c = 0; c < chunks; ++c) {
+      delete chunks_[c].load(std::memory_order_acquire);
+    }
+  }
+
+  void push(T value) {
+    Node *node = acquireNode();
+    node->value = std::move(value);
+    node->next.store(nullptr, std::memory_order_relaxed);
+    size_.fetch_add(1, std::memory_order_relaxed);
+    link(node);
+  }
+
+  // Consumer only. Hands at most maxCount elements to f in FIFO order per
+  // producer and returns how many were consumed. f may push() more.
+  template <typename F>
+    requires std::invocable<F &, T &>
+  size_t consume(F &&f, size_t maxCount = std::numeric_limits<size_t>::max()) {
+    size_t count = 0;
+    std::uint32_t first = kNoIndex;
+    Node *last = nullptr;
+    while (count < maxCount) {
+      Node *node = popNode();
+      if (node == nullptr) {
+        break;
+      }
+      T value(std::move(node->value));
+      if (node->index == kNoIndex) {
+        delete node;
+      } else {
+        // Collected into one chain, returned with a single CAS below.
+        node->nextFree.store(first, std::memory_order_relaxed);
+        first = node->index;
+        if (last == nullptr) {
+          last = node;
+        }
+      }
+      ++count;
+      size_.fetch_sub(1, std::memory_order_relaxed);
+      f(value);
+    }
+    if (last != nullptr) {
+      releaseNodes(first, last);
+    }
+    return count;
+  }
+
+  // Approximate while producers are active.
+  [[nodiscard]] size_t size() const noexcept {
+    return size_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+private:
+  static constexpr std::uint32_t kNoIndex = UINT32_MAX;
+  static constexpr std::uint32_t kChunkNodes = 256;
+  // Beyond kChunkNodes * kMaxChunks queued elements, nodes come from the heap.
+  static constexpr std::uint32_t kMaxChunks = 1024;
+
+  struct Node {
+    std::atomic<Node *> next{nullptr};
+    // Free-list link; atomic because a losing acquireNode() may still read it.
+    std::atomic<std::uint32_t> nextFree{kNoIndex};
+    // Position in chunks_, or kNoIndex for heap nodes and the stub.
+    std::uint32_t index{kNoIndex};
+    T value{};
+  };
+  struct Chunk {
+    std::array<Node, kChunkNodes> nodes;
+  };
+
+  // Free-list head: ABA tag in the high half, node index in the low half.
+  [[nodiscard]] static std::uint64_t packFree(std::uint64_t tag,
+                                              std::uint32_t index) {
+    return (tag << 32) | index;
+  }
+
+  [[nodiscard]] Node *nodeAt(std::uint32_t index) const {
+    Chunk *chunk = chunks_[index / kChunkNodes].load(std::memory_order_acquire);
+    return &chunk->nodes[index % kChunkNodes];
+  }
+
+  Node *acquireNode() {
+    std::uint64_t head = freeHead_.load(std::memory_order_acquire);
+    while (static_cast<std::uint32_t>(head) != kNoIndex) {
+      Node *node = nodeAt(static_cast<std::uint32_t>(head));
+      const std::uint32_t next = node->nextFree.load(std::memory_order_relaxed);
+      if (freeHead_.compare_exchange_weak(head, packFree((head >> 32) + 1, next),
+                                          std::memory_order_acquire,
+                                          std::memory_order_acquire)) {
+        return node;
+      }
+    }
+    return growPool();
+  }
+
+  // Hands out the first node of a fresh chunk and frees the rest.
+  Node *growPool() {
+    const std::uint32_t c = numChunks_.fetch_add(1, std::memory_order_relaxed);
+    if (c >= kMaxChunks) {
+      return new Node;
+    }
+    auto *chunk = new Chunk;
+    const std::uint32_t base = c * kChunkNodes;
+    for (std::uint32_t i = 0; i < kChunkNodes; ++i) {
+      chunk->nodes[i].index = base + i;
+      chunk->nodes[i].nextFree.store(base + i + 1, std::memory_order_relaxed);
+    }
+    chunks_[c].store(chunk, std::memory_order_release);
+    releaseNodes(base + 1, &chunk->nodes[kChunkNodes - 1]);
+    return &chunk->nodes[0];
+  }
+
+  // Pushes the chain starting at index first and ending at last.
+  void releaseNodes(std::uint32_t first, Node *last) {
+    std::uint64_t head = freeHead_.load(std::memory_order_relaxed);
+    do {
+      last->nextFree.store(static_cast<std::uint32_t>(head),
+                           std::memory_order_relaxed);
+    } while (!freeHead_.compare_exchange_weak(
+        head, packFree((head >> 32) + 1, first), std::memory_order_release,
+        std::memory_order_relaxed));
+  }
+
+  void link(Node *node) {
+    Node *prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  Node *popNode() {
+    Node *tail = tail_;
+    Node *next = tail->next.load(std::memory_order_acquire);
+    if (tail == &stub_) {
+      if (next == nullptr) {
+        return nullptr;
+      }
+      tail_ = next;
+      tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+    if (next != nullptr) {
+      tail_ = next;
+      return tail;
+    }
+    if (tail != head_.load(std::memory_order_acquire)) {
+      // A producer swapped head_ but has not linked its node yet.
+      return nullptr;
+    }
+    // tail is the last node; park the stub behind it so it can be handed out.
+    stub_.next.store(nullptr, std::memory_order_relaxed);
+    link(&stub_);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+      tail_ = next;
+      return tail;
+    }
+    return nullptr;
+  }
+
+  alignas(64) std::atomic<Node *> head_;
+  std::atomic<size_t> size_{0};
+  alignas(64) std::atomic<std::uint64_t> freeHead_{packFree(0, kNoIndex)};
+  std::atomic<std::uint32_t> numChunks_{0};
+  alignas(64) Node *tail_;
+  Node stub_;
+  std::array<std::atomic<Chunk *>, kMaxChunks> chunks_{};
+};
+
+} // namespace muduo
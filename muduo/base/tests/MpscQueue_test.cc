@@ -0,0 +1,111 @@
+#include "muduo/base/MpscQueue.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+TEST(MpscQueueTest, SingleThreadFifo) {
+  muduo::MpscQueue<int> queue;
+  EXPECT_TRUE(queue.empty());
+  for (int i = 0; i < 5; ++i) {
+    queue.push(i);
+  }
+  EXPECT_EQ(queue.size(), 5u);
+
+  std::vector<int> out;
+  EXPECT_EQ(queue.consume([&out](int &v) { out.push_back(v); }), 5u);
+  EXPECT_EQ(out, (std::vector<int>{0, 1, 2, 3, 4}));
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(queue.consume([](int &) {}), 0u);
+}
+
+TEST(MpscQueueTest, ConsumeHonoursMaxCount) {
+  muduo::MpscQueue<int> queue;
+  for (int i = 0; i < 10; ++i) {
+    queue.push(i);
+  }
+  std::vector<int> out;
+  EXPECT_EQ(queue.consume([&out](int &v) { out.push_back(v); }, 4), 4u);
+  EXPECT_EQ(queue.size(), 6u);
+  EXPECT_EQ(queue.consume([&out](int &v) { out.push_back(v); }), 6u);
+  ASSERT_EQ(out.size(), 10u);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(out[static_cast<size_t>(i)], i);
+  }
+}
+
+TEST(MpscQueueTest, PushFromConsumerCallback) {
+  muduo::MpscQueue<int> queue;
+  queue.push(1);
+  std::vector<int> out;
+  // Bounded by the size before the call, so the re-pushed element is left.
+  EXPECT_EQ(queue.consume(
+                [&](int &v) {
+                  out.push_back(v);
+                  queue.push(v + 1);
+                },
+                queue.size()),
+            1u);
+  EXPECT_EQ(queue.size(), 1u);
+  EXPECT_EQ(queue.consume([&out](int &v) { out.push_back(v); }), 1u);
+  EXPECT_EQ(out, (std::vector<int>{1, 2}));
+}
+
+TEST(MpscQueueTest, ReleasesElementsAfterConsumeAndOnDestruction) {
+  auto tracked = std::make_shared<int>(42);
+  {
+    muduo::MpscQueue<std::shared_ptr<int>> queue;
+    queue.push(tracked);
+    queue.push(tracked);
+    EXPECT_EQ(tracked.use_count(), 3);
+    EXPECT_EQ(queue.consume([](std::shared_ptr<int> &) {}, 1), 1u);
+    EXPECT_EQ(tracked.use_count(), 2);
+  }
+  EXPECT_EQ(tracked.use_count(), 1);
+}
+
+TEST(MpscQueueTest, ManyProducersNoLossAndPerProducerOrder) {
+  constexpr int kProducers = 4;
+  constexpr int kPerProducer = 50'000;
+  muduo::MpscQueue<int> queue;
+
+  std::atomic<bool> go{false};
+  std::vector<std::thread> producers;
+  producers.reserve(kProducers);
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&queue, &go, p] {
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      for (int i = 0; i < kPerProducer; ++i) {
+        queue.push(p * kPerProducer + i);
+      }
+    });
+  }
+
+  std::vector<int> next(kProducers, 0);
+  int total = 0;
+  bool ordered = true;
+  go.store(true, std::memory_order_release);
+  while (total < kProducers * kPerProducer) {
+    total += static_cast<int>(queue.consume([&](int &v) {
+      const int p = v / kPerProducer;
+      ordered = ordered && v % kPerProducer == next[static_cast<size_t>(p)];
+      ++next[static_cast<size_t>(p)];
+    }));
+  }
+  for (auto &t : producers) {
+    t.join();
+  }
+
+  EXPECT_TRUE(ordered);
+  EXPECT_EQ(total, kProducers * kPerProducer);
+  EXPECT_TRUE(queue.empty());
+}
+
+} // namespace
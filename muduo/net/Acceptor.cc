@@ -39,20 +39,39 @@ void Acceptor::listen() {
   acceptChannel_.enableReading();
 }
 
+InetAddress Acceptor::listenAddress() const {
+  return InetAddress(sockets::getLocalAddr(acceptSocket_.fd()));
+}
+
 void Acceptor::handleRead() {
   loop_->assertInLoopThread();
 
-  InetAddress peerAddr;
-  const int connfd = acceptSocket_.accept(&peerAddr);
-  if (connfd >= 0) {
-    if (newConnectionCallback_) {
+  for (size_t n = 0; n < acceptBatch_; ++n) {
+    InetAddress peerAddr;
+    const int connfd = acceptSocket_.accept(&peerAddr);
+    if (connfd < 0) {
+      handleAcceptError();
+      break;
+    }
+    if (newConnectionBatchCallback_) {
+      accepted_.push_back({connfd, peerAddr});
+    } else if (newConnectionCallback_) {
       newConnectionCallback_(connfd, peerAddr);
     } else {
       sockets::close(connfd);
     }
-    return;
   }
 
+  if (!accepted_.empty()) {
+    newConnectionBatchCallback_(accepted_);
+    accepted_.clear();
+  }
+}
+
+void Acceptor::handleAcceptError() {
+  if (errno == EAGAIN) {
+    return;
+  }
   muduo::logSysErr("Acceptor::handleRead");
 
   if (errno == EMFILE) {
@@ -3,20 +3,28 @@
 #include "muduo/base/noncopyable.h"
 #include "muduo/net/Callbacks.h"
 #include "muduo/net/Channel.h"
+#include "muduo/net/InetAddress.h"
 #include "muduo/net/Socket.h"
 
 #include <concepts>
+#include <span>
 #include <type_traits>
+#include <vector>
 
 namespace muduo::net {
 
 class EventLoop;
-class InetAddress;
 
 class Acceptor : muduo::noncopyable {
 public:
   using NewConnectionCallback =
       CallbackFunction<void(int sockfd, const InetAddress &)>;
+  struct Accepted {
+    int sockfd;
+    InetAddress peerAddr;
+  };
+  using NewConnectionBatchCallback =
+      CallbackFunction<void(std::span<const Accepted>)>;
 
   Acceptor(EventLoop *loop, const InetAddress &listenAddr, bool reusePort);
   ~Acceptor();
@@ -26,18 +34,42 @@ public:
   void setNewConnectionCallback(F &&cb) {
     newConnectionCallback_ = NewConnectionCallback(std::forward<F>(cb));
   }
+  // Gets everything one readiness event accepted in one call; takes
+  // precedence over the per-connection callback.
+  template <typename F>
+    requires CallbackBindable<F, NewConnectionBatchCallback>
+  void setNewConnectionBatchCallback(F &&cb) {
+    newConnectionBatchCallback_ =
+        NewConnectionBatchCallback(std::forward<F>(cb));
+  }
+  // Accepts up to maxAccepts connections per readiness event, until EAGAIN,
+  // instead of one. Loop thread only.
+  void setAcceptBatch(size_t maxAccepts) {
+    acceptBatch_ = maxAccepts > 0 ? maxAccepts : 1;
+  }
+
+  // See Socket::setIncomingCpu. Call before listen().
+  void setIncomingCpu(int cpu) { (void)acceptSocket_.setIncomingCpu(cpu); }
 
   void listen();
 
+  [[nodiscard]] EventLoop *getLoop() const noexcept { return loop_; }
   [[nodiscard]] bool listening() const noexcept { return listening_; }
+  // The bound address, with the port the kernel picked for port 0.
+  [[nodiscard]] InetAddress listenAddress() const;
 
 private:
   void handleRead();
+  void handleAcceptError();
 
   EventLoop *loop_;
   Socket acceptSocket_;
   Channel acceptChannel_;
   NewConnectionCallback newConnectionCallback_;
+  NewConnectionBatchCallback newConnectionBatchCallback_;
+  size_t acceptBatch_{1};
+  // Reused by each batch.
+  std::vector<Accepted> accepted_;
   bool listening_{false};
   int idleFd_;
 };
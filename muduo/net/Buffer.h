@@ -2,6 +2,7 @@
 
 #include "muduo/base/Types.h"
 #include "muduo/base/copyable.h"
+#include "muduo/net/ByteScan.h"
 #include "muduo/net/Endian.h"
 #if MUDUO_ENABLE_LEGACY_COMPAT
 #include "muduo/base/StringPiece.h"
@@ -69,13 +70,8 @@ public:
   [[nodiscard]] const std::byte *findCRLF(const std::byte *start) const {
     assert(peek() <= start);
     assert(start <= beginWrite());
-    auto haystack = std::span{start, static_cast<size_t>(beginWrite() - start)};
-    if (auto match = std::ranges::search(haystack, kCRLF);
-        match.begin() == haystack.end()) {
-      return nullptr;
-    } else {
-      return std::to_address(match.begin());
-    }
+    return scan::findCRLF(
+        std::span{start, static_cast<size_t>(beginWrite() - start)});
   }
   [[nodiscard]] const char *findCRLFChars(const char *start) const {
     const auto *crlf = findCRLF(charsToBytes(start));
@@ -87,12 +83,29 @@ public:
   [[nodiscard]] const std::byte *findEOL(const std::byte *start) const {
     assert(peek() <= start);
     assert(start <= beginWrite());
-    auto haystack = std::span{start, static_cast<size_t>(beginWrite() - start)};
-    auto it = std::ranges::find(haystack, std::byte{'\n'});
-    if (it == haystack.end()) {
-      return nullptr;
+    return scan::findByte(
+        std::span{start, static_cast<size_t>(beginWrite() - start)},
+        std::byte{'\n'});
+  }
+
+  // Stores the offsets from peek() of each CRLF at or after start, in order,
+  // until offsets is full, scanning once; returns how many it stored.
+  [[nodiscard]] size_t findAllCRLF(std::span<size_t> offsets) const {
+    return findAllCRLF(offsets, peek());
+  }
+  [[nodiscard]] size_t findAllCRLF(std::span<size_t> offsets,
+                                   const std::byte *start) const {
+    assert(peek() <= start);
+    assert(start <= beginWrite());
+    const size_t found = scan::findAllCRLF(
+        std::span{start, static_cast<size_t>(beginWrite() - start)}, offsets);
+    const auto skipped = static_cast<size_t>(start - peek());
+    if (skipped > 0) {
+      for (size_t &offset : offsets.first(found)) {
+        offset += skipped;
+      }
     }
-    return std::to_address(it);
+    return found;
   }
 
   void retrieve(size_t len) {
@@ -328,9 +341,6 @@ private:
   std::vector<std::byte> buffer_;
   size_t readerIndex_;
   size_t writerIndex_;
-
-  static constexpr std::array<std::byte, 2> kCRLF{std::byte{'\r'},
-                                                  std::byte{'\n'}};
 };
 
 } // namespace muduo::net
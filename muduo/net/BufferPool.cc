@@ -0,0 +1,96 @@
+#include "muduo/net/BufferPool.h"
+
+#include "muduo/net/EventLoop.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace muduo::net;
+
+BufferPool::Slab BufferPool::acquire() {
+  slabsInUse_.fetch_add(1, std::memory_order_relaxed);
+  if (free_.empty()) {
+    return std::make_unique_for_overwrite<std::byte[]>(kSlabSize);
+  }
+  Slab slab = std::move(free_.back());
+  free_.pop_back();
+  freeSlabs_.store(static_cast<std::int64_t>(free_.size()),
+                   std::memory_order_relaxed);
+  return slab;
+}
+
+void BufferPool::release(Slab slab) {
+  assert(slab != nullptr);
+  slabsInUse_.fetch_sub(1, std::memory_order_relaxed);
+  if (free_.size() < maxFreeSlabs_) {
+    free_.push_back(std::move(slab));
+    freeSlabs_.store(static_cast<std::int64_t>(free_.size()),
+                     std::memory_order_relaxed);
+  }
+}
+
+void BufferPool::setMaxFreeBytes(size_t bytes) {
+  maxFreeSlabs_ = bytes / kSlabSize;
+  if (free_.size() > maxFreeSlabs_) {
+    free_.resize(maxFreeSlabs_);
+    free_.shrink_to_fit();
+    freeSlabs_.store(static_cast<std::int64_t>(free_.size()),
+                     std::memory_order_relaxed);
+  }
+}
+
+BufferPool::Stats BufferPool::stats() const {
+  return {slabsInUse_.load(std::memory_order_relaxed),
+          freeSlabs_.load(std::memory_order_relaxed),
+          idleConnections_.load(std::memory_order_relaxed),
+          idleBufferBytes_.load(std::memory_order_relaxed)};
+}
+
+size_t BufferPool::watchIdle(std::chrono::microseconds timeout,
+                             IdleCheck check) {
+  assert(loop_ != nullptr);
+  loop_->assertInLoopThread();
+  size_t handle = idleChecks_.size();
+  if (freeIdleSlots_.empty()) {
+    idleChecks_.push_back(std::move(check));
+  } else {
+    handle = freeIdleSlots_.back();
+    freeIdleSlots_.pop_back();
+    idleChecks_[handle] = std::move(check);
+  }
+  ++watchedIdle_;
+
+  const auto period = std::max(timeout / 2, std::chrono::microseconds{1});
+  if (sweepPeriod_ == std::chrono::microseconds::zero() ||
+      period < sweepPeriod_) {
+    if (sweepTimer_.valid()) {
+      loop_->cancel(sweepTimer_);
+    }
+    sweepPeriod_ = period;
+    sweepTimer_ =
+        loop_->runEvery(period, period / 4, [this] { sweepIdle(); });
+  }
+  return handle;
+}
+
+void BufferPool::unwatchIdle(size_t handle) {
+  loop_->assertInLoopThread();
+  assert(handle < idleChecks_.size() && idleChecks_[handle]);
+  idleChecks_[handle] = IdleCheck{};
+  freeIdleSlots_.push_back(handle);
+  if (--watchedIdle_ == 0) {
+    loop_->cancel(sweepTimer_);
+    sweepTimer_ = TimerId();
+    sweepPeriod_ = std::chrono::microseconds::zero();
+    idleChecks_.clear();
+    freeIdleSlots_.clear();
+  }
+}
+
+void BufferPool::sweepIdle() {
+  for (auto &check : idleChecks_) {
+    if (check) {
+      check();
+    }
+  }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "muduo/base/noncopyable.h"
+#include "muduo/net/Callbacks.h"
+#include "muduo/net/TimerId.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace muduo::net {
+
+class EventLoop;
+
+// Per-loop free list of the fixed-size slabs SegmentedBuffer is built from,
+// which segmented connection output draws on, and the idle-connection
+// accounting and sweep behind TcpConnection::setBufferIdleTimeout. The
+// contiguous input and output Buffers keep their own vector storage. Slabs are only handed out and
+// taken back in the loop thread; stats() may be called from any thread.
+class BufferPool : muduo::noncopyable {
+public:
+  static constexpr size_t kSlabSize = 16 * 1024;
+  static constexpr size_t kDefaultMaxFreeBytes = 4 * 1024 * 1024;
+
+  using Slab = std::unique_ptr<std::byte[]>;
+
+  // The idle sweep needs loop; the slab free list does not.
+  explicit BufferPool(EventLoop *loop = nullptr) : loop_(loop) {}
+
+  [[nodiscard]] Slab acquire();
+  // Kept for reuse up to the free limit, freed beyond it.
+  void release(Slab slab);
+
+  // Loop thread only. Frees whatever the pool holds beyond the new limit.
+  void setMaxFreeBytes(size_t bytes);
+  [[nodiscard]] size_t maxFreeBytes() const { return maxFreeSlabs_ * kSlabSize; }
+
+  // Connections report what they retain while idle; see
+  // TcpConnection::setBufferIdleTimeout.
+  void addIdle(std::int64_t connections, std::int64_t bytes) {
+    idleConnections_.fetch_add(connections, std::memory_order_relaxed);
+    idleBufferBytes_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  // Runs check for each watched connection from one loop timer, every half
+  // of the shortest timeout watched, instead of a timer per connection.
+  // Returns the handle to unwatchIdle() with. Loop thread only.
+  using IdleCheck = CallbackFunction<void()>;
+  [[nodiscard]] size_t watchIdle(std::chrono::microseconds timeout,
+                                 IdleCheck check);
+  void unwatchIdle(size_t handle);
+
+  struct Stats {
+    std::int64_t slabsInUse{0};
+    std::int64_t freeSlabs{0};
+    // Connections whose buffers have been empty for their idle timeout, and
+    // the buffer capacity they still hold.
+    std::int64_t idleConnections{0};
+    std::int64_t idleBufferBytes{0};
+
+    [[nodiscard]] std::int64_t bytesPerIdleConnection() const {
+      return idleConnections == 0 ? 0 : idleBufferBytes / idleConnections;
+    }
+  };
+  [[nodiscard]] Stats stats() const;
+
+private:
+  void sweepIdle();
+
+  EventLoop *loop_;
+  std::vector<Slab> free_;
+  size_t maxFreeSlabs_{kDefaultMaxFreeBytes / kSlabSize};
+  std::atomic<std::int64_t> slabsInUse_{0};
+  std::atomic<std::int64_t> freeSlabs_{0};
+  std::atomic<std::int64_t> idleConnections_{0};
+  std::atomic<std::int64_t> idleBufferBytes_{0};
+  // Slots of unwatched checks are empty and reused.
+  std::vector<IdleCheck> idleChecks_;
+  std::vector<size_t> freeIdleSlots_;
+  size_t watchedIdle_{0};
+  std::chrono::microseconds sweepPeriod_{0};
+  TimerId sweepTimer_;
+};
+
+} // namespace muduo::net
@@ -0,0 +1,383 @@
+#include "muduo/net/ByteScan.h"
+
+#include <atomic>
+#include <bit>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MUDUO_SCAN_X86 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MUDUO_SCAN_NEON 1
+#endif
+
+namespace muduo::net::scan {
+namespace {
+
+constexpr std::byte kCR{'\r'};
+constexpr std::byte kLF{'\n'};
+
+// Every kernel works on [first, last) and returns last when nothing matched.
+struct Kernels {
+  Kernel kind;
+  const std::byte *(*findByte)(const std::byte *first, const std::byte *last,
+                               std::byte value);
+  const std::byte *(*findCRLF)(const std::byte *first, const std::byte *last);
+  size_t (*findAllCRLF)(const std::byte *first, const std::byte *last,
+                        std::span<size_t> offsets);
+};
+
+const std::byte *findByteScalar(const std::byte *first, const std::byte *last,
+                                std::byte value) {
+  for (; first != last; ++first) {
+    if (*first == value) {
+      return first;
+    }
+  }
+  return last;
+}
+
+const std::byte *findCRLFScalar(const std::byte *first, const std::byte *last) {
+  for (const std::byte *p = first; last - p >= 2; ++p) {
+    if (p[0] == kCR && p[1] == kLF) {
+      return p;
+    }
+  }
+  return last;
+}
+
+// Continues a vector kernel's findAllCRLF() from p, base being the start of
+// the haystack, with count offsets already stored.
+size_t findAllCRLFTail(const std::byte *base, const std::byte *p,
+                       const std::byte *last, std::span<size_t> offsets,
+                       size_t count) {
+  for (; count < offsets.size() && last - p >= 2; ++p) {
+    if (p[0] == kCR && p[1] == kLF) {
+      offsets[count++] = static_cast<size_t>(p - base);
+    }
+  }
+  return count;
+}
+
+size_t findAllCRLFScalar(const std::byte *first, const std::byte *last,
+                         std::span<size_t> offsets) {
+  return findAllCRLFTail(first, first, last, offsets, 0);
+}
+
+constexpr Kernels kScalarKernels{Kernel::kScalar, findByteScalar,
+                                 findCRLFScalar, findAllCRLFScalar};
+
+// The vector kernels compare a block at p for '\r' and the block at p + 1
+// for '\n', so a bit set in both masks is a CRLF starting in the block, also
+// one that straddles two blocks. Whatever is left after the last whole
+// block goes to the scalar loops.
+
+#if MUDUO_SCAN_X86
+#if defined(__SSE2__)
+#define MUDUO_SCAN_SSE2 1
+
+__m128i loadSse2(const std::byte *p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+
+uint32_t crlfMaskSse2(const std::byte *p) {
+  const __m128i cr = _mm_cmpeq_epi8(loadSse2(p), _mm_set1_epi8('\r'));
+  const __m128i lf = _mm_cmpeq_epi8(loadSse2(p + 1), _mm_set1_epi8('\n'));
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(cr, lf)));
+}
+
+const std::byte *findByteSse2(const std::byte *first, const std::byte *last,
+                              std::byte value) {
+  const __m128i needle = _mm_set1_epi8(static_cast<char>(value));
+  for (; last - first >= 16; first += 16) {
+    const auto mask = static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(loadSse2(first), needle)));
+    if (mask != 0) {
+      return first + std::countr_zero(mask);
+    }
+  }
+  return findByteScalar(first, last, value);
+}
+
+const std::byte *findCRLFSse2(const std::byte *first, const std::byte *last) {
+  for (; last - first >= 17; first += 16) {
+    if (const uint32_t mask = crlfMaskSse2(first); mask != 0) {
+      return first + std::countr_zero(mask);
+    }
+  }
+  return findCRLFScalar(first, last);
+}
+
+size_t findAllCRLFSse2Tail(const std::byte *base, const std::byte *p,
+                           const std::byte *last, std::span<size_t> offsets,
+                           size_t count) {
+  for (; count < offsets.size() && last - p >= 17; p += 16) {
+    for (uint32_t mask = crlfMaskSse2(p); mask != 0 && count < offsets.size();
+         mask &= mask - 1) {
+      offsets[count++] = static_cast<size_t>(p - base) +
+                         static_cast<size_t>(std::countr_zero(mask));
+    }
+  }
+  return findAllCRLFTail(base, p, last, offsets, count);
+}
+
+size_t findAllCRLFSse2(const std::byte *first, const std::byte *last,
+                       std::span<size_t> offsets) {
+  return findAllCRLFSse2Tail(first, first, last, offsets, 0);
+}
+
+constexpr Kernels kSse2Kernels{Kernel::kSse2, findByteSse2, findCRLFSse2,
+                               findAllCRLFSse2};
+
+// Short lines are common, so what is left after the last 32-byte block goes
+// to the SSE2 loops rather than straight to the scalar ones. Each exit clears
+// the upper halves first, or the SSE code after it pays for the transition.
+#define MUDUO_SCAN_AVX2 1
+#define MUDUO_AVX2 __attribute__((target("avx2")))
+
+MUDUO_AVX2 __m256i loadAvx2(const std::byte *p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+
+MUDUO_AVX2 uint32_t crlfMaskAvx2(const std::byte *p) {
+  const __m256i cr = _mm256_cmpeq_epi8(loadAvx2(p), _mm256_set1_epi8('\r'));
+  const __m256i lf =
+      _mm256_cmpeq_epi8(loadAvx2(p + 1), _mm256_set1_epi8('\n'));
+  return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(cr, lf)));
+}
+
+MUDUO_AVX2 const std::byte *
+findByteAvx2(const std::byte *first, const std::byte *last, std::byte value) {
+  const __m256i needle = _mm256_set1_epi8(static_cast<char>(value));
+  for (; last - first >= 32; first += 32) {
+    const auto mask = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(loadAvx2(first), needle)));
+    if (mask != 0) {
+      _mm256_zeroupper();
+      return first + std::countr_zero(mask);
+    }
+  }
+  _mm256_zeroupper();
+  return findByteSse2(first, last, value);
+}
+
+MUDUO_AVX2 const std::byte *findCRLFAvx2(const std::byte *first,
+                                         const std::byte *last) {
+  for (; last - first >= 33; first += 32) {
+    if (const uint32_t mask = crlfMaskAvx2(first); mask != 0) {
+      _mm256_zeroupper();
+      return first + std::countr_zero(mask);
+    }
+  }
+  _mm256_zeroupper();
+  return findCRLFSse2(first, last);
+}
+
+MUDUO_AVX2 size_t findAllCRLFAvx2(const std::byte *first,
+                                  const std::byte *last,
+                                  std::span<size_t> offsets) {
+  size_t count = 0;
+  const std::byte *p = first;
+  for (; count < offsets.size() && last - p >= 33; p += 32) {
+    for (uint32_t mask = crlfMaskAvx2(p); mask != 0 && count < offsets.size();
+         mask &= mask - 1) {
+      offsets[count++] = static_cast<size_t>(p - first) +
+                         static_cast<size_t>(std::countr_zero(mask));
+    }
+  }
+  _mm256_zeroupper();
+  return findAllCRLFSse2Tail(first, p, last, offsets, count);
+}
+
+#undef MUDUO_AVX2
+
+constexpr Kernels kAvx2Kernels{Kernel::kAvx2, findByteAvx2, findCRLFAvx2,
+                               findAllCRLFAvx2};
+#endif // __SSE2__
+#endif // MUDUO_SCAN_X86
+
+#if MUDUO_SCAN_NEON
+// NEON has no movemask: narrowing each 16-bit lane by 4 leaves four bits per
+// byte in a 64-bit mask. Keeping one of the four makes it a bit per byte at
+// bit 4 * i + 3.
+uint64_t maskNeon(uint8x16_t eq) {
+  const uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+  return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0) &
+         0x8888888888888888ULL;
+}
+
+uint8x16_t loadNeon(const std::byte *p) {
+  return vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+}
+
+size_t lowestNeon(uint64_t mask) {
+  return static_cast<size_t>(std::countr_zero(mask)) / 4;
+}
+
+uint64_t crlfMaskNeon(const std::byte *p) {
+  const uint8x16_t cr = vceqq_u8(loadNeon(p), vdupq_n_u8('\r'));
+  const uint8x16_t lf = vceqq_u8(loadNeon(p + 1), vdupq_n_u8('\n'));
+  return maskNeon(vandq_u8(cr, lf));
+}
+
+const std::byte *findByteNeon(const std::byte *first, const std::byte *last,
+                              std::byte value) {
+  const uint8x16_t needle = vdupq_n_u8(static_cast<uint8_t>(value));
+  for (; last - first >= 16; first += 16) {
+    if (const uint64_t mask = maskNeon(vceqq_u8(loadNeon(first), needle));
+        mask != 0) {
+      return first + lowestNeon(mask);
+    }
+  }
+  return findByteScalar(first, last, value);
+}
+
+const std::byte *findCRLFNeon(const std::byte *first, const std::byte *last) {
+  for (; last - first >= 17; first += 16) {
+    if (const uint64_t mask = crlfMaskNeon(first); mask != 0) {
+      return first + lowestNeon(mask);
+    }
+  }
+  return findCRLFScalar(first, last);
+}
+
+size_t findAllCRLFNeon(const std::byte *first, const std::byte *last,
+                       std::span<size_t> offsets) {
+  size_t count = 0;
+  const std::byte *p = first;
+  for (; count < offsets.size() && last - p >= 17; p += 16) {
+    for (uint64_t mask = crlfMaskNeon(p); mask != 0 && count < offsets.size();
+         mask &= mask - 1) {
+      offsets[count++] = static_cast<size_t>(p - first) + lowestNeon(mask);
+    }
+  }
+  return findAllCRLFTail(first, p, last, offsets, count);
+}
+
+constexpr Kernels kNeonKernels{Kernel::kNeon, findByteNeon, findCRLFNeon,
+                               findAllCRLFNeon};
+#endif // MUDUO_SCAN_NEON
+
+const Kernels *kernelsFor(Kernel kernel) {
+  switch (kernel) {
+  case Kernel::kScalar:
+    return &kScalarKernels;
+  case Kernel::kSse2:
+#if MUDUO_SCAN_SSE2
+    return &kSse2Kernels;
+#else
+    return nullptr;
+#endif
+  case Kernel::kAvx2:
+#if MUDUO_SCAN_AVX2
+    return __builtin_cpu_supports("avx2") ? &kAvx2Kernels : nullptr;
+#else
+    return nullptr;
+#endif
+  case Kernel::kNeon:
+#if MUDUO_SCAN_NEON
+    return &kNeonKernels;
+#else
+    return nullptr;
+#endif
+  }
+  return nullptr;
+}
+
+const Kernels *detect() {
+  for (const Kernel kernel : {Kernel::kAvx2, Kernel::kSse2, Kernel::kNeon}) {
+    if (const Kernels *kernels = kernelsFor(kernel)) {
+      return kernels;
+    }
+  }
+  return &kScalarKernels;
+}
+
+const Kernels *resolve();
+
+// Until the first scan asks for the CPU's kernels, the table points at
+// these, which look them up and forward.
+constexpr Kernels kResolveKernels{
+    Kernel::kScalar,
+    [](const std::byte *first, const std::byte *last, std::byte value) {
+      return resolve()->findByte(first, last, value);
+    },
+    [](const std::byte *first, const std::byte *last) {
+      return resolve()->findCRLF(first, last);
+    },
+    [](const std::byte *first, const std::byte *last,
+       std::span<size_t> offsets) {
+      return resolve()->findAllCRLF(first, last, offsets);
+    }};
+
+constinit std::atomic<const Kernels *> gKernels{&kResolveKernels};
+
+const Kernels *resolve() {
+  const Kernels *expected = &kResolveKernels;
+  const Kernels *detected = detect();
+  // A concurrent setKernel() wins over detection.
+  if (gKernels.compare_exchange_strong(expected, detected,
+                                       std::memory_order_relaxed)) {
+    return detected;
+  }
+  return expected;
+}
+
+const Kernels *active() {
+  const Kernels *kernels = gKernels.load(std::memory_order_relaxed);
+  return kernels == &kResolveKernels ? resolve() : kernels;
+}
+
+} // namespace
+
+Kernel kernel() { return active()->kind; }
+
+const char *kernelName(Kernel kernel) {
+  switch (kernel) {
+  case Kernel::kScalar:
+    return "scalar";
+  case Kernel::kSse2:
+    return "sse2";
+  case Kernel::kAvx2:
+    return "avx2";
+  case Kernel::kNeon:
+    return "neon";
+  }
+  return "unknown";
+}
+
+bool kernelSupported(Kernel kernel) { return kernelsFor(kernel) != nullptr; }
+
+bool setKernel(Kernel kernel) {
+  const Kernels *kernels = kernelsFor(kernel);
+  if (kernels == nullptr) {
+    return false;
+  }
+  gKernels.store(kernels, std::memory_order_relaxed);
+  return true;
+}
+
+const std::byte *findByte(std::span<const std::byte> haystack,
+                          std::byte value) {
+  const std::byte *last = haystack.data() + haystack.size();
+  const std::byte *match =
+      gKernels.load(std::memory_order_relaxed)
+          ->findByte(haystack.data(), last, value);
+  return match == last ? nullptr : match;
+}
+
+const std::byte *findCRLF(std::span<const std::byte> haystack) {
+  const std::byte *last = haystack.data() + haystack.size();
+  const std::byte *match =
+      gKernels.load(std::memory_order_relaxed)->findCRLF(haystack.data(), last);
+  return match == last ? nullptr : match;
+}
+
+size_t findAllCRLF(std::span<const std::byte> haystack,
+                   std::span<size_t> offsets) {
+  return gKernels.load(std::memory_order_relaxed)
+      ->findAllCRLF(haystack.data(), haystack.data() + haystack.size(),
+                    offsets);
+}
+
+} // namespace muduo::net::scan
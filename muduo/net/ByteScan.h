@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Delimiter scans for line-based protocols, vectorized: SSE2 or AVX2 on x86,
+// NEON on ARM, picked for the CPU the first time a scan runs, with a
+// byte-at-a-time fallback.
+namespace muduo::net::scan {
+
+enum class Kernel : std::uint8_t { kScalar, kSse2, kAvx2, kNeon };
+
+// The kernel the scans below dispatch to.
+[[nodiscard]] Kernel kernel();
+[[nodiscard]] const char *kernelName(Kernel kernel);
+[[nodiscard]] bool kernelSupported(Kernel kernel);
+// Makes every thread's scans use kernel, for tests and benchmarks; false,
+// changing nothing, if this CPU or build lacks it.
+bool setKernel(Kernel kernel);
+
+// First occurrence of value in haystack, or nullptr.
+[[nodiscard]] const std::byte *findByte(std::span<const std::byte> haystack,
+                                        std::byte value);
+// The '\r' of the first "\r\n" in haystack, or nullptr.
+[[nodiscard]] const std::byte *findCRLF(std::span<const std::byte> haystack);
+// Stores the offsets of the '\r' of each "\r\n" in haystack, in order, until
+// offsets is full; returns how many it stored.
+[[nodiscard]] size_t findAllCRLF(std::span<const std::byte> haystack,
+                                 std::span<size_t> offsets);
+
+} // namespace muduo::net::scan
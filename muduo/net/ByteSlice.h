@@ -0,0 +1,93 @@
+#pragma once
+
+#include "muduo/base/copyable.h"
+#include "muduo/net/Buffer.h"
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace muduo::net {
+
+// Immutable view of bytes that keeps their storage alive: copies share the
+// storage through a reference count, so a payload can be queued, handed
+// across threads or sent to several connections without being copied. The
+// bytes must not change while any slice refers to them.
+class ByteSlice : public muduo::copyable {
+public:
+  ByteSlice() = default;
+  // owner keeps bytes alive; it is never dereferenced.
+  ByteSlice(std::shared_ptr<const void> owner, std::span<const std::byte> bytes)
+      : owner_(std::move(owner)), bytes_(bytes) {}
+  explicit ByteSlice(std::string &&str) {
+    auto owner = std::make_shared<const std::string>(std::move(str));
+    bytes_ = std::as_bytes(std::span{owner->data(), owner->size()});
+    owner_ = std::move(owner);
+  }
+  explicit ByteSlice(std::vector<std::byte> &&bytes) {
+    auto owner = std::make_shared<const std::vector<std::byte>>(std::move(bytes));
+    bytes_ = std::span{owner->data(), owner->size()};
+    owner_ = std::move(owner);
+  }
+  // Takes the readable bytes of buffer, which is left empty.
+  explicit ByteSlice(Buffer &&buffer) {
+    auto owner = std::make_shared<Buffer>(0);
+    owner->swap(buffer);
+    bytes_ = owner->readableSpan();
+    owner_ = std::move(owner);
+  }
+
+  [[nodiscard]] static ByteSlice copyOf(std::span<const std::byte> bytes) {
+    if (bytes.empty()) {
+      return {};
+    }
+    auto owner = std::make_shared_for_overwrite<std::byte[]>(bytes.size());
+    std::ranges::copy(bytes, owner.get());
+    const std::span<const std::byte> copied{owner.get(), bytes.size()};
+    return {std::move(owner), copied};
+  }
+  [[nodiscard]] static ByteSlice copyOf(std::string_view str) {
+    return copyOf(std::as_bytes(std::span{str.data(), str.size()}));
+  }
+  // Refers to bytes without keeping them alive, e.g. a string literal; they
+  // must outlive every copy of the slice.
+  [[nodiscard]] static ByteSlice borrow(std::span<const std::byte> bytes) {
+    return {nullptr, bytes};
+  }
+  [[nodiscard]] static ByteSlice borrow(std::string_view str) {
+    return borrow(std::as_bytes(std::span{str.data(), str.size()}));
+  }
+
+  [[nodiscard]] std::span<const std::byte> bytes() const { return bytes_; }
+  [[nodiscard]] std::string_view chars() const {
+    return {reinterpret_cast<const char *>(bytes_.data()), bytes_.size()};
+  }
+  [[nodiscard]] const std::byte *data() const { return bytes_.data(); }
+  [[nodiscard]] size_t size() const { return bytes_.size(); }
+  [[nodiscard]] bool empty() const { return bytes_.empty(); }
+
+  // Shares the storage; offset + count must not exceed size().
+  [[nodiscard]] ByteSlice subslice(size_t offset, size_t count) const {
+    assert(offset + count <= size());
+    return {owner_, bytes_.subspan(offset, count)};
+  }
+  [[nodiscard]] ByteSlice subslice(size_t offset) const {
+    assert(offset <= size());
+    return subslice(offset, size() - offset);
+  }
+
+  // Slices sharing this storage, this one included; 0 for an empty or a
+  // borrowed slice.
+  [[nodiscard]] long useCount() const { return owner_.use_count(); }
+
+private:
+  std::shared_ptr<const void> owner_;
+  std::span<const std::byte> bytes_;
+};
+
+} // namespace muduo::net
@@ -13,7 +13,7 @@ const int Channel::kWriteEvent = POLLOUT;
 
 Channel::Channel(EventLoop *loop, int fd)
     : loop_(loop), fd_(fd), events_(0), revents_(0), index_(-1), logHup_(true),
-      tied_(false), eventHandling_(false), addedToLoop_(false) {}
+      edgeTriggered_(false), tied_(false), eventHandling_(false), addedToLoop_(false) {}
 
 Channel::~Channel() {
   assert(!eventHandling_);
@@ -107,6 +107,16 @@ void Channel::disableWriting() {
   update();
 }
 
+void Channel::setEdgeTriggered(bool on) {
+  if (edgeTriggered_ == on) {
+    return;
+  }
+  edgeTriggered_ = on;
+  if (addedToLoop_) {
+    update();
+  }
+}
+
 void Channel::disableAll() {
   events_ = kNoneEvent;
   update();
@@ -62,6 +62,12 @@ public:
   void disableWriting();
   void disableAll();
 
+  // Edge-triggered interest where the poller supports it (see
+  // EventLoop::supportsEdgeTriggered()); pollers without it stay level
+  // triggered.
+  void setEdgeTriggered(bool on);
+  [[nodiscard]] bool isEdgeTriggered() const { return edgeTriggered_; }
+
   [[nodiscard]] bool isWriting() const { return (events_ & kWriteEvent) != 0; }
   [[nodiscard]] bool isReading() const { return (events_ & kReadEvent) != 0; }
 
@@ -93,6 +99,7 @@ private:
   int revents_;
   int index_;
   bool logHup_;
+  bool edgeTriggered_;
 
   std::weak_ptr<void> tie_;
   bool tied_;
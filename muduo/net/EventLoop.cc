@@ -2,15 +2,18 @@
 
 #include "muduo/base/CurrentThread.h"
 #include "muduo/base/Logging.h"
+#include "muduo/net/BufferPool.h"
 #include "muduo/net/Channel.h"
 #include "muduo/net/Poller.h"
 #include "muduo/net/SocketsOps.h"
 #include "muduo/net/TimerQueue.h"
+#include "muduo/net/poller/IoUringPoller.h"
 
 #include <algorithm>
 #include <chrono>
 #include <csignal>
 #include <cstdint>
+#include <cstdlib>
 #include <span>
 #include <sys/eventfd.h>
 #include <unistd.h>
@@ -20,7 +23,7 @@ namespace muduo::net {
 namespace {
 
 thread_local EventLoop *t_loopInThisThread = nullptr;
-constexpr int kPollTimeMs = 10'000;
+constexpr std::chrono::milliseconds kPollTime{10'000};
 
 [[nodiscard]] int createEventfd() {
   const int eventFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
@@ -43,10 +46,14 @@ EventLoop *EventLoop::getEventLoopOfCurrentThread() noexcept {
   return t_loopInThisThread;
 }
 
-EventLoop::EventLoop()
+EventLoop::EventLoop() : EventLoop(PollerBackend::kDefault) {}
+
+EventLoop::EventLoop(PollerBackend backend, TimerBackend timerBackend)
     : threadId_(muduo::CurrentThread::tid()),
-      poller_(Poller::newDefaultPoller(this)),
-      timerQueue_(std::make_unique<TimerQueue>(this)),
+      poller_(Poller::newPoller(this, backend)),
+      ioUringPoller_(dynamic_cast<IoUringPoller *>(poller_.get())),
+      timerQueue_(std::make_unique<TimerQueue>(this, timerBackend)),
+      bufferPool_(std::make_unique<BufferPool>(this)),
       wakeupFd_(createEventfd()),
       wakeupChannel_(std::make_unique<Channel>(this, wakeupFd_)) {
   muduo::logDebug("EventLoop created {} in thread {}",
@@ -61,6 +68,9 @@ EventLoop::EventLoop()
   wakeupChannel_->setReadCallback(
       [this](Timestamp receiveTime) { handleRead(receiveTime); });
   wakeupChannel_->enableReading();
+  if (::getenv("MUDUO_DEADLINE_POLLING") != nullptr) {
+    setDeadlinePolling(true);
+  }
 }
 
 EventLoop::~EventLoop() {
@@ -81,12 +91,28 @@ void EventLoop::loop() {
   quit_.store(false, std::memory_order_release);
   muduo::logTrace("EventLoop {} start looping", static_cast<const void *>(this));
 
+  // Flushes this thread queued before the loop started run before the
+  // first poll, after the functors queued with them, so pollTimeout()
+  // never has to account for them.
+  if (!flushes_.empty()) {
+    doPendingFunctors();
+    doFlushes();
+  }
   while (!quit_.load(std::memory_order_acquire)) {
     activeChannels_.clear();
-    pollReturnTime_ = poller_->poll(kPollTimeMs, &activeChannels_);
+    const auto timeout = pollTimeout();
+    if (const auto budget = busyPollBudget();
+        budget > std::chrono::microseconds::zero()) {
+      busyPoll(budget, timeout);
+    } else {
+      pollReturnTime_ = poller_->pollFor(timeout, &activeChannels_);
+    }
     ++iteration_;
 
     eventHandling_ = true;
+    if (deadlinePolling_) {
+      timerQueue_->expire(pollReturnTime_);
+    }
     for (auto *channel : activeChannels_) {
       currentActiveChannel_ = channel;
       currentActiveChannel_->handleEvent(pollReturnTime_);
@@ -94,12 +120,59 @@ void EventLoop::loop() {
     currentActiveChannel_ = nullptr;
     eventHandling_ = false;
     doPendingFunctors();
+    doFlushes();
+    if (const std::int64_t busy = Timestamp::now().microSecondsSinceEpoch() -
+                                  pollReturnTime_.microSecondsSinceEpoch();
+        busy > 0) {
+      busyMicros_.store(busyMicros_.load(std::memory_order_relaxed) + busy,
+                        std::memory_order_relaxed);
+    }
   }
 
   muduo::logTrace("EventLoop {} stop looping", static_cast<const void *>(this));
   looping_.store(false, std::memory_order_release);
 }
 
+std::chrono::nanoseconds EventLoop::pollTimeout() const {
+  // doFlushes() leaves none behind, and only this thread queues them.
+  assert(flushes_.empty());
+  if (!deadlinePolling_) {
+    return kPollTime;
+  }
+  const Timestamp next = timerQueue_->nextExpiration();
+  if (!next.valid()) {
+    return kPollTime;
+  }
+  return std::clamp<std::chrono::nanoseconds>(
+      next.timePoint() - Timestamp::now().timePoint(),
+      std::chrono::nanoseconds::zero(), kPollTime);
+}
+
+void EventLoop::busyPoll(std::chrono::microseconds budget,
+                         std::chrono::nanoseconds timeout) {
+  const auto start = std::chrono::steady_clock::now();
+  const auto deadline =
+      start + std::min<std::chrono::nanoseconds>(budget, timeout);
+  do {
+    pollReturnTime_ = poller_->poll(0, &activeChannels_);
+    if (!activeChannels_.empty() || quit_.load(std::memory_order_acquire)) {
+      return;
+    }
+  } while (std::chrono::steady_clock::now() < deadline);
+  // A timer that fell due while spinning is expired right away.
+  const auto remaining = timeout - (std::chrono::steady_clock::now() - start);
+  if (remaining > std::chrono::nanoseconds::zero()) {
+    pollReturnTime_ = poller_->pollFor(remaining, &activeChannels_);
+  }
+}
+
+void EventLoop::setDeadlinePolling(bool on) {
+  runInLoop([this, on] {
+    deadlinePolling_ = on;
+    timerQueue_->setDeadlinePolling(on);
+  });
+}
+
 void EventLoop::quit() {
   quit_.store(true, std::memory_order_release);
   if (!isInLoopThread()) {
@@ -116,19 +189,19 @@ void EventLoop::runInLoop(Functor cb) {
 }
 
 void EventLoop::queueInLoop(Functor cb) {
-  {
-    std::scoped_lock lock(mutex_);
-    pendingFunctors_.push_back(std::move(cb));
-  }
+  pendingFunctors_.push(std::move(cb));
 
   if (!isInLoopThread() || callingPendingFunctors_) {
     wakeup();
   }
 }
 
-size_t EventLoop::queueSize() const {
-  std::scoped_lock lock(mutex_);
-  return pendingFunctors_.size();
+size_t EventLoop::queueSize() const { return pendingFunctors_.size(); }
+
+EventLoop::Load EventLoop::load() const noexcept {
+  return {connections_.load(std::memory_order_relaxed),
+          pendingFunctors_.size(),
+          busyMicros_.load(std::memory_order_relaxed)};
 }
 
 TimerId EventLoop::runAt(Timestamp time, TimerCallback cb) {
@@ -163,6 +236,27 @@ TimerId EventLoop::runEvery(std::chrono::microseconds interval,
   return timerQueue_->addTimer(std::move(cb), Timestamp{when}, interval);
 }
 
+TimerId EventLoop::runAfter(std::chrono::microseconds delay,
+                            std::chrono::microseconds slack,
+                            TimerCallback cb) {
+  const Timestamp::TimePoint when = Timestamp::now().timePoint() + delay;
+  return timerQueue_->addTimer(std::move(cb), Timestamp{when},
+                               std::chrono::microseconds::zero(), slack);
+}
+
+TimerId EventLoop::runEvery(std::chrono::microseconds interval,
+                            std::chrono::microseconds slack,
+                            TimerCallback cb) {
+  const Timestamp::TimePoint when = Timestamp::now().timePoint() + interval;
+  return timerQueue_->addTimer(std::move(cb), Timestamp{when}, interval,
+                               slack);
+}
+
+EventLoop::TimerStats EventLoop::timerStats() const {
+  return {timerQueue_->expiryWakeups(), timerQueue_->expiredTimers(),
+          timerQueue_->coalescedWakeups()};
+}
+
 void EventLoop::cancel(TimerId timerId) { timerQueue_->cancel(timerId); }
 
 void EventLoop::updateChannel(Channel *channel) {
@@ -188,6 +282,10 @@ bool EventLoop::hasChannel(Channel *channel) const {
   return poller_->hasChannel(channel);
 }
 
+bool EventLoop::supportsEdgeTriggered() const {
+  return poller_->supportsEdgeTriggered();
+}
+
 void EventLoop::abortNotInLoopThread() const {
   muduo::logFatal(
       "EventLoop::abortNotInLoopThread - EventLoop {} was created in "
@@ -206,6 +304,12 @@ bool EventLoop::isInLoopThread() const {
 }
 
 void EventLoop::wakeup() const {
+  // acq_rel pairs with the exchange in handleRead(): whichever side comes
+  // second sees the other's writes, so a queued functor is either drained by
+  // the running iteration or followed by an eventfd write.
+  if (wakeupPending_.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
   const std::uint64_t one = 1;
   const auto bytes = std::as_bytes(std::span{&one, 1});
   const ssize_t written = sockets::write(wakeupFd_, bytes);
@@ -221,21 +325,34 @@ void EventLoop::handleRead([[maybe_unused]] Timestamp receiveTime) {
   if (n != static_cast<ssize_t>(sizeof(one))) {
     muduo::logError("EventLoop::handleRead() reads {} bytes instead of 8", n);
   }
+  // Only after the read: clearing first would let a wakeup() land in the
+  // counter consumed above and leave the flag set with nothing to poll.
+  (void)wakeupPending_.exchange(false, std::memory_order_acq_rel);
 }
 
 void EventLoop::doPendingFunctors() {
-  std::vector<Functor> functors;
   callingPendingFunctors_ = true;
+  // Functors queued while these run wait for the next iteration; the
+  // wakeup they trigger keeps that iteration from blocking.
+  (void)pendingFunctors_.consume([](Functor &functor) { functor(); },
+                                 pendingFunctors_.size());
+  callingPendingFunctors_ = false;
+}
 
-  {
-    std::scoped_lock lock(mutex_);
-    functors.swap(pendingFunctors_);
-  }
+void EventLoop::queueFlush(Functor cb) {
+  assertInLoopThread();
+  flushes_.push_back(std::move(cb));
+}
 
-  for (auto &functor : functors) {
-    functor();
+void EventLoop::doFlushes() {
+  // A flush that queues another one gets it run in this pass as well.
+  while (!flushes_.empty()) {
+    runningFlushes_.swap(flushes_);
+    for (auto &flush : runningFlushes_) {
+      flush();
+    }
+    runningFlushes_.clear();
   }
-  callingPendingFunctors_ = false;
 }
 
 } // namespace muduo::net
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "muduo/base/MpscQueue.h"
 #include "muduo/base/Timestamp.h"
 #include "muduo/base/Types.h"
 #include "muduo/base/noncopyable.h"
@@ -11,7 +12,6 @@
 #include <concepts>
 #include <cstdint>
 #include <memory>
-#include <mutex>
 #include <string_view>
 #include <type_traits>
 #include <utility>
@@ -19,16 +19,30 @@
 
 namespace muduo::net {
 
+class BufferPool;
 class Channel;
+class IoUringPoller;
 class Poller;
 class TimerQueue;
 
+// kDefault honours MUDUO_USE_POLL / MUDUO_USE_IO_URING and otherwise picks
+// epoll. kIoUring falls back to epoll when the kernel lacks io_uring.
+enum class PollerBackend : std::uint8_t { kDefault, kEPoll, kPoll, kIoUring };
+
+// Timer storage. kSet expires timers in exact expiration order; kWheel is a
+// hierarchical timing wheel with O(1) add and cancel that fires up to 1 ms
+// late, for large numbers of timeouts. kDefault honours MUDUO_TIMER_WHEEL and
+// otherwise picks kSet.
+enum class TimerBackend : std::uint8_t { kDefault, kSet, kWheel };
+
 class EventLoop : muduo::noncopyable {
 public:
   using Functor = CallbackFunction<void()>;
   using ChannelList = std::vector<Channel *>;
 
   EventLoop();
+  explicit EventLoop(PollerBackend backend,
+                     TimerBackend timerBackend = TimerBackend::kDefault);
   ~EventLoop();
 
   void loop();
@@ -39,6 +53,40 @@ public:
   }
   [[nodiscard]] std::int64_t iteration() const noexcept { return iteration_; }
 
+  // Latency mode: while idle, the loop keeps polling without blocking for up
+  // to budget before it falls back to a blocking wait, trading a core for a
+  // shorter wake-up path. Zero (the default) always blocks. May be called
+  // from any thread; takes effect on the next iteration.
+  void setBusyPollBudget(std::chrono::microseconds budget) {
+    busyPollBudgetUs_.store(budget.count(), std::memory_order_relaxed);
+  }
+  [[nodiscard]] std::chrono::microseconds busyPollBudget() const noexcept {
+    return std::chrono::microseconds{
+        busyPollBudgetUs_.load(std::memory_order_relaxed)};
+  }
+  // SO_BUSY_POLL for connections established on this loop from now on; zero
+  // leaves the system default. Values above net.core.busy_read need
+  // CAP_NET_ADMIN.
+  void setSocketBusyPoll(std::chrono::microseconds timeout) {
+    socketBusyPollUs_.store(timeout.count(), std::memory_order_relaxed);
+  }
+  [[nodiscard]] std::chrono::microseconds socketBusyPoll() const noexcept {
+    return std::chrono::microseconds{
+        socketBusyPollUs_.load(std::memory_order_relaxed)};
+  }
+
+  // Deadline polling: instead of arming a timerfd, the loop passes the next
+  // timer deadline to the poller as its timeout (epoll_pwait2 where the
+  // kernel has it, so finer than a millisecond) and expires timers right
+  // after the poll returns. Saves a timerfd_settime() and a timerfd read per
+  // expiry. On from the start when MUDUO_DEADLINE_POLLING is set. May be
+  // called from any thread.
+  void setDeadlinePolling(bool on);
+  // Loop thread only.
+  [[nodiscard]] bool deadlinePolling() const noexcept {
+    return deadlinePolling_;
+  }
+
   void assertInLoopThread() const;
   [[nodiscard]] bool isInLoopThread() const;
   [[nodiscard]] bool eventHandling() const noexcept { return eventHandling_; }
@@ -46,6 +94,15 @@ public:
   void updateChannel(Channel *channel);
   void removeChannel(Channel *channel);
   [[nodiscard]] bool hasChannel(Channel *channel) const;
+  [[nodiscard]] bool supportsEdgeTriggered() const;
+  // Non-null when this loop runs on the io_uring backend.
+  [[nodiscard]] IoUringPoller *ioUringPoller() const noexcept {
+    return ioUringPoller_;
+  }
+  // Buffer memory shared by the connections of this loop.
+  [[nodiscard]] BufferPool *bufferPool() const noexcept {
+    return bufferPool_.get();
+  }
 
   void runInLoop(Functor cb);
   template <typename F>
@@ -61,6 +118,33 @@ public:
   }
   [[nodiscard]] size_t queueSize() const;
 
+  // Load counters for picking a loop (EventLoopThreadPool::LoopSelection),
+  // kept up to date without locks and readable from any thread.
+  struct Load {
+    // TcpConnections created for this loop and not yet destroyed.
+    int connections{0};
+    // Functors queued by runInLoop()/queueInLoop() that have not run yet.
+    size_t pendingFunctors{0};
+    // Time spent running events, timers and functors rather than waiting in
+    // the poller, since the loop started.
+    std::int64_t busyMicros{0};
+  };
+  [[nodiscard]] Load load() const noexcept;
+  // TcpConnection counts itself in when created and out when destroyed.
+  void addConnectionLoad(int delta) noexcept {
+    connections_.fetch_add(delta, std::memory_order_relaxed);
+  }
+  // Runs cb once at the end of this iteration, after the pending functors,
+  // so that output the iteration's callbacks queued goes out in one write.
+  // The next poll does not block while flushes are queued. Loop thread
+  // only.
+  void queueFlush(Functor cb);
+  template <typename F>
+    requires CallbackBindable<F, Functor>
+  void queueFlush(F &&cb) {
+    queueFlush(Functor(std::forward<F>(cb)));
+  }
+
   [[nodiscard]] TimerId runAt(Timestamp time, TimerCallback cb);
   template <typename F>
     requires CallbackBindable<F, TimerCallback>
@@ -117,8 +201,39 @@ public:
                                  F &&cb) {
     return runEvery(interval, TimerCallback(std::forward<F>(cb)));
   }
+  // Timers with slack may fire up to slack late (after each interval, for
+  // runEvery), so that timers due close together share one wakeup, like the
+  // kernel's timer slack.
+  [[nodiscard]] TimerId runAfter(std::chrono::microseconds delay,
+                                 std::chrono::microseconds slack,
+                                 TimerCallback cb);
+  template <typename F>
+    requires CallbackBindable<F, TimerCallback>
+  [[nodiscard]] TimerId runAfter(std::chrono::microseconds delay,
+                                 std::chrono::microseconds slack, F &&cb) {
+    return runAfter(delay, slack, TimerCallback(std::forward<F>(cb)));
+  }
+  [[nodiscard]] TimerId runEvery(std::chrono::microseconds interval,
+                                 std::chrono::microseconds slack,
+                                 TimerCallback cb);
+  template <typename F>
+    requires CallbackBindable<F, TimerCallback>
+  [[nodiscard]] TimerId runEvery(std::chrono::microseconds interval,
+                                 std::chrono::microseconds slack, F &&cb) {
+    return runEvery(interval, slack, TimerCallback(std::forward<F>(cb)));
+  }
   void cancel(TimerId timerId);
 
+  struct TimerStats {
+    // Expiry passes that ran at least one timer.
+    std::int64_t wakeups{0};
+    std::int64_t expiredTimers{0};
+    // Wakeups that would have been needed on top of wakeups without slack.
+    std::int64_t coalescedWakeups{0};
+  };
+  // May be called from any thread.
+  [[nodiscard]] TimerStats timerStats() const;
+
   void wakeup() const;
 
   [[nodiscard]] static EventLoop *getEventLoopOfCurrentThread() noexcept;
@@ -127,24 +242,41 @@ private:
   void abortNotInLoopThread() const;
   void handleRead(Timestamp receiveTime);
   void doPendingFunctors();
+  void doFlushes();
+  [[nodiscard]] std::chrono::nanoseconds pollTimeout() const;
+  void busyPoll(std::chrono::microseconds budget,
+                std::chrono::nanoseconds timeout);
 
   std::atomic<bool> looping_{false};
   std::atomic<bool> quit_{false};
   bool eventHandling_{false};
   bool callingPendingFunctors_{false};
+  bool deadlinePolling_{false};
   std::int64_t iteration_{0};
+  std::atomic<std::int64_t> busyPollBudgetUs_{0};
+  std::atomic<std::int64_t> socketBusyPollUs_{0};
+  std::atomic<int> connections_{0};
+  // Written by the loop thread only.
+  std::atomic<std::int64_t> busyMicros_{0};
   const int threadId_;
   Timestamp pollReturnTime_;
   std::unique_ptr<Poller> poller_;
+  IoUringPoller *ioUringPoller_{nullptr};
   std::unique_ptr<TimerQueue> timerQueue_;
+  std::unique_ptr<BufferPool> bufferPool_;
   int wakeupFd_{-1};
+  // Set by the first wakeup() after the loop drained wakeupFd_; later calls
+  // skip the eventfd write until the loop reads it again.
+  mutable std::atomic<bool> wakeupPending_{false};
   std::unique_ptr<Channel> wakeupChannel_;
 
   ChannelList activeChannels_;
   Channel *currentActiveChannel_{nullptr};
 
-  mutable std::mutex mutex_;
-  std::vector<Functor> pendingFunctors_;
+  MpscQueue<Functor> pendingFunctors_;
+  std::vector<Functor> flushes_;
+  // Swapped with flushes_ while they run, so neither reallocates.
+  std::vector<Functor> runningFlushes_;
 };
 
 } // namespace muduo::net
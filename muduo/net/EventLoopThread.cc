@@ -1,11 +1,20 @@
 #include "muduo/net/EventLoopThread.h"
 
+#include "muduo/base/CurrentThread.h"
+#include "muduo/base/Logging.h"
 #include "muduo/net/EventLoop.h"
 
 namespace muduo::net {
 
 EventLoopThread::EventLoopThread(ThreadInitCallback cb, string name)
-    : thread_([this] { threadFunc(); }, std::move(name)),
+    : EventLoopThread(std::move(cb), std::move(name),
+                      PollerBackend::kDefault) {}
+
+EventLoopThread::EventLoopThread(ThreadInitCallback cb, string name,
+                                 PollerBackend backend,
+                                 TimerBackend timerBackend)
+    : backend_(backend), timerBackend_(timerBackend),
+      thread_([this] { threadFunc(); }, std::move(name)),
       callback_(std::move(cb)) {}
 
 EventLoopThread::~EventLoopThread() {
@@ -31,7 +40,15 @@ EventLoop *EventLoopThread::startLoop() {
 }
 
 void EventLoopThread::threadFunc() {
-  EventLoop loop;
+  if (!cpus_.empty()) {
+    if (!CurrentThread::setCpuAffinity(cpus_)) {
+      muduo::logWarn("EventLoopThread::threadFunc - cannot pin {} to its CPUs",
+                     CurrentThread::name());
+    } else {
+      (void)CurrentThread::setLocalMemoryPolicy();
+    }
+  }
+  EventLoop loop(backend_, timerBackend_);
 
   if (callback_) {
     callback_(&loop);
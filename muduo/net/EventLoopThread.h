@@ -5,21 +5,27 @@
 #include "muduo/net/Callbacks.h"
 
 #include <atomic>
+#include <cstdint>
 #include <concepts>
 #include <condition_variable>
 #include <mutex>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace muduo::net {
 
 class EventLoop;
+enum class PollerBackend : std::uint8_t;
+enum class TimerBackend : std::uint8_t;
 
 class EventLoopThread : muduo::noncopyable {
 public:
   using ThreadInitCallback = CallbackFunction<void(EventLoop *)>;
 
   explicit EventLoopThread(ThreadInitCallback cb = {}, string name = {});
+  EventLoopThread(ThreadInitCallback cb, string name, PollerBackend backend,
+                  TimerBackend timerBackend = {});
   template <typename F>
     requires CallbackBindable<F, ThreadInitCallback>
   explicit EventLoopThread(F &&cb, string name = {})
@@ -27,12 +33,20 @@ public:
                         std::move(name)) {}
   ~EventLoopThread();
 
+  // Pins the thread to cpus before it creates its loop, and has it take
+  // new memory from their NUMA node, so the loop, its buffer pool and what
+  // its connections allocate stay local. Call before startLoop().
+  void setCpuAffinity(std::vector<int> cpus) { cpus_ = std::move(cpus); }
+
   [[nodiscard]] EventLoop *startLoop();
 
 private:
   void threadFunc();
 
   EventLoop *loop_{nullptr};
+  PollerBackend backend_;
+  TimerBackend timerBackend_;
+  std::vector<int> cpus_;
   std::atomic<bool> exiting_{false};
   muduo::Thread thread_;
   std::mutex mutex_;
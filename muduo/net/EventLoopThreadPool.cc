@@ -3,9 +3,11 @@
 #include "muduo/net/EventLoop.h"
 #include "muduo/net/EventLoopThread.h"
 
+#include <algorithm>
 #include <cassert>
 #include <format>
 #include <memory>
+#include <utility>
 
 namespace muduo::net {
 
@@ -25,38 +27,122 @@ void EventLoopThreadPool::start(ThreadInitCallback cb) {
 
   for (int i = 0; i < numThreads_; ++i) {
     auto threadName = std::format("{}{}", name_, i);
+    const bool busyPoll = i < busyPollLoops_;
     auto t = std::make_unique<EventLoopThread>(
-        EventLoopThread::ThreadInitCallback{[sharedInitCb](EventLoop *loop) {
+        EventLoopThread::ThreadInitCallback{[this, sharedInitCb,
+                                             busyPoll](EventLoop *loop) {
+          if (busyPoll) {
+            applyBusyPoll(loop);
+          }
           if (sharedInitCb != nullptr && static_cast<bool>(*sharedInitCb)) {
             (*sharedInitCb)(loop);
           }
         }},
-        std::move(threadName));
+        std::move(threadName), backend_, timerBackend_);
+    if (!cpuSets_.empty()) {
+      t->setCpuAffinity(cpuSets_[static_cast<size_t>(i) % cpuSets_.size()]);
+    }
     loops_.push_back(t->startLoop());
     threads_.push_back(std::move(t));
   }
+  busySamples_.resize(loops_.size());
 
+  if (numThreads_ == 0 && busyPollLoops_ > 0) {
+    applyBusyPoll(baseLoop_);
+  }
   if (numThreads_ == 0 && sharedInitCb != nullptr &&
       static_cast<bool>(*sharedInitCb)) {
     (*sharedInitCb)(baseLoop_);
   }
 }
 
+void EventLoopThreadPool::applyBusyPoll(EventLoop *loop) const {
+  loop->setBusyPollBudget(busyPollBudget_);
+  loop->setSocketBusyPoll(socketBusyPoll_);
+}
+
 EventLoop *EventLoopThreadPool::getNextLoop() {
   baseLoop_->assertInLoopThread();
   assert(started_);
 
-  EventLoop *loop = baseLoop_;
-  if (!loops_.empty()) {
-    loop = loops_[static_cast<size_t>(next_)];
-    ++next_;
-    if (static_cast<size_t>(next_) >= loops_.size()) {
-      next_ = 0;
-    }
+  if (loops_.empty()) {
+    return baseLoop_;
+  }
+  switch (selection_) {
+  case LoopSelection::kRoundRobin:
+    break;
+  case LoopSelection::kLeastConnections:
+    return leastLoaded(
+        [](const EventLoop::Load &load) { return load.connections; });
+  case LoopSelection::kLeastPending:
+    return leastLoaded(
+        [](const EventLoop::Load &load) { return load.pendingFunctors; });
+  case LoopSelection::kPowerOfTwoChoices:
+    return powerOfTwoChoices();
+  }
+
+  EventLoop *loop = loops_[static_cast<size_t>(next_)];
+  ++next_;
+  if (static_cast<size_t>(next_) >= loops_.size()) {
+    next_ = 0;
   }
   return loop;
 }
 
+// Ties go round robin, or an idle pool would fill its first loop first.
+EventLoop *EventLoopThreadPool::leastLoaded(auto &&key) {
+  const auto start = static_cast<size_t>(next_);
+  next_ = static_cast<int>((start + 1) % loops_.size());
+  EventLoop *best = nullptr;
+  auto bestKey = key(EventLoop::Load{});
+  for (size_t i = 0; i < loops_.size(); ++i) {
+    EventLoop *loop = loops_[(start + i) % loops_.size()];
+    const auto loopKey = key(loop->load());
+    if (best == nullptr || loopKey < bestKey) {
+      best = loop;
+      bestKey = loopKey;
+    }
+  }
+  return best;
+}
+
+EventLoop *EventLoopThreadPool::powerOfTwoChoices() {
+  if (loops_.size() == 1) {
+    return loops_.front();
+  }
+  // xorshift64: the draws only need to be cheap and spread out.
+  random_ ^= random_ << 13;
+  random_ ^= random_ >> 7;
+  random_ ^= random_ << 17;
+  const size_t first = random_ % loops_.size();
+  size_t second = (random_ >> 32) % (loops_.size() - 1);
+  if (second >= first) {
+    ++second;
+  }
+
+  const auto rank = [this](size_t index) {
+    return std::pair{busyPermille(index), loops_[index]->load().connections};
+  };
+  return loops_[rank(second) < rank(first) ? second : first];
+}
+
+int EventLoopThreadPool::busyPermille(size_t index) {
+  // Refreshed at most once per period.
+  constexpr std::int64_t kPeriodMicros = 10 * 1000;
+  BusySample &sample = busySamples_[index];
+  const std::int64_t now = Timestamp::now().microSecondsSinceEpoch();
+  const std::int64_t elapsed = now - sample.atMicros;
+  if (elapsed >= kPeriodMicros) {
+    const std::int64_t busy = loops_[index]->load().busyMicros;
+    sample.permille = static_cast<int>(
+        std::clamp<std::int64_t>((busy - sample.busyMicros) * 1000 / elapsed, 0,
+                                 1000));
+    sample.busyMicros = busy;
+    sample.atMicros = now;
+  }
+  return sample.permille;
+}
+
 EventLoop *EventLoopThreadPool::getLoopForHash(size_t hashCode) {
   baseLoop_->assertInLoopThread();
   assert(started_);
@@ -75,4 +161,25 @@ std::vector<EventLoop *> EventLoopThreadPool::getAllLoops() {
   return loops_;
 }
 
+EventLoop *EventLoopThreadPool::getLoopForCpu(int cpu) {
+  baseLoop_->assertInLoopThread();
+  assert(started_);
+  for (EventLoop *loop : loops_) {
+    const auto cpus = cpusOf(loop);
+    if (std::ranges::find(cpus, cpu) != cpus.end()) {
+      return loop;
+    }
+  }
+  return nullptr;
+}
+
+std::span<const int> EventLoopThreadPool::cpusOf(const EventLoop *loop) const {
+  const auto it = std::ranges::find(loops_, loop);
+  if (cpuSets_.empty() || it == loops_.end()) {
+    return {};
+  }
+  const auto index = static_cast<size_t>(it - loops_.begin());
+  return cpuSets_[index % cpuSets_.size()];
+}
+
 } // namespace muduo::net
@@ -3,8 +3,11 @@
 #include "muduo/base/noncopyable.h"
 #include "muduo/net/Callbacks.h"
 
+#include <chrono>
 #include <concepts>
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -13,6 +16,21 @@ namespace muduo::net {
 
 class EventLoop;
 class EventLoopThread;
+enum class PollerBackend : std::uint8_t;
+enum class TimerBackend : std::uint8_t;
+
+// How getNextLoop() picks a loop, from the counters of EventLoop::load().
+// kRoundRobin ignores load. kLeastConnections and kLeastPending scan every
+// loop for the fewest connections or queued functors. kPowerOfTwoChoices
+// compares two loops drawn at random by the share of recent time each spent
+// busy, which also notices a few heavy connections, and breaks ties by
+// connections.
+enum class LoopSelection : std::uint8_t {
+  kRoundRobin,
+  kLeastConnections,
+  kLeastPending,
+  kPowerOfTwoChoices
+};
 
 class EventLoopThreadPool : muduo::noncopyable {
 public:
@@ -22,6 +40,25 @@ public:
   ~EventLoopThreadPool();
 
   void setThreadNum(int numThreads) { numThreads_ = numThreads; }
+  // Backends of the loops created by start(); the base loop is not affected.
+  void setPollerBackend(PollerBackend backend) { backend_ = backend; }
+  void setTimerBackend(TimerBackend backend) { timerBackend_ = backend; }
+  // Puts the first numLoops loops created by start() into latency mode (see
+  // EventLoop::setBusyPollBudget and EventLoop::setSocketBusyPoll); the
+  // remaining loops keep blocking. With no threads it applies to the base
+  // loop.
+  void setBusyPoll(int numLoops, std::chrono::microseconds budget,
+                   std::chrono::microseconds socketBusyPoll = {}) {
+    busyPollLoops_ = numLoops;
+    busyPollBudget_ = budget;
+    socketBusyPoll_ = socketBusyPoll;
+  }
+  void setLoopSelection(LoopSelection selection) { selection_ = selection; }
+  // Pins the thread of loop i to cpuSets[i % cpuSets.size()] and keeps its
+  // memory on that NUMA node (see EventLoopThread::setCpuAffinity).
+  void setCpuAffinity(std::vector<std::vector<int>> cpuSets) {
+    cpuSets_ = std::move(cpuSets);
+  }
   void start(ThreadInitCallback cb = {});
   template <typename F>
     requires CallbackBindable<F, ThreadInitCallback>
@@ -32,18 +69,43 @@ public:
   [[nodiscard]] EventLoop *getNextLoop();
   [[nodiscard]] EventLoop *getLoopForHash(size_t hashCode);
   [[nodiscard]] std::vector<EventLoop *> getAllLoops();
+  // The loop pinned to cpu, or nullptr.
+  [[nodiscard]] EventLoop *getLoopForCpu(int cpu);
+  // The CPUs loop is pinned to; empty if it is not.
+  [[nodiscard]] std::span<const int> cpusOf(const EventLoop *loop) const;
 
   [[nodiscard]] bool started() const noexcept { return started_; }
   [[nodiscard]] const string &name() const noexcept { return name_; }
 
 private:
+  void applyBusyPoll(EventLoop *loop) const;
+  [[nodiscard]] EventLoop *leastLoaded(auto &&key);
+  [[nodiscard]] EventLoop *powerOfTwoChoices();
+  // Share of the last sampling period loops_[index] spent busy, in permille.
+  [[nodiscard]] int busyPermille(size_t index);
+
   EventLoop *baseLoop_;
   string name_;
   bool started_{false};
   int numThreads_{0};
+  PollerBackend backend_{};
+  TimerBackend timerBackend_{};
+  int busyPollLoops_{0};
+  std::chrono::microseconds busyPollBudget_{0};
+  std::chrono::microseconds socketBusyPoll_{0};
   int next_{0};
+  LoopSelection selection_{LoopSelection::kRoundRobin};
+  std::vector<std::vector<int>> cpuSets_;
   std::vector<std::unique_ptr<EventLoopThread>> threads_;
   std::vector<EventLoop *> loops_;
+  // EventLoop::Load::busyMicros of each loop when last sampled.
+  struct BusySample {
+    std::int64_t busyMicros{0};
+    std::int64_t atMicros{0};
+    int permille{0};
+  };
+  std::vector<BusySample> busySamples_;
+  std::uint64_t random_{0x9e3779b97f4a7c15ULL};
 };
 
 } // namespace muduo::net
@@ -3,16 +3,26 @@
 #include "muduo/net/Channel.h"
 #include "muduo/net/EventLoop.h"
 
+#include <algorithm>
+#include <limits>
+
 using namespace muduo::net;
 
 Poller::Poller(EventLoop *loop) : ownerLoop_(loop) {}
 
 Poller::~Poller() = default;
 
+muduo::Timestamp Poller::pollFor(std::chrono::nanoseconds timeout,
+                         ChannelList *activeChannels) {
+  const auto timeoutMs = std::chrono::ceil<std::chrono::milliseconds>(timeout);
+  return poll(static_cast<int>(std::min<std::int64_t>(
+                  timeoutMs.count(), std::numeric_limits<int>::max())),
+              activeChannels);
+}
+
 bool Poller::hasChannel(Channel *channel) const {
   assertInLoopThread();
-  const auto it = channels_.find(channel->fd());
-  return it != channels_.end() && it->second == channel;
+  return channels_.find(channel->fd()) == channel;
 }
 
 void Poller::assertInLoopThread() const { ownerLoop_->assertInLoopThread(); }
@@ -3,35 +3,80 @@
 #include "muduo/base/Timestamp.h"
 #include "muduo/base/noncopyable.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <memory>
-#include <unordered_map>
 #include <vector>
 
 namespace muduo::net {
 
 class Channel;
 class EventLoop;
+enum class PollerBackend : std::uint8_t;
 
 class Poller : muduo::noncopyable {
 public:
   using ChannelList = std::vector<Channel *>;
 
+  // Registered channels by fd. Descriptors are small dense integers, so this
+  // is a vector indexed by fd that grows on demand rather than a hash map.
+  class ChannelMap {
+  public:
+    [[nodiscard]] Channel *find(int fd) const noexcept {
+      return static_cast<size_t>(fd) < channels_.size()
+                 ? channels_[static_cast<size_t>(fd)]
+                 : nullptr;
+    }
+    [[nodiscard]] bool contains(int fd) const noexcept {
+      return find(fd) != nullptr;
+    }
+    void insert(int fd, Channel *channel) {
+      if (static_cast<size_t>(fd) >= channels_.size()) {
+        channels_.resize(
+            std::max(static_cast<size_t>(fd) + 1, channels_.size() * 2));
+      }
+      auto &slot = channels_[static_cast<size_t>(fd)];
+      size_ += slot == nullptr ? 1 : 0;
+      slot = channel;
+    }
+    size_t erase(int fd) noexcept {
+      if (!contains(fd)) {
+        return 0;
+      }
+      channels_[static_cast<size_t>(fd)] = nullptr;
+      --size_;
+      return 1;
+    }
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+
+  private:
+    std::vector<Channel *> channels_;
+    size_t size_{0};
+  };
+
   explicit Poller(EventLoop *loop);
   virtual ~Poller();
 
   [[nodiscard]] virtual Timestamp poll(int timeoutMs,
                                        ChannelList *activeChannels) = 0;
+  // Like poll(), with a finer timeout. Pollers without a finer wait round
+  // it up to whole milliseconds.
+  [[nodiscard]] virtual Timestamp pollFor(std::chrono::nanoseconds timeout,
+                                          ChannelList *activeChannels);
   virtual void updateChannel(Channel *channel) = 0;
   virtual void removeChannel(Channel *channel) = 0;
 
   [[nodiscard]] virtual bool hasChannel(Channel *channel) const;
+  [[nodiscard]] virtual bool supportsEdgeTriggered() const { return false; }
 
   [[nodiscard]] static std::unique_ptr<Poller> newDefaultPoller(EventLoop *loop);
+  [[nodiscard]] static std::unique_ptr<Poller> newPoller(EventLoop *loop,
+                                                         PollerBackend backend);
 
   void assertInLoopThread() const;
 
 protected:
-  using ChannelMap = std::unordered_map<int, Channel *>;
   ChannelMap channels_;
 
 private:
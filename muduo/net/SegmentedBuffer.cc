@@ -0,0 +1,312 @@
+#include "muduo/net/SegmentedBuffer.h"
+
+#include "muduo/net/SocketsOps.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <sys/uio.h>
+
+using namespace muduo::net;
+
+size_t SegmentedBuffer::writableBytes() const {
+  if (!hasSlab()) {
+    return 0;
+  }
+  return slabs_[tail_].freeBytes() + spareSlabs() * kSlabSize;
+}
+
+size_t SegmentedBuffer::prependableBytes() const {
+  if (!hasSlab()) {
+    return kCheapPrepend;
+  }
+  return slabs_[head_].data != nullptr ? slabs_[head_].readerIndex : 0;
+}
+
+size_t SegmentedBuffer::internalCapacity() const {
+  size_t owned = 0;
+  for (size_t i = head_; i < slabs_.size(); ++i) {
+    owned += slabs_[i].data != nullptr ? kSlabSize : 0;
+  }
+  return owned;
+}
+
+std::span<const std::byte> SegmentedBuffer::frontSpan() const {
+  if (!hasSlab()) {
+    return {};
+  }
+  const Slab &slab = slabs_[head_];
+  return {slab.begin() + slab.readerIndex, slab.writerIndex - slab.readerIndex};
+}
+
+void SegmentedBuffer::peekInto(std::span<std::byte> out) const {
+  assert(out.size() <= readable_);
+  for (size_t i = head_; !out.empty(); ++i) {
+    const Slab &slab = slabs_[i];
+    const size_t n = std::min(out.size(), slab.writerIndex - slab.readerIndex);
+    std::memcpy(out.data(), slab.begin() + slab.readerIndex, n);
+    out = out.subspan(n);
+  }
+}
+
+ByteSlice SegmentedBuffer::frontSlice() const {
+  for (size_t i = head_; i <= tail_ && readable_ > 0; ++i) {
+    const Slab &slab = slabs_[i];
+    if (slab.writerIndex == slab.readerIndex) {
+      continue;
+    }
+    if (slab.data != nullptr) {
+      return {};
+    }
+    return slab.slice.subslice(slab.readerIndex,
+                               slab.writerIndex - slab.readerIndex);
+  }
+  return {};
+}
+
+size_t SegmentedBuffer::readableIovecs(std::span<iovec> iov) const {
+  size_t count = 0;
+  if (readable_ == 0) {
+    return count;
+  }
+  for (size_t i = head_; i <= tail_ && count < iov.size(); ++i) {
+    const Slab &slab = slabs_[i];
+    if (slab.writerIndex == slab.readerIndex) {
+      continue;
+    }
+    iov[count].iov_base = const_cast<std::byte *>(slab.begin()) +
+                          slab.readerIndex;
+    iov[count].iov_len = slab.writerIndex - slab.readerIndex;
+    ++count;
+  }
+  return count;
+}
+
+void SegmentedBuffer::retrieve(size_t len) {
+  assert(len <= readable_);
+  readable_ -= len;
+  while (len > 0) {
+    Slab &slab = slabs_[head_];
+    const size_t n = std::min(len, slab.writerIndex - slab.readerIndex);
+    slab.readerIndex += n;
+    len -= n;
+    if (slab.readerIndex == slab.writerIndex) {
+      popFront();
+    }
+  }
+}
+
+std::string SegmentedBuffer::retrieveAsString(size_t len) {
+  assert(len <= readable_);
+  std::string result(len, '\0');
+  peekInto(std::as_writable_bytes(std::span{result.data(), result.size()}));
+  retrieve(len);
+  return result;
+}
+
+void SegmentedBuffer::append(std::span<const std::byte> data) {
+  while (!data.empty()) {
+    Slab &slab = writableSlab();
+    const size_t n = std::min(data.size(), kSlabSize - slab.writerIndex);
+    std::memcpy(slab.data.get() + slab.writerIndex, data.data(), n);
+    slab.writerIndex += n;
+    readable_ += n;
+    data = data.subspan(n);
+  }
+}
+
+void SegmentedBuffer::append(ByteSlice slice) {
+  if (slice.size() < kMinSliceBytes) {
+    append(slice.bytes());
+    return;
+  }
+  const size_t size = slice.size();
+  Slab segment{nullptr, 0, size, std::move(slice)};
+  if (!hasSlab()) {
+    slabs_.clear();
+    head_ = 0;
+    tail_ = 0;
+    slabs_.push_back(std::move(segment));
+  } else if (readable_ == 0) {
+    // In front of the empty slab, which becomes a spare.
+    slabs_[head_].readerIndex = 0;
+    slabs_[head_].writerIndex = 0;
+    slabs_.insert(slabs_.begin() + static_cast<ptrdiff_t>(head_),
+                  std::move(segment));
+    tail_ = head_;
+  } else {
+    ++tail_;
+    slabs_.insert(slabs_.begin() + static_cast<ptrdiff_t>(tail_),
+                  std::move(segment));
+  }
+  readable_ += size;
+}
+
+void SegmentedBuffer::prepend(std::span<const std::byte> data) {
+  assert(data.size() <= prependableBytes());
+  if (!hasSlab()) {
+    (void)writableSlab();
+  }
+  Slab &slab = slabs_[head_];
+  slab.readerIndex -= data.size();
+  std::memcpy(slab.data.get() + slab.readerIndex, data.data(), data.size());
+  readable_ += data.size();
+}
+
+void SegmentedBuffer::shrink() {
+  if (readable_ == 0) {
+    releaseSlabs();
+    slabs_.shrink_to_fit();
+    return;
+  }
+  while (slabs_.size() > tail_ + 1) {
+    releaseSlab(std::move(slabs_.back().data));
+    slabs_.pop_back();
+  }
+  slabs_.erase(slabs_.begin(), slabs_.begin() + static_cast<ptrdiff_t>(head_));
+  tail_ -= head_;
+  head_ = 0;
+  slabs_.shrink_to_fit();
+}
+
+ssize_t SegmentedBuffer::readFd(int fd, int *savedErrno) {
+  std::array<std::byte, 65536> extraBuffer;
+
+  // At least one whole slab of direct space, so that a typical read lands
+  // in place.
+  if (writableBytes() < kSlabSize) {
+    if (hasSlab()) {
+      pushSlab(0);
+    } else {
+      (void)writableSlab();
+    }
+  }
+
+  std::array<iovec, kMaxSpareSlabs + 3> vec{};
+  size_t iovcnt = 0;
+  size_t writable = 0;
+  for (size_t i = tail_; i < slabs_.size() && iovcnt + 1 < vec.size(); ++i) {
+    Slab &slab = slabs_[i];
+    if (slab.data == nullptr) {
+      continue;
+    }
+    vec[iovcnt].iov_base = slab.data.get() + slab.writerIndex;
+    vec[iovcnt].iov_len = slab.freeBytes();
+    writable += vec[iovcnt].iov_len;
+    if (vec[iovcnt].iov_len > 0) {
+      ++iovcnt;
+    }
+  }
+  if (writable < extraBuffer.size()) {
+    vec[iovcnt].iov_base = extraBuffer.data();
+    vec[iovcnt].iov_len = extraBuffer.size();
+    ++iovcnt;
+  }
+
+  const ssize_t n = sockets::readv(fd, std::span<const iovec>{vec}.first(iovcnt));
+  if (n < 0) {
+    *savedErrno = errno;
+    return n;
+  }
+  const auto received = static_cast<size_t>(n);
+  hasWritten(std::min(received, writable));
+  if (received > writable) {
+    append(std::span<const std::byte>{extraBuffer.data(), received - writable});
+  }
+  return n;
+}
+
+ssize_t SegmentedBuffer::writeFd(int fd, int *savedErrno) {
+  std::array<iovec, kMaxWriteSlabs> vec{};
+  const size_t iovcnt = readableIovecs(vec);
+  const ssize_t n =
+      sockets::writev(fd, std::span<const iovec>{vec}.first(iovcnt));
+  if (n < 0) {
+    *savedErrno = errno;
+    return n;
+  }
+  retrieve(static_cast<size_t>(n));
+  return n;
+}
+
+void SegmentedBuffer::pushSlab(size_t startIndex) {
+  slabs_.push_back(
+      Slab{pool_ != nullptr
+               ? pool_->acquire()
+               : std::make_unique_for_overwrite<std::byte[]>(kSlabSize),
+           startIndex, startIndex, {}});
+}
+
+SegmentedBuffer::Slab &SegmentedBuffer::writableSlab() {
+  if (!hasSlab()) {
+    slabs_.clear();
+    head_ = 0;
+    tail_ = 0;
+    pushSlab(kCheapPrepend);
+  } else if (slabs_[tail_].freeBytes() == 0) {
+    ++tail_;
+    if (tail_ == slabs_.size()) {
+      pushSlab(0);
+    }
+  }
+  return slabs_[tail_];
+}
+
+void SegmentedBuffer::hasWritten(size_t len) {
+  assert(len <= writableBytes());
+  readable_ += len;
+  while (len > 0) {
+    Slab &slab = writableSlab();
+    const size_t n = std::min(len, slab.freeBytes());
+    slab.writerIndex += n;
+    len -= n;
+  }
+}
+
+void SegmentedBuffer::popFront() {
+  Slab &front = slabs_[head_];
+  if (head_ == tail_) {
+    if (pool_ != nullptr || front.data == nullptr) {
+      releaseSlabs();
+      return;
+    }
+    // Drained; start over with the prepend room Buffer keeps.
+    front.readerIndex = kCheapPrepend;
+    front.writerIndex = kCheapPrepend;
+    return;
+  }
+  // Dropping a slice lets go of the caller's storage.
+  front.slice = ByteSlice();
+  auto data = std::move(front.data);
+  ++head_;
+  if (data != nullptr && pool_ == nullptr && spareSlabs() < kMaxSpareSlabs) {
+    slabs_.push_back(Slab{std::move(data), 0, 0, {}});
+  } else {
+    releaseSlab(std::move(data));
+  }
+  // Released slots are compacted once they make up half of the vector, so
+  // draining a long chain costs O(1) per slab.
+  if (head_ * 2 >= slabs_.size()) {
+    slabs_.erase(slabs_.begin(),
+                 slabs_.begin() + static_cast<ptrdiff_t>(head_));
+    tail_ -= head_;
+    head_ = 0;
+  }
+}
+
+void SegmentedBuffer::releaseSlab(std::unique_ptr<std::byte[]> data) {
+  if (pool_ != nullptr && data != nullptr) {
+    pool_->release(std::move(data));
+  }
+}
+
+void SegmentedBuffer::releaseSlabs() {
+  for (size_t i = head_; i < slabs_.size(); ++i) {
+    releaseSlab(std::move(slabs_[i].data));
+  }
+  slabs_.clear();
+  head_ = 0;
+  tail_ = 0;
+  readable_ = 0;
+}
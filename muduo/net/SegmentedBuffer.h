@@ -0,0 +1,244 @@
+#pragma once
+
+#include "muduo/net/Buffer.h"
+#include "muduo/net/BufferPool.h"
+#include "muduo/net/ByteSlice.h"
+#include "muduo/net/Endian.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+struct iovec;
+
+namespace muduo::net {
+
+// Byte queue kept as a chain of fixed-size slabs instead of one contiguous
+// vector: appending never moves or reallocates what is already queued, and
+// retrieving releases whole slabs from the front. Meant for large outgoing
+// data; readFd() and writeFd() scatter/gather over the slabs directly.
+//
+// Mirrors Buffer where a contiguous view is not needed. peek() only covers
+// the front slab; peekInto() and retrieveAsString() copy across slabs.
+// Drained slabs are kept as spare capacity, up to kMaxSpareSlabs. With a
+// BufferPool, slabs come from the pool instead and go back to it as soon as
+// they drain, so an empty buffer holds no memory; such a buffer must only be
+// used and destroyed in the pool's loop thread, or detached with
+// setPool(nullptr) there first.
+//
+// append(ByteSlice) links the slice into the chain by reference instead of
+// copying it; such a segment is read-only and released once retrieved.
+class SegmentedBuffer {
+public:
+  static constexpr size_t kSlabSize = BufferPool::kSlabSize;
+  static constexpr size_t kCheapPrepend = Buffer::kCheapPrepend;
+  static constexpr size_t kMaxSpareSlabs = 4;
+  // Slabs handed to one writev(); IOV_MAX is far larger.
+  static constexpr size_t kMaxWriteSlabs = 64;
+  // Smaller slices are copied; a segment of their own costs more than that.
+  static constexpr size_t kMinSliceBytes = 512;
+
+  // Allocates nothing until the first append().
+  SegmentedBuffer() = default;
+  explicit SegmentedBuffer(BufferPool *pool) : pool_(pool) {}
+  ~SegmentedBuffer() { releaseSlabs(); }
+  SegmentedBuffer(const SegmentedBuffer &) = delete;
+  SegmentedBuffer &operator=(const SegmentedBuffer &) = delete;
+  SegmentedBuffer(SegmentedBuffer &&rhs) noexcept
+      : slabs_(std::exchange(rhs.slabs_, {})),
+        head_(std::exchange(rhs.head_, 0)), tail_(std::exchange(rhs.tail_, 0)),
+        readable_(std::exchange(rhs.readable_, 0)), pool_(rhs.pool_) {}
+  SegmentedBuffer &operator=(SegmentedBuffer &&rhs) noexcept {
+    SegmentedBuffer moved(std::move(rhs));
+    swap(moved);
+    return *this;
+  }
+
+  void swap(SegmentedBuffer &rhs) noexcept {
+    std::swap(pool_, rhs.pool_);
+    slabs_.swap(rhs.slabs_);
+    std::swap(head_, rhs.head_);
+    std::swap(tail_, rhs.tail_);
+    std::swap(readable_, rhs.readable_);
+  }
+
+  [[nodiscard]] size_t readableBytes() const { return readable_; }
+  [[nodiscard]] bool empty() const { return readable_ == 0; }
+  // Free space in the tail slab and the spare slabs behind it.
+  [[nodiscard]] size_t writableBytes() const;
+  [[nodiscard]] size_t prependableBytes() const;
+  [[nodiscard]] size_t numSlabs() const { return slabs_.size() - head_; }
+  // Bytes of owned slabs; slices are not counted.
+  [[nodiscard]] size_t internalCapacity() const;
+
+  // The readable bytes of the front slab.
+  [[nodiscard]] std::span<const std::byte> frontSpan() const;
+  [[nodiscard]] const std::byte *peek() const { return frontSpan().data(); }
+  // Copies the first out.size() readable bytes.
+  void peekInto(std::span<std::byte> out) const;
+  // Fills iov with the readable slabs, front first; returns how many it used.
+  [[nodiscard]] size_t readableIovecs(std::span<iovec> iov) const;
+  // The readable part of the front segment, sharing its storage, if that
+  // segment was linked in by append(ByteSlice); else an empty slice.
+  [[nodiscard]] ByteSlice frontSlice() const;
+
+  void retrieve(size_t len);
+  void retrieveInt64() { retrieve(sizeof(int64_t)); }
+  void retrieveInt32() { retrieve(sizeof(int32_t)); }
+  void retrieveInt16() { retrieve(sizeof(int16_t)); }
+  void retrieveInt8() { retrieve(sizeof(int8_t)); }
+  void retrieveAll() { retrieve(readable_); }
+
+  [[nodiscard]] std::string retrieveAllAsString() {
+    return retrieveAsString(readable_);
+  }
+  [[nodiscard]] std::string retrieveAsString(size_t len);
+
+  void append(const string &str) { append(std::string_view{str}); }
+  void append(std::string_view str) {
+    append(std::as_bytes(std::span{str.data(), str.size()}));
+  }
+  void append(const void *data, size_t len) {
+    append(std::as_bytes(std::span{static_cast<const char *>(data), len}));
+  }
+  void append(std::span<const std::byte> data);
+  // Queues slice without copying it, unless it is below kMinSliceBytes.
+  void append(ByteSlice slice);
+
+  void appendInt64(int64_t x) {
+    const auto be64 = sockets::hostToNetwork64(static_cast<uint64_t>(x));
+    append(std::as_bytes(std::span{&be64, 1}));
+  }
+  void appendInt32(int32_t x) {
+    const auto be32 = sockets::hostToNetwork32(static_cast<uint32_t>(x));
+    append(std::as_bytes(std::span{&be32, 1}));
+  }
+  void appendInt16(int16_t x) {
+    const auto be16 = sockets::hostToNetwork16(static_cast<uint16_t>(x));
+    append(std::as_bytes(std::span{&be16, 1}));
+  }
+  void appendInt8(int8_t x) { append(std::as_bytes(std::span{&x, 1})); }
+
+  [[nodiscard]] int64_t peekInt64() const {
+    uint64_t be64 = 0;
+    peekInto(std::as_writable_bytes(std::span{&be64, 1}));
+    return static_cast<int64_t>(sockets::networkToHost64(be64));
+  }
+  [[nodiscard]] int32_t peekInt32() const {
+    uint32_t be32 = 0;
+    peekInto(std::as_writable_bytes(std::span{&be32, 1}));
+    return static_cast<int32_t>(sockets::networkToHost32(be32));
+  }
+  [[nodiscard]] int16_t peekInt16() const {
+    uint16_t be16 = 0;
+    peekInto(std::as_writable_bytes(std::span{&be16, 1}));
+    return static_cast<int16_t>(sockets::networkToHost16(be16));
+  }
+  [[nodiscard]] int8_t peekInt8() const {
+    assert(readable_ >= sizeof(int8_t));
+    return static_cast<int8_t>(*peek());
+  }
+
+  [[nodiscard]] int64_t readInt64() {
+    const int64_t result = peekInt64();
+    retrieveInt64();
+    return result;
+  }
+  [[nodiscard]] int32_t readInt32() {
+    const int32_t result = peekInt32();
+    retrieveInt32();
+    return result;
+  }
+  [[nodiscard]] int16_t readInt16() {
+    const int16_t result = peekInt16();
+    retrieveInt16();
+    return result;
+  }
+  [[nodiscard]] int8_t readInt8() {
+    const int8_t result = peekInt8();
+    retrieveInt8();
+    return result;
+  }
+
+  // Only into the head room of the front slab, kCheapPrepend bytes after
+  // the buffer has been drained; never in front of a slice.
+  void prepend(std::span<const std::byte> data);
+  void prepend(const void *data, size_t len) {
+    prepend(std::as_bytes(std::span{static_cast<const char *>(data), len}));
+  }
+  void prependInt64(int64_t x) {
+    const auto be64 = sockets::hostToNetwork64(static_cast<uint64_t>(x));
+    prepend(std::as_bytes(std::span{&be64, 1}));
+  }
+  void prependInt32(int32_t x) {
+    const auto be32 = sockets::hostToNetwork32(static_cast<uint32_t>(x));
+    prepend(std::as_bytes(std::span{&be32, 1}));
+  }
+  void prependInt16(int16_t x) {
+    const auto be16 = sockets::hostToNetwork16(static_cast<uint16_t>(x));
+    prepend(std::as_bytes(std::span{&be16, 1}));
+  }
+  void prependInt8(int8_t x) { prepend(std::as_bytes(std::span{&x, 1})); }
+
+  // Releases the spare slabs, and everything if the buffer is empty.
+  void shrink();
+
+  [[nodiscard]] BufferPool *pool() const { return pool_; }
+  // Returns the slabs of an empty buffer to the old pool, if any.
+  void setPool(BufferPool *pool) {
+    assert(empty());
+    releaseSlabs();
+    pool_ = pool;
+  }
+
+  // readv() into the free slab space, with a stack buffer behind it for
+  // whatever does not fit.
+  [[nodiscard]] ssize_t readFd(int fd, int *savedErrno);
+  // writev() of up to kMaxWriteSlabs slabs; retrieves what was written.
+  [[nodiscard]] ssize_t writeFd(int fd, int *savedErrno);
+
+private:
+  // Owns data, or else refers to slice, which fills [0, writerIndex).
+  struct Slab {
+    std::unique_ptr<std::byte[]> data;
+    size_t readerIndex{0};
+    size_t writerIndex{0};
+    ByteSlice slice;
+
+    [[nodiscard]] const std::byte *begin() const {
+      return data != nullptr ? data.get() : slice.data();
+    }
+    [[nodiscard]] size_t freeBytes() const {
+      return data != nullptr ? kSlabSize - writerIndex : 0;
+    }
+  };
+
+  [[nodiscard]] bool hasSlab() const { return head_ < slabs_.size(); }
+  [[nodiscard]] size_t spareSlabs() const {
+    return hasSlab() ? slabs_.size() - tail_ - 1 : 0;
+  }
+  void pushSlab(size_t startIndex);
+  // The slab the next byte goes to; allocates if the chain is full.
+  Slab &writableSlab();
+  // Commits len bytes written into the writable space.
+  void hasWritten(size_t len);
+  void popFront();
+  void releaseSlab(std::unique_ptr<std::byte[]> data);
+  void releaseSlabs();
+
+  // Live slabs are [head_, size): readable data from head_ to tail_, empty
+  // spares after tail_. Slabs before head_ are released and compacted away.
+  std::vector<Slab> slabs_;
+  size_t head_{0};
+  size_t tail_{0};
+  size_t readable_{0};
+  BufferPool *pool_{nullptr};
+};
+
+} // namespace muduo::net
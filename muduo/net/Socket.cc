@@ -97,6 +97,42 @@ void Socket::setKeepAlive(bool on) const {
                         static_cast<socklen_t>(sizeof optval), "SO_KEEPALIVE");
 }
 
+void Socket::setBusyPoll(std::chrono::microseconds timeout) const {
+#ifdef SO_BUSY_POLL
+  int optval = static_cast<int>(timeout.count());
+  (void)setSockOptOrLog(SOL_SOCKET, SO_BUSY_POLL, &optval,
+                        static_cast<socklen_t>(sizeof optval), "SO_BUSY_POLL");
+#else
+  if (timeout > std::chrono::microseconds::zero()) {
+    muduo::logError("SO_BUSY_POLL is not supported");
+  }
+#endif
+}
+
+bool Socket::setZeroCopy(bool on) const {
+#ifdef SO_ZEROCOPY
+  int optval = on ? 1 : 0;
+  return setSockOptOrLog(SOL_SOCKET, SO_ZEROCOPY, &optval,
+                         static_cast<socklen_t>(sizeof optval), "SO_ZEROCOPY");
+#else
+  if (on) {
+    muduo::logError("SO_ZEROCOPY is not supported");
+  }
+  return !on;
+#endif
+}
+
+bool Socket::setIncomingCpu(int cpu) const {
+#ifdef SO_INCOMING_CPU
+  return setSockOptOrLog(SOL_SOCKET, SO_INCOMING_CPU, &cpu,
+                         static_cast<socklen_t>(sizeof cpu), "SO_INCOMING_CPU");
+#else
+  (void)cpu;
+  muduo::logError("SO_INCOMING_CPU is not supported");
+  return false;
+#endif
+}
+
 bool Socket::setSockOptOrLog(int level, int option, const void *optval,
                              socklen_t optlen, const char *optionName,
                              std::source_location loc) const {
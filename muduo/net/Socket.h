@@ -2,6 +2,7 @@
 
 #include "muduo/base/noncopyable.h"
 
+#include <chrono>
 #include <source_location>
 #include <sys/socket.h>
 
@@ -31,6 +32,12 @@ public:
   void setReuseAddr(bool on) const;
   void setReusePort(bool on) const;
   void setKeepAlive(bool on) const;
+  void setBusyPoll(std::chrono::microseconds timeout) const;
+  // SO_ZEROCOPY, which MSG_ZEROCOPY sends need; false if unsupported.
+  [[nodiscard]] bool setZeroCopy(bool on) const;
+  // SO_INCOMING_CPU: steers a SO_REUSEPORT listener's share of connections
+  // to those whose packets are received on cpu.
+  [[nodiscard]] bool setIncomingCpu(int cpu) const;
 
 private:
   [[nodiscard]] bool setSockOptOrLog(
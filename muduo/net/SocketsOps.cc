@@ -14,6 +14,9 @@
 #include <limits>
 #include <string>
 #include <utility>
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <sys/sendfile.h>
 #include <sys/socket.h>
 #include <unistd.h>
 
@@ -114,7 +117,10 @@ int sockets::accept(int sockfd, sockaddr_in6 *addr) {
 #endif
   if (connfd < 0) {
     int savedErrno = errno;
-    muduo::logSysErr("Socket::accept");
+    // EAGAIN is how a batch of accepts normally ends.
+    if (savedErrno != EAGAIN) {
+      muduo::logSysErr("Socket::accept");
+    }
     switch (savedErrno) {
     case EAGAIN:
     case ECONNABORTED:
@@ -188,6 +194,74 @@ ssize_t sockets::write(int sockfd, std::span<const char> buffer) {
   return ::write(sockfd, buffer.data(), buffer.size_bytes());
 }
 
+ssize_t sockets::writev(int sockfd, std::span<const iovec> iov) {
+  if (iov.size() > static_cast<size_t>(std::numeric_limits<int>::max())) {
+    errno = EINVAL;
+    return -1;
+  }
+  return ::writev(sockfd, iov.data(), static_cast<int>(iov.size()));
+}
+
+ssize_t sockets::sendmsg(int sockfd, std::span<const iovec> iov, int flags) {
+  msghdr msg{};
+  msg.msg_iov = const_cast<iovec *>(iov.data());
+  msg.msg_iovlen = iov.size();
+  return ::sendmsg(sockfd, &msg, flags);
+}
+
+ssize_t sockets::sendfile(int sockfd, int fd, off_t *offset, size_t count) {
+  return ::sendfile(sockfd, fd, offset, count);
+}
+
+ssize_t sockets::splice(int pipefd, int sockfd, size_t count) {
+  return ::splice(pipefd, nullptr, sockfd, nullptr, count,
+                  SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+}
+
+ssize_t sockets::sendZeroCopy(int sockfd, std::span<const iovec> iov) {
+#ifdef MSG_ZEROCOPY
+  return sockets::sendmsg(sockfd, iov, MSG_ZEROCOPY);
+#else
+  return sockets::writev(sockfd, iov);
+#endif
+}
+
+bool sockets::readZeroCopyCompletion(int sockfd, uint32_t *first,
+                                     uint32_t *last, bool *copied) {
+#ifdef SO_EE_ORIGIN_ZEROCOPY
+  for (;;) {
+    std::array<char, CMSG_SPACE(sizeof(sock_extended_err))> control{};
+    msghdr msg{};
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    if (::recvmsg(sockfd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+      return false;
+    }
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (!(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) &&
+          !(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)) {
+        continue;
+      }
+      sock_extended_err err{};
+      std::memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
+      if (err.ee_errno == 0 && err.ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+        *first = err.ee_info;
+        *last = err.ee_data;
+        *copied = (err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0;
+        return true;
+      }
+    }
+  }
+#else
+  (void)sockfd;
+  (void)first;
+  (void)last;
+  (void)copied;
+  return false;
+#endif
+}
+
 void sockets::close(int sockfd) {
   if (::close(sockfd) < 0) {
     muduo::logSysErr("sockets::close");
@@ -309,6 +383,20 @@ int sockets::getSocketError(int sockfd) {
   return optval;
 }
 
+int sockets::getIncomingCpu(int sockfd) {
+#ifdef SO_INCOMING_CPU
+  int cpu = -1;
+  auto optlen = static_cast<socklen_t>(sizeof cpu);
+  if (::getsockopt(sockfd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &optlen) < 0) {
+    return -1;
+  }
+  return cpu;
+#else
+  (void)sockfd;
+  return -1;
+#endif
+}
+
 sockaddr_in6 sockets::getLocalAddr(int sockfd) {
   sockaddr_in6 localaddr{};
   auto addrlen = static_cast<socklen_t>(sizeof localaddr);
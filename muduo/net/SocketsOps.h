@@ -2,6 +2,7 @@
 
 #include <arpa/inet.h>
 #include <cstddef>
+#include <cstdint>
 #include <span>
 #include <string_view>
 #include <sys/types.h>
@@ -25,6 +26,24 @@ void listenOrDie(int sockfd);
 [[nodiscard]] ssize_t readv(int sockfd, std::span<const iovec> iov);
 [[nodiscard]] ssize_t write(int sockfd, std::span<const std::byte> buffer);
 [[nodiscard]] ssize_t write(int sockfd, std::span<const char> buffer);
+[[nodiscard]] ssize_t writev(int sockfd, std::span<const iovec> iov);
+// writev() with send flags such as MSG_MORE.
+[[nodiscard]] ssize_t sendmsg(int sockfd, std::span<const iovec> iov,
+                              int flags);
+// sendfile(2) of up to count bytes of fd from *offset, which it advances.
+[[nodiscard]] ssize_t sendfile(int sockfd, int fd, off_t *offset,
+                               size_t count);
+// splice(2) of up to count bytes from the pipe pipefd, never blocking on it.
+[[nodiscard]] ssize_t splice(int pipefd, int sockfd, size_t count);
+// sendmsg(2) of iov with MSG_ZEROCOPY. Each call that succeeds takes the
+// next id, counting from 0 per socket; the pages stay in use until
+// readZeroCopyCompletion() reports that id.
+[[nodiscard]] ssize_t sendZeroCopy(int sockfd, std::span<const iovec> iov);
+// Takes the next MSG_ZEROCOPY notification off the error queue: the sends
+// with ids first to last are done, and copied if the kernel fell back to
+// copying them. False once there is none.
+[[nodiscard]] bool readZeroCopyCompletion(int sockfd, uint32_t *first,
+                                          uint32_t *last, bool *copied);
 void close(int sockfd);
 void shutdownWrite(int sockfd);
 
@@ -43,6 +62,8 @@ void fromIpPort(const char *ip, uint16_t port, sockaddr_in6 *addr);
 #endif
 
 [[nodiscard]] int getSocketError(int sockfd);
+// The CPU that received the socket's packets (SO_INCOMING_CPU), or -1.
+[[nodiscard]] int getIncomingCpu(int sockfd);
 
 [[nodiscard]] const sockaddr *sockaddr_cast(const sockaddr_in *addr) noexcept;
 [[nodiscard]] const sockaddr *sockaddr_cast(const sockaddr_in6 *addr) noexcept;
@@ -105,6 +105,16 @@ void TcpClient::newConnection(int sockfd) {
   auto conn = std::make_shared<TcpConnection>(loop_, connName, sockfd, localAddr,
                                               peerAddr);
 
+  conn->setIoUringCompletion(
+      ioUringCompletion_.load(std::memory_order_acquire));
+  conn->setEdgeTriggered(edgeTriggered_.load(std::memory_order_acquire));
+  conn->setSegmentedOutput(segmentedOutput_.load(std::memory_order_acquire));
+  conn->setDeferredFlush(deferredFlush_.load(std::memory_order_acquire));
+  conn->setCorkedWrites(corkedWrites_.load(std::memory_order_acquire));
+  conn->setBufferIdleTimeout(std::chrono::microseconds{
+      bufferIdleTimeoutUs_.load(std::memory_order_acquire)});
+  conn->setZeroCopyThreshold(zeroCopyThreshold_.load(std::memory_order_acquire));
+
   auto connectionCb = connectionCallback_;
   auto messageCb = messageCallback_;
   auto writeCompleteCb = writeCompleteCallback_;
@@ -5,6 +5,8 @@
 #include "muduo/net/TcpConnection.h"
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <mutex>
 #include <type_traits>
@@ -28,6 +30,34 @@ public:
   [[nodiscard]] EventLoop *getLoop() const { return loop_; }
   [[nodiscard]] bool retry() const { return retry_.load(std::memory_order_acquire); }
   void enableRetry() { retry_.store(true, std::memory_order_release); }
+  // See TcpConnection::setIoUringCompletion; applies to later connections.
+  void setIoUringCompletion(bool on) {
+    ioUringCompletion_.store(on, std::memory_order_release);
+  }
+  // See TcpConnection::setEdgeTriggered; applies to later connections.
+  void setEdgeTriggered(bool on) {
+    edgeTriggered_.store(on, std::memory_order_release);
+  }
+  // See TcpConnection::setSegmentedOutput; applies to later connections.
+  void setSegmentedOutput(bool on) {
+    segmentedOutput_.store(on, std::memory_order_release);
+  }
+  // See TcpConnection::setDeferredFlush; applies to later connections.
+  void setDeferredFlush(bool on) {
+    deferredFlush_.store(on, std::memory_order_release);
+  }
+  // See TcpConnection::setCorkedWrites; applies to later connections.
+  void setCorkedWrites(bool on) {
+    corkedWrites_.store(on, std::memory_order_release);
+  }
+  // See TcpConnection::setBufferIdleTimeout; applies to later connections.
+  void setBufferIdleTimeout(std::chrono::microseconds timeout) {
+    bufferIdleTimeoutUs_.store(timeout.count(), std::memory_order_release);
+  }
+  // See TcpConnection::setZeroCopyThreshold; applies to later connections.
+  void setZeroCopyThreshold(size_t threshold) {
+    zeroCopyThreshold_.store(threshold, std::memory_order_release);
+  }
 
   [[nodiscard]] const string &name() const { return name_; }
 
@@ -65,6 +95,13 @@ private:
   std::shared_ptr<WriteCompleteCallback> writeCompleteCallback_;
   std::atomic<bool> retry_{false};
   std::atomic<bool> connect_{true};
+  std::atomic<bool> ioUringCompletion_{false};
+  std::atomic<bool> edgeTriggered_{false};
+  std::atomic<bool> segmentedOutput_{false};
+  std::atomic<bool> deferredFlush_{false};
+  std::atomic<bool> corkedWrites_{false};
+  std::atomic<std::int64_t> bufferIdleTimeoutUs_{0};
+  std::atomic<size_t> zeroCopyThreshold_{0};
   int nextConnId_{1};
   mutable std::mutex mutex_;
   TcpConnectionPtr connection_;
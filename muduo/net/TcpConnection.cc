@@ -2,20 +2,72 @@
 
 #include "muduo/base/CxxFeatures.h"
 #include "muduo/base/Logging.h"
+#include "muduo/net/BufferPool.h"
 #include "muduo/net/Channel.h"
 #include "muduo/net/EventLoop.h"
 #include "muduo/net/Socket.h"
 #include "muduo/net/SocketsOps.h"
+#include "muduo/net/poller/IoUringPoller.h"
 
+#include <algorithm>
 #include <array>
 #include <cerrno>
 #include <chrono>
+#include <climits>
+#include <fcntl.h>
+#include <limits>
 #include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <type_traits>
+#include <unistd.h>
 #include <utility>
+#include <variant>
 #include <vector>
 
 namespace muduo::net {
 
+namespace {
+
+// Reads per edge-triggered event before yielding to the other channels; a
+// connection that still has data left continues from a queued functor.
+constexpr int kMaxEdgeTriggeredReads = 16;
+
+// iovecs handed to one writev().
+constexpr size_t kMaxIovecs = IOV_MAX;
+
+// Bytes asked of one sendfile() or splice(); the kernel caps it lower.
+constexpr size_t kMaxTransferChunk = size_t{1} << 30;
+
+struct FilledIovecs {
+  // Parts covered, empty ones included.
+  size_t parts{0};
+  size_t count{0};
+  size_t bytes{0};
+};
+
+// Fills iov from the non-empty parts, front first.
+FilledIovecs fillIovecs(std::span<const ByteSlice> parts, std::span<iovec> iov) {
+  FilledIovecs filled;
+  for (; filled.parts < parts.size() && filled.count < iov.size();
+       ++filled.parts) {
+    if (const auto &part = parts[filled.parts]; !part.empty()) {
+      iov[filled.count].iov_base = const_cast<std::byte *>(part.data());
+      iov[filled.count].iov_len = part.size();
+      filled.bytes += part.size();
+      ++filled.count;
+    }
+  }
+  return filled;
+}
+
+bool pipeEmpty(int pipeFd) {
+  int available = 0;
+  return ::ioctl(pipeFd, FIONREAD, &available) == 0 && available == 0;
+}
+
+} // namespace
+
 void defaultConnectionCallback(const TcpConnectionPtr &conn) {
   muduo::logTrace("{} -> {} is {}", conn->localAddress().toIpPort(),
                   conn->peerAddress().toIpPort(),
@@ -43,13 +95,38 @@ TcpConnection::TcpConnection(EventLoop *loop, string name, int sockfd,
   muduo::logDebug("TcpConnection::ctor[{}] at {} fd={}", name_,
                   static_cast<const void *>(this), sockfd);
   socket_->setKeepAlive(true);
+  // Counted from here, not from connectEstablished(), so that a burst of
+  // connections handed out before any is established sees the earlier ones.
+  loop_->addConnectionLoad(1);
 }
 
+// An off-loop send(), sendv() or sendFile()/sendPipe() waiting for the loop.
+struct TcpConnection::PendingSend {
+  struct Gather {
+    std::vector<ByteSlice> parts;
+    WriteCompleteCallback onWritten;
+  };
+
+  template <typename T>
+  explicit PendingSend(T &&payloadArg)
+      : payload(std::forward<T>(payloadArg)) {}
+
+  PendingSend *next{nullptr};
+  std::variant<ByteSlice, Gather, FileTransfer> payload;
+};
+
 TcpConnection::~TcpConnection() {
   muduo::logDebug("TcpConnection::dtor[{}] at {} fd={} state={}", name_,
                   static_cast<const void *>(this), channel_->fd(),
                   stateToString());
   assert(state_ == StateE::kDisconnected);
+  if (countedInLoad_) {
+    loop_->addConnectionLoad(-1);
+  }
+  for (auto *send = pendingSends_.load(std::memory_order_acquire);
+       send != nullptr;) {
+    delete std::exchange(send, send->next);
+  }
 }
 
 bool TcpConnection::getTcpInfo(tcp_info *tcpi) const {
@@ -79,7 +156,131 @@ void TcpConnection::send(const string &message) {
   send(std::string_view{message});
 }
 
-void TcpConnection::send(string &&message) { send(std::string_view{message}); }
+void TcpConnection::send(string &&message) { sendOwned(std::move(message)); }
+
+void TcpConnection::send(std::vector<std::byte> &&message) {
+  sendOwned(std::move(message));
+}
+
+void TcpConnection::send(Buffer &&message) { sendOwned(std::move(message)); }
+
+void TcpConnection::send(ByteSlice message) {
+  if (state_ != StateE::kConnected) {
+    return;
+  }
+  if (loop_->isInLoopThread()) {
+    sendInLoop(std::move(message));
+    return;
+  }
+  queuePendingSend(std::make_unique<PendingSend>(std::move(message)));
+}
+
+void TcpConnection::queuePendingSend(std::unique_ptr<PendingSend> send) {
+  PendingSend *node = send.release();
+  node->next = pendingSends_.load(std::memory_order_relaxed);
+  while (!pendingSends_.compare_exchange_weak(node->next, node,
+                                              std::memory_order_acq_rel,
+                                              std::memory_order_relaxed)) {
+  }
+  // Both sides swap the flag, so either the drain in progress sees this
+  // push or this push sees the flag cleared and schedules another.
+  if (!drainQueued_.exchange(true, std::memory_order_acq_rel)) {
+    const auto weakSelf = weak_from_this();
+    loop_->queueInLoop([weakSelf] {
+      if (const auto self = weakSelf.lock()) {
+        self->drainPendingSends();
+      }
+    });
+  }
+}
+
+void TcpConnection::drainPendingSends() {
+  // What is pushed from now on comes with a drain of its own.
+  (void)drainQueued_.exchange(false, std::memory_order_acq_rel);
+  PendingSend *newest =
+      pendingSends_.exchange(nullptr, std::memory_order_acq_rel);
+  PendingSend *oldest = nullptr;
+  while (newest != nullptr) {
+    PendingSend *next = std::exchange(newest->next, oldest);
+    oldest = std::exchange(newest, next);
+  }
+
+  while (oldest != nullptr) {
+    const std::unique_ptr<PendingSend> send(
+        std::exchange(oldest, oldest->next));
+    if (auto *slice = std::get_if<ByteSlice>(&send->payload)) {
+      drainBatch_.push_back(std::move(*slice));
+      continue;
+    }
+    flushDrainBatch();
+    if (auto *gather = std::get_if<PendingSend::Gather>(&send->payload)) {
+      sendvInLoop(gather->parts, std::move(gather->onWritten));
+    } else {
+      sendFileInLoop(std::move(std::get<FileTransfer>(send->payload)));
+    }
+  }
+  flushDrainBatch();
+  // A shutdown() that came in while these were queued waited for them.
+  if (state_ == StateE::kDisconnecting) {
+    shutdownInLoop();
+  }
+}
+
+void TcpConnection::flushDrainBatch() {
+  if (!drainBatch_.empty()) {
+    sendvInLoop(drainBatch_, {});
+    drainBatch_.clear();
+  }
+}
+
+void TcpConnection::sendv(std::span<const ByteSlice> parts,
+                          WriteCompleteCallback onWritten) {
+  if (state_ != StateE::kConnected) {
+    return;
+  }
+  if (loop_->isInLoopThread()) {
+    sendvInLoop(parts, std::move(onWritten));
+    return;
+  }
+  queuePendingSend(std::make_unique<PendingSend>(PendingSend::Gather{
+      {parts.begin(), parts.end()}, std::move(onWritten)}));
+}
+
+template <typename T> void TcpConnection::sendOwned(T &&message) {
+  if (state_ != StateE::kConnected) {
+    return;
+  }
+  if (loop_->isInLoopThread()) {
+    sendOwnedInLoop(std::forward<T>(message));
+    return;
+  }
+  queuePendingSend(
+      std::make_unique<PendingSend>(ByteSlice(std::forward<T>(message))));
+}
+
+template <typename T> void TcpConnection::sendOwnedInLoop(T &&message) {
+  std::span<const std::byte> bytes;
+  if constexpr (std::is_same_v<std::remove_cvref_t<T>, Buffer>) {
+    bytes = message.readableSpan();
+  } else {
+    bytes = std::as_bytes(std::span{message.data(), message.size()});
+  }
+  if (uring_ != nullptr) {
+    sendInLoop(bytes);
+    return;
+  }
+  if (zeroCopyEligible(bytes.size())) {
+    // Pinned from the first write on.
+    sendInLoop(ByteSlice(std::forward<T>(message)));
+    return;
+  }
+  const auto written = writeNow(bytes);
+  if (!written || *written == bytes.size()) {
+    return;
+  }
+  // Only what the socket did not take is kept, and by reference.
+  queueSlice(ByteSlice(std::forward<T>(message)).subslice(*written));
+}
 
 #if MUDUO_ENABLE_LEGACY_COMPAT
 void TcpConnection::send(StringPiece message) {
@@ -100,13 +301,7 @@ void TcpConnection::send(std::span<const std::byte> message) {
     return;
   }
 
-  std::vector<std::byte> data(message.begin(), message.end());
-  const auto weakSelf = weak_from_this();
-  loop_->runInLoop([weakSelf, data = std::move(data)] {
-    if (const auto self = weakSelf.lock()) {
-      self->sendInLoop(std::span<const std::byte>{data.data(), data.size()});
-    }
-  });
+  send(ByteSlice::copyOf(message));
 }
 
 void TcpConnection::send(Buffer *message) {
@@ -120,73 +315,493 @@ void TcpConnection::send(Buffer *message) {
     return;
   }
 
-  const auto readable = message->readableSpan();
-  std::vector<std::byte> data(readable.begin(), readable.end());
+  auto data = ByteSlice::copyOf(message->readableSpan());
   message->retrieveAll();
-  const auto weakSelf = weak_from_this();
-  loop_->runInLoop([weakSelf, data = std::move(data)] {
-    if (const auto self = weakSelf.lock()) {
-      self->sendInLoop(std::span<const std::byte>{data.data(), data.size()});
-    }
-  });
+  send(std::move(data));
+}
+
+void TcpConnection::sendFile(int fd, off_t offset, size_t length) {
+  sendTransfer(fd, offset, length, false);
+}
+
+void TcpConnection::sendPipe(int pipeFd, size_t length) {
+  sendTransfer(pipeFd, 0, length, true);
+}
+
+void TcpConnection::sendTransfer(int fd, off_t offset, size_t length,
+                                 bool pipe) {
+  if (state_ != StateE::kConnected || length == 0) {
+    return;
+  }
+  const int dupFd = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+  if (dupFd < 0) {
+    muduo::logSysErr("TcpConnection::sendFile");
+    return;
+  }
+  if (loop_->isInLoopThread()) {
+    sendFileInLoop(FileTransfer(dupFd, offset, length, pipe));
+    return;
+  }
+  queuePendingSend(std::make_unique<PendingSend>(
+      FileTransfer(dupFd, offset, length, pipe)));
+}
+
+TcpConnection::FileTransfer::~FileTransfer() {
+  if (fd >= 0) {
+    ::close(fd);
+  }
 }
 
 void TcpConnection::sendInLoop(std::span<const std::byte> message) {
-  loop_->assertInLoopThread();
+  const auto written = writeNow(message);
+  if (!written || *written == message.size()) {
+    return;
+  }
+  const auto rest = message.subspan(*written);
+  checkHighWaterMark(rest.size());
+  // Behind queued slices, bytes have to be queued with them to keep order.
+  if (segmentedOutput_ || !outputSegments_.empty()) {
+    outputSegments_.append(rest);
+  } else {
+    outputBuffer_.append(rest);
+  }
+  startOutput();
+}
 
-  if (state_ == StateE::kDisconnected) {
-    muduo::logWarn("TcpConnection::sendInLoop disconnected, give up writing");
+void TcpConnection::sendInLoop(ByteSlice message) {
+  if (uring_ != nullptr) {
+    sendInLoop(message.bytes());
+    return;
+  }
+  const auto written = writeNow(message.bytes(), &message);
+  if (!written || *written == message.size()) {
     return;
   }
+  queueSlice(message.subslice(*written));
+}
 
-  ssize_t nwrote = 0;
-  size_t remaining = message.size();
-  bool faultError = false;
+void TcpConnection::sendvInLoop(std::span<const ByteSlice> parts,
+                                WriteCompleteCallback onWritten) {
+  loop_->assertInLoopThread();
+  if (state_ == StateE::kDisconnected) {
+    muduo::logWarn("TcpConnection::sendvInLoop disconnected, give up writing");
+    return;
+  }
 
-  if (!channel_->isWriting() && outputBuffer_.readableBytes() == 0) {
-    nwrote = sockets::write(channel_->fd(), message);
+  size_t total = 0;
+  for (const auto &part : parts) {
+    total += part.size();
+  }
+  size_t written = 0;
+  const bool direct = uring_ == nullptr && !deferredFlush_ &&
+                      !outputPending() && queuedOutputBytes() == 0;
+  if (direct) {
+    const ssize_t nwrote = writeParts(parts);
     if (nwrote >= 0) {
-      remaining = message.size() - static_cast<size_t>(nwrote);
-      if (remaining == 0 && writeCompleteCallback_) {
-        const auto weakSelf = weak_from_this();
-        loop_->queueInLoop([weakSelf] {
-          if (const auto self = weakSelf.lock();
-              self && self->writeCompleteCallback_) {
-            self->writeCompleteCallback_(self);
-          }
-        });
+      written = static_cast<size_t>(nwrote);
+    } else if (errno != EWOULDBLOCK) {
+      muduo::logSysErr("TcpConnection::sendvInLoop");
+      if (errno == EPIPE || errno == ECONNRESET) {
+        return;
       }
+    }
+  }
+  bytesAccepted_ += total;
+  if (onWritten) {
+    pendingMessages_.push_back({bytesAccepted_, std::move(onWritten)});
+  }
+  noteWritten(written);
+  if (written == total) {
+    if (direct) {
+      queueWriteComplete();
+    }
+    return;
+  }
+
+  checkHighWaterMark(total - written);
+  size_t skip = written;
+  for (const auto &part : parts) {
+    if (skip >= part.size()) {
+      skip -= part.size();
+      continue;
+    }
+    // The io_uring send path only takes a contiguous buffer.
+    if (uring_ != nullptr) {
+      outputBuffer_.append(part.bytes().subspan(skip));
     } else {
-      nwrote = 0;
-      if (errno != EWOULDBLOCK) {
-        muduo::logSysErr("TcpConnection::sendInLoop");
-        if (errno == EPIPE || errno == ECONNRESET) {
-          faultError = true;
+      outputSegments_.append(part.subslice(skip));
+    }
+    skip = 0;
+  }
+  startOutput();
+}
+
+std::optional<size_t>
+TcpConnection::writeNow(std::span<const std::byte> message,
+                        const ByteSlice *owner) {
+  loop_->assertInLoopThread();
+
+  if (state_ == StateE::kDisconnected) {
+    muduo::logWarn("TcpConnection::sendInLoop disconnected, give up writing");
+    return std::nullopt;
+  }
+  if (uring_ != nullptr || deferredFlush_ || outputPending() ||
+      queuedOutputBytes() > 0) {
+    bytesAccepted_ += message.size();
+    return 0;
+  }
+
+  ssize_t nwrote = 0;
+  if (owner != nullptr && zeroCopyEligible(message.size())) {
+    const iovec iov{const_cast<std::byte *>(message.data()), message.size()};
+    nwrote = writeZeroCopy({owner, 1}, {&iov, 1});
+  } else {
+    nwrote = sockets::write(channel_->fd(), message);
+  }
+  if (nwrote >= 0) {
+    bytesAccepted_ += message.size();
+    noteWritten(static_cast<size_t>(nwrote));
+    if (static_cast<size_t>(nwrote) == message.size()) {
+      queueWriteComplete();
+    }
+    return static_cast<size_t>(nwrote);
+  }
+  if (errno != EWOULDBLOCK) {
+    muduo::logSysErr("TcpConnection::sendInLoop");
+    if (errno == EPIPE || errno == ECONNRESET) {
+      return std::nullopt;
+    }
+  }
+  bytesAccepted_ += message.size();
+  return 0;
+}
+
+void TcpConnection::sendFileInLoop(FileTransfer transfer) {
+  loop_->assertInLoopThread();
+  if (state_ == StateE::kDisconnected) {
+    muduo::logWarn("TcpConnection::sendFileInLoop disconnected, give up "
+                   "writing");
+    return;
+  }
+  if (uring_ != nullptr) {
+    // Completion sends only take user memory; reading the range into it
+    // would stall the loop on disk I/O.
+    muduo::logError("TcpConnection::{} [{}] - not available with io_uring "
+                    "completion I/O",
+                    transfer.pipe ? "sendPipe" : "sendFile", name_);
+    return;
+  }
+
+  const bool idle =
+      !deferredFlush_ && queuedOutputBytes() == 0 && !outputPending();
+  transfer.start = bytesAccepted_;
+  bytesAccepted_ += transfer.remaining;
+  if (idle) {
+    (void)writeFile(transfer);
+    if (transfer.remaining == 0) {
+      queueWriteComplete();
+      return;
+    }
+  }
+  checkHighWaterMark(transfer.remaining);
+  fileTransfers_.push_back(std::move(transfer));
+  startOutput();
+}
+
+ssize_t TcpConnection::writeFile(FileTransfer &transfer) {
+  ssize_t total = 0;
+  while (transfer.remaining > 0) {
+    const size_t chunk = std::min(transfer.remaining, kMaxTransferChunk);
+    const ssize_t n =
+        transfer.pipe
+            ? sockets::splice(transfer.fd, channel_->fd(), chunk)
+            : sockets::sendfile(channel_->fd(), transfer.fd, &transfer.offset,
+                                chunk);
+    if (n > 0) {
+      transfer.remaining -= static_cast<size_t>(n);
+      total += n;
+      noteWritten(static_cast<size_t>(n));
+      continue;
+    }
+
+    int savedErrno = errno;
+    if (n == 0) {
+      // The peer was promised the whole length; it cannot be made up for.
+      muduo::logError("TcpConnection::sendFile [{}] - source ended {} bytes "
+                      "short",
+                      name_, transfer.remaining);
+      const auto weakSelf = weak_from_this();
+      loop_->queueInLoop([weakSelf] {
+        if (const auto self = weakSelf.lock()) {
+          self->forceClose();
         }
+      });
+      savedErrno = ENODATA;
+    } else if (savedErrno == EINTR) {
+      continue;
+    } else if (savedErrno == EAGAIN && transfer.pipe &&
+               pipeEmpty(transfer.fd)) {
+      waitForPipe(transfer.fd);
+    }
+    errno = savedErrno;
+    return total > 0 ? total : -1;
+  }
+  return total;
+}
+
+void TcpConnection::waitForPipe(int pipeFd) {
+  if (!pipeChannel_) {
+    pipeChannel_ = std::make_unique<Channel>(loop_, pipeFd);
+    pipeChannel_->tie(shared_from_this());
+    pipeChannel_->doNotLogHup();
+    // A closed or failed pipe resumes the transfer too, which then ends it.
+    pipeChannel_->setReadCallback([this](Timestamp) { handlePipeReadable(); });
+    pipeChannel_->setCloseCallback([this] { handlePipeReadable(); });
+    pipeChannel_->setErrorCallback([this] { handlePipeReadable(); });
+  }
+  pipeChannel_->enableReading();
+  // The socket stays writable meanwhile; do not spin on it.
+  if (!edgeTriggered_ && channel_->isWriting()) {
+    channel_->disableWriting();
+  }
+}
+
+void TcpConnection::handlePipeReadable() {
+  pipeChannel_->disableReading();
+  // Not from within the pipe channel's event handling, which the transfer
+  // ending would destroy.
+  const auto weakSelf = weak_from_this();
+  loop_->queueInLoop([weakSelf] {
+    const auto self = weakSelf.lock();
+    if (!self || (self->state_ != StateE::kConnected &&
+                  self->state_ != StateE::kDisconnecting)) {
+      return;
+    }
+    if (!self->channel_->isWriting()) {
+      self->channel_->enableWriting();
+    }
+    self->handleWrite();
+  });
+}
+
+bool TcpConnection::waitingForPipe() const {
+  return pipeChannel_ != nullptr && pipeChannel_->isReading();
+}
+
+void TcpConnection::releasePipeChannel() {
+  if (pipeChannel_) {
+    if (!pipeChannel_->isNoneEvent()) {
+      pipeChannel_->disableAll();
+    }
+    pipeChannel_->remove();
+    pipeChannel_.reset();
+  }
+}
+
+ssize_t TcpConnection::writeParts(std::span<const ByteSlice> parts) {
+  size_t length = 0;
+  for (const auto &part : parts) {
+    length += part.size();
+  }
+  const bool zeroCopy = zeroCopyEligible(length);
+  ssize_t total = 0;
+  while (!parts.empty()) {
+    std::array<iovec, kMaxIovecs> iov{};
+    const auto filled = fillIovecs(parts, iov);
+    if (filled.count == 0) {
+      break;
+    }
+
+    const auto vec = std::span<const iovec>{iov}.first(filled.count);
+    const ssize_t n = zeroCopy
+                          ? writeZeroCopy(parts.first(filled.parts), vec)
+                          : sockets::writev(channel_->fd(), vec);
+    if (n <= 0) {
+      return total > 0 ? total : n;
+    }
+    total += n;
+    if (static_cast<size_t>(n) < filled.bytes) {
+      break;
+    }
+    parts = parts.subspan(filled.parts);
+  }
+  return total;
+}
+
+ssize_t TcpConnection::writeZeroCopy(std::span<const ByteSlice> parts,
+                                     std::span<const iovec> iov) {
+  const ssize_t n = sockets::sendZeroCopy(channel_->fd(), iov);
+  if (n < 0) {
+    // Out of optmem for pinning pages; this send is copied instead.
+    return errno == ENOBUFS ? sockets::writev(channel_->fd(), iov) : n;
+  }
+  const uint32_t id = zeroCopyNextId_++;
+  ++zeroCopyStats_.sends;
+  auto pinned = static_cast<size_t>(n);
+  for (const auto &part : parts) {
+    if (pinned == 0) {
+      break;
+    }
+    if (part.empty()) {
+      continue;
+    }
+    const size_t len = std::min(pinned, part.size());
+    zeroCopyPinned_.push_back({id, part.subslice(0, len)});
+    pinned -= len;
+  }
+  return n;
+}
+
+bool TcpConnection::handleZeroCopyCompletions() {
+  bool any = false;
+  uint32_t first = 0;
+  uint32_t last = 0;
+  bool copied = false;
+  while (sockets::readZeroCopyCompletion(channel_->fd(), &first, &last,
+                                         &copied)) {
+    any = true;
+    if (copied) {
+      zeroCopyStats_.copied += last - first + 1;
+    }
+    for (auto &send : zeroCopyPinned_) {
+      // Ids wrap around; compare by distance from first.
+      if (send.id - first <= last - first) {
+        send.done = true;
+        send.slice = ByteSlice();
       }
     }
+    while (!zeroCopyPinned_.empty() && zeroCopyPinned_.front().done) {
+      zeroCopyPinned_.pop_front();
+    }
+  }
+  return any;
+}
+
+TcpConnection::ZeroCopyStats TcpConnection::zeroCopyStats() const {
+  loop_->assertInLoopThread();
+  ZeroCopyStats stats = zeroCopyStats_;
+  stats.pinned = static_cast<size_t>(std::ranges::count_if(
+      zeroCopyPinned_, [](const PinnedSend &send) { return !send.done; }));
+  return stats;
+}
+
+void TcpConnection::noteWritten(size_t len) {
+  bytesWritten_ += len;
+  while (!pendingMessages_.empty() &&
+         pendingMessages_.front().end <= bytesWritten_) {
+    const auto weakSelf = weak_from_this();
+    loop_->queueInLoop(
+        [weakSelf,
+         onWritten = std::move(pendingMessages_.front().onWritten)]() mutable {
+          if (const auto self = weakSelf.lock()) {
+            onWritten(self);
+          }
+        });
+    pendingMessages_.pop_front();
   }
+}
+
+void TcpConnection::queueSlice(ByteSlice slice) {
+  checkHighWaterMark(slice.size());
+  outputSegments_.append(std::move(slice));
+  startOutput();
+}
 
-  if (!faultError && remaining > 0) {
-    const size_t oldLen = outputBuffer_.readableBytes();
-    if (oldLen + remaining >= highWaterMark_ && oldLen < highWaterMark_ &&
-        highWaterMarkCallback_) {
+void TcpConnection::checkHighWaterMark(size_t added) {
+  lastBufferUse_ = loop_->pollReturnTime();
+  const size_t oldLen = queuedOutputBytes();
+  if (oldLen + added >= highWaterMark_ && oldLen < highWaterMark_ &&
+      highWaterMarkCallback_) {
+    const auto weakSelf = weak_from_this();
+    const size_t totalLen = oldLen + added;
+    loop_->queueInLoop([weakSelf, totalLen] {
+      if (const auto self = weakSelf.lock();
+          self && self->highWaterMarkCallback_) {
+        self->highWaterMarkCallback_(self, totalLen);
+      }
+    });
+  }
+}
+
+void TcpConnection::startOutput() {
+  if (uring_ != nullptr) {
+    if (!sendInFlight_ && sendOp_ >= 0) {
+      startSend();
+    }
+  } else if (waitingForPipe()) {
+    return;
+  } else if (deferredFlush_) {
+    // A level-triggered channel that is writing already waits for room.
+    if (!flushQueued_ && (edgeTriggered_ || !channel_->isWriting())) {
+      flushQueued_ = true;
       const auto weakSelf = weak_from_this();
-      const size_t totalLen = oldLen + remaining;
-      loop_->queueInLoop([weakSelf, totalLen] {
-        if (const auto self = weakSelf.lock();
-            self && self->highWaterMarkCallback_) {
-          self->highWaterMarkCallback_(self, totalLen);
+      loop_->queueFlush([weakSelf] {
+        if (const auto self = weakSelf.lock()) {
+          self->flushDeferred();
         }
       });
     }
+  } else if (!channel_->isWriting()) {
+    channel_->enableWriting();
+  }
+}
 
-    outputBuffer_.append(
-        message.subspan(static_cast<size_t>(nwrote), remaining));
-    if (!channel_->isWriting()) {
-      channel_->enableWriting();
+void TcpConnection::flushDeferred() {
+  flushQueued_ = false;
+  if (state_ == StateE::kDisconnected || queuedOutputBytes() == 0 ||
+      waitingForPipe()) {
+    return;
+  }
+  const ssize_t n = writeQueued();
+  if (n > 0) {
+    lastBufferUse_ = loop_->pollReturnTime();
+  } else if (!waitingForPipe() && errno != EWOULDBLOCK) {
+    muduo::logSysErr("TcpConnection::flushDeferred");
+  }
+  if (queuedOutputBytes() == 0) {
+    queueWriteComplete();
+    if (state_ == StateE::kDisconnecting) {
+      shutdownInLoop();
     }
+  } else if (!channel_->isWriting() && !waitingForPipe()) {
+    channel_->enableWriting();
+  }
+}
+
+void TcpConnection::queueWriteComplete() {
+  if (!writeCompleteCallback_) {
+    return;
+  }
+  const auto weakSelf = weak_from_this();
+  loop_->queueInLoop([weakSelf] {
+    if (const auto self = weakSelf.lock();
+        self && self->writeCompleteCallback_) {
+      self->writeCompleteCallback_(self);
+    }
+  });
+}
+
+bool TcpConnection::outputPending() const {
+  // An edge-triggered channel keeps EPOLLOUT armed even when idle, and a
+  // transfer waiting for its pipe keeps it disarmed.
+  return queuedOutputBytes() > 0 ||
+         (!edgeTriggered_ && channel_->isWriting());
+}
+
+size_t TcpConnection::bufferCapacity() const {
+  return inputBuffer_.internalCapacity() + outputBuffer_.internalCapacity() +
+         outputSegments_.internalCapacity() +
+         (sendingBuffer_ ? sendingBuffer_->internalCapacity() : 0);
+}
+
+size_t TcpConnection::queuedOutputBytes() const {
+  size_t bytes = outputBuffer_.readableBytes() +
+                 outputSegments_.readableBytes() +
+                 (sendInFlight_ ? sendingBuffer_->readableBytes() : 0);
+  for (const auto &transfer : fileTransfers_) {
+    bytes += transfer.remaining;
   }
+  return bytes;
 }
 
 void TcpConnection::shutdown() {
@@ -203,7 +818,10 @@ void TcpConnection::shutdown() {
 
 void TcpConnection::shutdownInLoop() {
   loop_->assertInLoopThread();
-  if (!channel_->isWriting()) {
+  // Sends from other threads still queued count as output; the drain
+  // comes back here once it has sent them.
+  if (!outputPending() && !sendInFlight_ &&
+      pendingSends_.load(std::memory_order_acquire) == nullptr) {
     socket_->shutdownWrite();
   }
 }
@@ -256,6 +874,27 @@ void TcpConnection::startRead() {
 
 void TcpConnection::startReadInLoop() {
   loop_->assertInLoopThread();
+  if (recvOp_ >= 0) {
+    reading_ = true;
+    if (!recvArmed_) {
+      armRecv();
+    }
+    if (recvPending_) {
+      // Bytes that completed while reading was stopped.
+      const auto weakSelf = weak_from_this();
+      loop_->queueInLoop([weakSelf] {
+        if (const auto self = weakSelf.lock();
+            self && self->reading_ && self->recvPending_) {
+          self->recvPending_ = false;
+          if (self->messageCallback_) {
+            self->messageCallback_(self, &self->inputBuffer_,
+                                   self->loop_->pollReturnTime());
+          }
+        }
+      });
+    }
+    return;
+  }
   if (!reading_ || !channel_->isReading()) {
     channel_->enableReading();
     reading_ = true;
@@ -273,6 +912,11 @@ void TcpConnection::stopRead() {
 
 void TcpConnection::stopReadInLoop() {
   loop_->assertInLoopThread();
+  if (recvOp_ >= 0) {
+    reading_ = false;
+    uring_->cancelOperation(recvOp_);
+    return;
+  }
   if (reading_ || channel_->isReading()) {
     channel_->disableReading();
     reading_ = false;
@@ -284,8 +928,53 @@ void TcpConnection::connectEstablished() {
   assert(state_ == StateE::kConnecting);
   setState(StateE::kConnected);
   channel_->tie(shared_from_this());
-  channel_->enableReading();
   reading_ = true;
+  if (const auto busyPoll = loop_->socketBusyPoll();
+      busyPoll > std::chrono::microseconds::zero()) {
+    socket_->setBusyPoll(busyPoll);
+  }
+  if (ioUringCompletionRequested_) {
+    if (auto *uring = loop_->ioUringPoller();
+        uring != nullptr && uring->supportsCompletionIo()) {
+      startCompletionIo();
+    } else {
+      muduo::logWarn("TcpConnection::connectEstablished [{}] - io_uring "
+                     "completion I/O unavailable, using readiness",
+                     name_);
+    }
+  }
+  if (uring_ == nullptr) {
+    deferredFlush_ = deferredFlushRequested_;
+    if (zeroCopyThresholdRequested_ > 0 && socket_->setZeroCopy(true)) {
+      zeroCopyThreshold_ = zeroCopyThresholdRequested_;
+    }
+    segmentedOutput_ = segmentedOutputRequested_;
+    if (segmentedOutput_) {
+      outputSegments_.setPool(loop_->bufferPool());
+    }
+    if (edgeTriggeredRequested_) {
+      if (loop_->supportsEdgeTriggered()) {
+        edgeTriggered_ = true;
+        channel_->setEdgeTriggered(true);
+        channel_->enableWriting();
+      } else {
+        muduo::logWarn("TcpConnection::connectEstablished [{}] - poller is "
+                       "level triggered only",
+                       name_);
+      }
+    }
+    channel_->enableReading();
+  }
+  if (bufferIdleTimeout_ > std::chrono::microseconds::zero()) {
+    lastBufferUse_ = loop_->pollReturnTime();
+    const auto weakSelf = weak_from_this();
+    idleWatch_ = loop_->bufferPool()->watchIdle(
+        bufferIdleTimeout_, BufferPool::IdleCheck([weakSelf] {
+          if (const auto self = weakSelf.lock()) {
+            self->checkBufferIdle();
+          }
+        }));
+  }
 
   if (connectionCallback_) {
     connectionCallback_(shared_from_this());
@@ -302,14 +991,37 @@ void TcpConnection::connectDestroyed() {
       connectionCallback_(shared_from_this());
     }
   }
+  stopCompletionIo();
   channel_->remove();
+  if (idleWatch_) {
+    loop_->bufferPool()->unwatchIdle(*std::exchange(idleWatch_, std::nullopt));
+  }
+  setBufferIdle(false);
+  // Pool slabs go back while still in the loop thread; the connection itself
+  // may be destroyed elsewhere.
+  outputSegments_.retrieveAll();
+  outputSegments_.setPool(nullptr);
+  // Messages that never made it out; their callbacks may hold resources.
+  pendingMessages_.clear();
+  releasePipeChannel();
+  fileTransfers_.clear();
+  // The kernel keeps its own page references; the payloads can go.
+  zeroCopyPinned_.clear();
+  if (std::exchange(countedInLoad_, false)) {
+    loop_->addConnectionLoad(-1);
+  }
 }
 
 void TcpConnection::handleRead(Timestamp receiveTime) {
   loop_->assertInLoopThread();
+  if (edgeTriggered_) {
+    handleReadEdgeTriggered(receiveTime);
+    return;
+  }
   int savedErrno = 0;
   const ssize_t n = inputBuffer_.readFd(channel_->fd(), &savedErrno);
   if (n > 0) {
+    lastBufferUse_ = receiveTime;
     if (messageCallback_) {
       messageCallback_(shared_from_this(), &inputBuffer_, receiveTime);
     }
@@ -322,6 +1034,42 @@ void TcpConnection::handleRead(Timestamp receiveTime) {
   }
 }
 
+void TcpConnection::handleReadEdgeTriggered(Timestamp receiveTime) {
+  // No further edge comes until the socket has been drained, so stopping
+  // early on a short read is not safe: a FIN may be waiting behind the data.
+  for (int i = 0; i < kMaxEdgeTriggeredReads; ++i) {
+    if (!reading_ ||
+        (state_ != StateE::kConnected && state_ != StateE::kDisconnecting)) {
+      return;
+    }
+    int savedErrno = 0;
+    const ssize_t n = inputBuffer_.readFd(channel_->fd(), &savedErrno);
+    if (n > 0) {
+      lastBufferUse_ = receiveTime;
+      if (messageCallback_) {
+        messageCallback_(shared_from_this(), &inputBuffer_, receiveTime);
+      }
+    } else if (n == 0) {
+      handleClose();
+      return;
+    } else if (savedErrno == EAGAIN || savedErrno == EWOULDBLOCK) {
+      return;
+    } else if (savedErrno != EINTR) {
+      errno = savedErrno;
+      muduo::logSysErr("TcpConnection::handleRead");
+      handleError();
+      return;
+    }
+  }
+
+  const auto weakSelf = weak_from_this();
+  loop_->queueInLoop([weakSelf] {
+    if (const auto self = weakSelf.lock()) {
+      self->handleReadEdgeTriggered(self->loop_->pollReturnTime());
+    }
+  });
+}
+
 void TcpConnection::handleWrite() {
   loop_->assertInLoopThread();
   if (!channel_->isWriting()) {
@@ -330,30 +1078,123 @@ void TcpConnection::handleWrite() {
     return;
   }
 
-  const ssize_t n =
-      sockets::write(channel_->fd(), outputBuffer_.readableSpan());
+  if (edgeTriggered_ && queuedOutputBytes() == 0) {
+    return;
+  }
+
+  const ssize_t n = writeQueued();
   if (n > 0) {
-    outputBuffer_.retrieve(static_cast<size_t>(n));
-    if (outputBuffer_.readableBytes() == 0) {
-      channel_->disableWriting();
-      if (writeCompleteCallback_) {
-        const auto weakSelf = weak_from_this();
-        loop_->queueInLoop([weakSelf] {
-          if (const auto self = weakSelf.lock();
-              self && self->writeCompleteCallback_) {
-            self->writeCompleteCallback_(self);
-          }
-        });
+    lastBufferUse_ = loop_->pollReturnTime();
+    if (queuedOutputBytes() == 0) {
+      if (!edgeTriggered_) {
+        channel_->disableWriting();
       }
+      queueWriteComplete();
       if (state_ == StateE::kDisconnecting) {
         shutdownInLoop();
       }
     }
-  } else {
+  } else if (!waitingForPipe() && (!edgeTriggered_ || errno != EWOULDBLOCK)) {
     muduo::logSysErr("TcpConnection::handleWrite");
   }
 }
 
+ssize_t TcpConnection::writeQueued() {
+  // outputBuffer_ goes first: bytes only queue there while no slice does.
+  // A file transfer goes once the bytes queued before it are written.
+  ssize_t total = 0;
+  while (queuedOutputBytes() > 0) {
+    size_t limit = std::numeric_limits<size_t>::max();
+    if (!fileTransfers_.empty()) {
+      auto &transfer = fileTransfers_.front();
+      // Partly sent once bytesWritten_ is past start.
+      if (bytesWritten_ >= transfer.start) {
+        const ssize_t n = writeFile(transfer);
+        if (n > 0) {
+          total += n;
+        }
+        if (transfer.remaining > 0) {
+          return total > 0 ? total : n;
+        }
+        if (transfer.pipe) {
+          releasePipeChannel();
+        }
+        fileTransfers_.pop_front();
+        continue;
+      }
+      limit = static_cast<size_t>(transfer.start - bytesWritten_);
+    }
+
+    std::array<iovec, kMaxIovecs> iov{};
+    size_t count = 0;
+    size_t requested = 0;
+    // A large enough slice at the front goes out on its own, zero-copy.
+    ByteSlice front;
+    if (zeroCopyThreshold_ > 0 && outputBuffer_.readableBytes() == 0) {
+      front = outputSegments_.frontSlice();
+      if (front.size() > limit) {
+        front = front.subslice(0, limit);
+      }
+      if (!zeroCopyEligible(front.size())) {
+        front = ByteSlice();
+      }
+    }
+    if (!front.empty()) {
+      iov[0].iov_base = const_cast<std::byte *>(front.data());
+      iov[0].iov_len = front.size();
+      count = 1;
+      requested = front.size();
+    } else {
+      if (const auto pending = outputBuffer_.readableSpan(); !pending.empty()) {
+        iov[0].iov_base = const_cast<std::byte *>(pending.data());
+        iov[0].iov_len = pending.size();
+        count = 1;
+      }
+      count += outputSegments_.readableIovecs(std::span{iov}.subspan(count));
+      for (size_t i = 0; i < count; ++i) {
+        if (iov[i].iov_len >= limit - requested) {
+          iov[i].iov_len = limit - requested;
+          count = i + 1;
+        }
+        requested += iov[i].iov_len;
+      }
+    }
+
+    // More output right behind this write: no partial segment yet.
+    const size_t buffered =
+        outputBuffer_.readableBytes() + outputSegments_.readableBytes();
+    const bool more =
+        corkedWrites_ &&
+        (requested < std::min(buffered, limit) ||
+         (requested == limit && !fileTransfers_.empty() &&
+          !fileTransfers_.front().pipe));
+    const auto vec = std::span<const iovec>{iov}.first(count);
+    ssize_t n = 0;
+    if (!front.empty()) {
+      n = writeZeroCopy({&front, 1}, vec);
+    } else if (more) {
+      n = sockets::sendmsg(channel_->fd(), vec, MSG_MORE);
+    } else {
+      n = sockets::writev(channel_->fd(), vec);
+    }
+    if (n <= 0) {
+      return total > 0 ? total : n;
+    }
+    const auto written = static_cast<size_t>(n);
+    const size_t fromBuffer = std::min(written, outputBuffer_.readableBytes());
+    outputBuffer_.retrieve(fromBuffer);
+    outputSegments_.retrieve(written - fromBuffer);
+    noteWritten(written);
+    total += n;
+    // An edge-triggered socket reports no new edge while it stays writable,
+    // so keep going until the kernel takes less than offered.
+    if (written < requested) {
+      break;
+    }
+  }
+  return total;
+}
+
 void TcpConnection::handleClose() {
   loop_->assertInLoopThread();
   muduo::logTrace("TcpConnection fd = {} state = {}", channel_->fd(),
@@ -362,6 +1203,10 @@ void TcpConnection::handleClose() {
 
   setState(StateE::kDisconnected);
   channel_->disableAll();
+  if (pipeChannel_ && !pipeChannel_->isNoneEvent()) {
+    pipeChannel_->disableAll();
+  }
+  stopCompletionIo();
 
   TcpConnectionPtr guardThis(shared_from_this());
   if (connectionCallback_) {
@@ -372,8 +1217,196 @@ void TcpConnection::handleClose() {
   }
 }
 
+void TcpConnection::startCompletionIo() {
+  uring_ = loop_->ioUringPoller();
+  const auto weakSelf = weak_from_this();
+  recvOp_ = uring_->addOperation(IoUringPoller::CompletionCallback(
+      [weakSelf](const IoUringPoller::Completion &completion) {
+        if (const auto self = weakSelf.lock()) {
+          self->handleRecvCompletion(completion.res, completion.data,
+                                     completion.more, completion.lastInBatch);
+        }
+      }));
+  sendOp_ = uring_->addOperation(IoUringPoller::CompletionCallback(
+      [weakSelf](const IoUringPoller::Completion &completion) {
+        if (const auto self = weakSelf.lock()) {
+          self->handleSendCompletion(completion.res);
+        }
+      }));
+  // Owned jointly with the poller, which keeps it alive while a send is in
+  // flight even if this connection goes away.
+  sendingBuffer_ = std::make_shared<Buffer>(0);
+  armRecv();
+}
+
+void TcpConnection::stopCompletionIo() {
+  if (recvOp_ >= 0) {
+    uring_->removeOperation(recvOp_);
+    recvOp_ = -1;
+  }
+  if (sendOp_ >= 0) {
+    uring_->removeOperation(sendOp_);
+    sendOp_ = -1;
+  }
+  recvArmed_ = false;
+  sendInFlight_ = false;
+}
+
+void TcpConnection::armRecv() {
+  uring_->submitRecvMultishot(recvOp_, channel_->fd());
+  recvArmed_ = true;
+}
+
+void TcpConnection::startSend() {
+  assert(!sendInFlight_);
+  if (sendingBuffer_->readableBytes() == 0) {
+    sendingBuffer_->swap(outputBuffer_);
+  }
+  uring_->submitSend(sendOp_, channel_->fd(), sendingBuffer_->readableSpan(),
+                     sendingBuffer_);
+  sendInFlight_ = true;
+}
+
+void TcpConnection::handleRecvCompletion(int res,
+                                         std::span<const std::byte> data,
+                                         bool more, bool lastInBatch) {
+  loop_->assertInLoopThread();
+  if (!more) {
+    recvArmed_ = false;
+  }
+
+  // Buffers of one batch are gathered before the callback, so a burst split
+  // across several provided buffers is still delivered in one piece.
+  if (res > 0) {
+    inputBuffer_.append(data);
+    recvPending_ = true;
+    lastBufferUse_ = loop_->pollReturnTime();
+  }
+  if (recvPending_ && (lastInBatch || res <= 0) && reading_) {
+    recvPending_ = false;
+    if (messageCallback_) {
+      messageCallback_(shared_from_this(), &inputBuffer_,
+                       loop_->pollReturnTime());
+    }
+    if (recvOp_ < 0) {
+      // Closed from within the callback.
+      return;
+    }
+  }
+
+  if (res == 0) {
+    handleClose();
+    return;
+  }
+  if (res == -EINVAL) {
+    // Kernels before 6.0 reject multishot recv; keep reading by readiness.
+    muduo::logWarn("TcpConnection::handleRead [{}] - multishot recv "
+                   "unsupported, falling back to readiness",
+                   name_);
+    uring_->removeOperation(recvOp_);
+    recvOp_ = -1;
+    if (reading_) {
+      channel_->enableReading();
+    }
+    return;
+  }
+  if (res < 0 && res != -ECANCELED && res != -ENOBUFS) {
+    errno = -res;
+    muduo::logSysErr("TcpConnection::handleRead");
+    handleError();
+    handleClose();
+    return;
+  }
+
+  // A multishot recv also ends when the buffer ring runs dry (-ENOBUFS) or
+  // after stopRead() cancelled it; re-arm if reading is still wanted.
+  if (!recvArmed_ && reading_ &&
+      (state_ == StateE::kConnected || state_ == StateE::kDisconnecting)) {
+    armRecv();
+  }
+}
+
+void TcpConnection::handleSendCompletion(int res) {
+  loop_->assertInLoopThread();
+  sendInFlight_ = false;
+  if (res == -ECANCELED) {
+    return;
+  }
+  if (res < 0) {
+    errno = -res;
+    muduo::logSysErr("TcpConnection::handleWrite");
+    // The recv side may have closed the connection first.
+    if (state_ == StateE::kConnected || state_ == StateE::kDisconnecting) {
+      handleError();
+      handleClose();
+    }
+    return;
+  }
+
+  sendingBuffer_->retrieve(static_cast<size_t>(res));
+  noteWritten(static_cast<size_t>(res));
+  if (sendingBuffer_->readableBytes() > 0 ||
+      outputBuffer_.readableBytes() > 0) {
+    startSend();
+    return;
+  }
+  queueWriteComplete();
+  if (state_ == StateE::kDisconnecting) {
+    shutdownInLoop();
+  }
+}
+
+void TcpConnection::checkBufferIdle() {
+  loop_->assertInLoopThread();
+  if (state_ != StateE::kConnected && state_ != StateE::kDisconnecting) {
+    return;
+  }
+  const auto unused = std::chrono::microseconds{
+      loop_->pollReturnTime().microSecondsSinceEpoch() -
+      lastBufferUse_.microSecondsSinceEpoch()};
+  const bool idle = inputBuffer_.readableBytes() == 0 &&
+                    queuedOutputBytes() == 0 && !sendInFlight_ &&
+                    unused >= bufferIdleTimeout_;
+  if (idle && !bufferIdle_) {
+    releaseStorage(inputBuffer_);
+    releaseStorage(outputBuffer_);
+    if (sendingBuffer_) {
+      releaseStorage(*sendingBuffer_);
+    }
+    outputSegments_.shrink();
+  }
+  setBufferIdle(idle);
+}
+
+void TcpConnection::releaseStorage(Buffer &buffer) {
+  // Only the prepend area is kept; the next read or send grows it again.
+  if (buffer.readableBytes() == 0 &&
+      buffer.internalCapacity() > Buffer::kCheapPrepend) {
+    Buffer empty(0);
+    buffer.swap(empty);
+  }
+}
+
+void TcpConnection::setBufferIdle(bool idle) {
+  const size_t bytes = idle ? bufferCapacity() : 0;
+  if (idle != bufferIdle_ || bytes != idleBytesReported_) {
+    loop_->bufferPool()->addIdle(
+        static_cast<std::int64_t>(idle) - static_cast<std::int64_t>(bufferIdle_),
+        static_cast<std::int64_t>(bytes) -
+            static_cast<std::int64_t>(idleBytesReported_));
+    bufferIdle_ = idle;
+    idleBytesReported_ = bytes;
+  }
+}
+
 void TcpConnection::handleError() {
+  // The error queue's zero-copy notifications raise POLLERR as well.
+  const bool completions =
+      zeroCopyThreshold_ > 0 && handleZeroCopyCompletions();
   const int err = sockets::getSocketError(channel_->fd());
+  if (completions && err == 0) {
+    return;
+  }
   muduo::logError("TcpConnection::handleError [{}] - SO_ERROR = {} {}", name_,
                   err, strerror_tl(err));
 }
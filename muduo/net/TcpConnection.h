@@ -2,18 +2,27 @@
 
 #include "muduo/base/noncopyable.h"
 #include "muduo/net/Buffer.h"
+#include "muduo/net/ByteSlice.h"
 #include "muduo/net/Callbacks.h"
 #include "muduo/net/InetAddress.h"
+#include "muduo/net/SegmentedBuffer.h"
 #if MUDUO_ENABLE_LEGACY_COMPAT
 #include "muduo/base/StringPiece.h"
 #endif
 
 #include <any>
+#include <atomic>
 #include <chrono>
 #include <concepts>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <optional>
 #include <span>
 #include <string_view>
+#include <sys/types.h>
+#include <utility>
+#include <vector>
 
 struct tcp_info;
 
@@ -21,6 +30,7 @@ namespace muduo::net {
 
 class Channel;
 class EventLoop;
+class IoUringPoller;
 class Socket;
 
 class TcpConnection : muduo::noncopyable,
@@ -48,13 +58,43 @@ public:
   void send(const char *message);
 #endif
   void send(const string &message);
+  // The rvalue overloads take ownership: whatever the socket does not take
+  // right away is queued by reference, never copied. A Buffer is left
+  // empty. On the io_uring completion path the rest is still copied.
   void send(string &&message);
+  void send(std::vector<std::byte> &&message);
+  void send(Buffer &&message);
+  // Shares the slice's storage until it has been written, so one slice can
+  // go to any number of connections, on any loops, without a copy each.
+  void send(ByteSlice message);
+  // Sends parts as one message, gather-written with writev() instead of
+  // being joined first; the socket's leftover is queued by reference like
+  // send(ByteSlice). onWritten, if set, runs once the whole message has been
+  // written, next to the connection's WriteCompleteCallback, which still
+  // waits for all output.
+  void sendv(std::span<const ByteSlice> parts,
+             WriteCompleteCallback onWritten = {});
+  template <typename F>
+    requires CallbackBindable<F, WriteCompleteCallback>
+  void sendv(std::span<const ByteSlice> parts, F &&onWritten) {
+    sendv(parts, WriteCompleteCallback(std::forward<F>(onWritten)));
+  }
 #if MUDUO_ENABLE_LEGACY_COMPAT
   void send(StringPiece message);
 #endif
   void send(std::string_view message);
   void send(std::span<const std::byte> message);
   void send(Buffer *message);
+  // Sends length bytes of the file fd from offset with sendfile(2), queued
+  // in order with the other output and counted against the high-water mark
+  // like it. fd is duplicated, so the caller may close it right away. If
+  // the file ends early the connection is closed. Not available with
+  // io_uring completion I/O.
+  void sendFile(int fd, off_t offset, size_t length);
+  // Like sendFile() for the read end of a pipe, moved with splice(2); waits
+  // for the pipe whenever it runs dry. Not available with io_uring
+  // completion I/O.
+  void sendPipe(int pipeFd, size_t length);
 
   void shutdown();
   void forceClose();
@@ -73,6 +113,79 @@ public:
   void stopRead();
   [[nodiscard]] bool isReading() const { return reading_; }
 
+  // Drives reads and writes by io_uring recv/send completions instead of
+  // readiness. Takes effect in connectEstablished(), and only if the loop
+  // runs the io_uring backend with provided-buffer ring support.
+  void setIoUringCompletion(bool on) { ioUringCompletionRequested_ = on; }
+  [[nodiscard]] bool ioUringCompletion() const { return uring_ != nullptr; }
+
+  // Registers the socket edge triggered: reads drain until EAGAIN and
+  // EPOLLOUT stays armed for the connection's lifetime, so sending never
+  // toggles interest. Takes effect in connectEstablished(), and only if the
+  // loop's poller supports it; io_uring completion I/O takes precedence.
+  void setEdgeTriggered(bool on) { edgeTriggeredRequested_ = on; }
+  [[nodiscard]] bool edgeTriggered() const { return edgeTriggered_; }
+
+  // Queues unsent output in a SegmentedBuffer drawing on the loop's
+  // BufferPool, so a large backlog grows by whole slabs instead of
+  // reallocating, is written with writev(), and goes back to the pool once
+  // sent. outputBuffer() then stays unused. Takes effect in
+  // connectEstablished(); io_uring completion I/O keeps its contiguous send
+  // buffer.
+  void setSegmentedOutput(bool on) { segmentedOutputRequested_ = on; }
+  [[nodiscard]] bool segmentedOutput() const { return segmentedOutput_; }
+
+  // Sends in the loop thread only queue their output and mark the
+  // connection dirty; it is written in one gather write once the
+  // iteration's pending functors have run (EventLoop::queueFlush). A reply
+  // built from several send() calls then costs one syscall and fewer
+  // segments, for at most an iteration's delay. Takes effect in
+  // connectEstablished(), and not with io_uring completion I/O.
+  void setDeferredFlush(bool on) { deferredFlushRequested_ = on; }
+  [[nodiscard]] bool deferredFlush() const { return deferredFlush_; }
+  // Writes that leave output queued behind them (more than IOV_MAX
+  // pieces, bytes ahead of a sendFile()) carry MSG_MORE, so the kernel
+  // holds back a partial segment until the rest follows, as TCP_CORK
+  // would without the two setsockopt() calls. Call before
+  // connectEstablished().
+  void setCorkedWrites(bool on) { corkedWrites_ = on; }
+
+  // Once the connection's buffers have stayed empty for timeout, frees
+  // their storage (segmented output holds nothing by then) and counts the
+  // connection, with what it still holds, as idle in BufferPool::stats()
+  // until it buffers data again. Checked by the loop's BufferPool sweep,
+  // one timer for all connections. Zero (the default) disables it. Call
+  // before connectEstablished().
+  void setBufferIdleTimeout(std::chrono::microseconds timeout) {
+    bufferIdleTimeout_ = timeout;
+  }
+
+  // Sends owned payloads of at least threshold bytes with MSG_ZEROCOPY: the
+  // kernel reads them from their own storage instead of copying them into
+  // the socket. That storage stays pinned until the kernel reports the send
+  // done, and only then is the slice released, so a ByteSlice owner's
+  // deleter serves as a per-message release callback. Applies to
+  // send(ByteSlice), the rvalue overloads and sendv(); copying costs less
+  // for small sends. Zero (the default) disables it. Takes effect in
+  // connectEstablished() if the socket supports SO_ZEROCOPY, and not with
+  // io_uring completion I/O.
+  void setZeroCopyThreshold(size_t threshold) {
+    zeroCopyThresholdRequested_ = threshold;
+  }
+  [[nodiscard]] size_t zeroCopyThreshold() const { return zeroCopyThreshold_; }
+  struct ZeroCopyStats {
+    // MSG_ZEROCOPY sends the kernel accepted.
+    uint64_t sends{0};
+    // Of those, the ones it copied after all, as it does over loopback.
+    uint64_t copied{0};
+    // Payload slices still pinned.
+    size_t pinned{0};
+  };
+  // Loop thread only.
+  [[nodiscard]] ZeroCopyStats zeroCopyStats() const;
+  // Capacity of all buffers of this connection. Loop thread only.
+  [[nodiscard]] size_t bufferCapacity() const;
+
   void setContext(std::any context) { context_ = std::move(context); }
   [[nodiscard]] const std::any &getContext() const { return context_; }
   [[nodiscard]] std::any *getMutableContext() { return &context_; }
@@ -138,14 +251,77 @@ private:
   };
 
   void handleRead(Timestamp receiveTime);
+  void handleReadEdgeTriggered(Timestamp receiveTime);
   void handleWrite();
   void handleClose();
   void handleError();
   void sendInLoop(std::span<const std::byte> message);
+  void sendInLoop(ByteSlice message);
+  void sendvInLoop(std::span<const ByteSlice> parts,
+                   WriteCompleteCallback onWritten);
+  struct PendingSend;
+  // Queues an off-loop send; the first one after a drain schedules the next.
+  void queuePendingSend(std::unique_ptr<PendingSend> send);
+  // Sends everything queued by other threads since the last drain, in
+  // order; consecutive plain sends go out as one gather write.
+  void drainPendingSends();
+  void flushDrainBatch();
+  struct FileTransfer;
+  void sendTransfer(int fd, off_t offset, size_t length, bool pipe);
+  void sendFileInLoop(FileTransfer transfer);
+  // Moves the transfer's bytes to the socket until it is done or either side
+  // would block; returns the bytes moved, or -1 with errno set if none were.
+  [[nodiscard]] ssize_t writeFile(FileTransfer &transfer);
+  void waitForPipe(int pipeFd);
+  void handlePipeReadable();
+  [[nodiscard]] bool waitingForPipe() const;
+  void releasePipeChannel();
+  template <typename T> void sendOwned(T &&message);
+  template <typename T> void sendOwnedInLoop(T &&message);
+  // Writes what the socket takes right away if nothing is queued; nullopt
+  // if the message is to be dropped.
+  [[nodiscard]] std::optional<size_t>
+  writeNow(std::span<const std::byte> message,
+           const ByteSlice *owner = nullptr);
+  void queueSlice(ByteSlice slice);
+  void checkHighWaterMark(size_t added);
+  void startOutput();
+  void flushDeferred();
+  // Gather-writes outputBuffer_ and outputSegments_, and sends each file
+  // transfer once the bytes queued before it are out.
+  [[nodiscard]] ssize_t writeQueued();
+  // writev() of parts, IOV_MAX at a time, until the socket takes less.
+  [[nodiscard]] ssize_t writeParts(std::span<const ByteSlice> parts);
+  // Accounts for bytes written to the socket; completes sendv() messages.
+  void noteWritten(size_t len);
+  [[nodiscard]] bool zeroCopyEligible(size_t len) const {
+    return zeroCopyThreshold_ > 0 && len >= zeroCopyThreshold_;
+  }
+  // MSG_ZEROCOPY sendmsg() of iov, which covers parts, pinning what the
+  // kernel took; a plain writev() if it is out of pinning memory.
+  [[nodiscard]] ssize_t writeZeroCopy(std::span<const ByteSlice> parts,
+                                      std::span<const iovec> iov);
+  // Unpins the payloads of the error queue's zero-copy notifications;
+  // false if there were none.
+  [[nodiscard]] bool handleZeroCopyCompletions();
   void shutdownInLoop();
   void forceCloseInLoop();
   void startReadInLoop();
   void stopReadInLoop();
+  void startCompletionIo();
+  void stopCompletionIo();
+  void armRecv();
+  void startSend();
+  void handleRecvCompletion(int res, std::span<const std::byte> data,
+                            bool more, bool lastInBatch);
+  void handleSendCompletion(int res);
+  void queueWriteComplete();
+  [[nodiscard]] bool outputPending() const;
+  // Accepted by send() but not yet written to the socket.
+  [[nodiscard]] size_t queuedOutputBytes() const;
+  void checkBufferIdle();
+  static void releaseStorage(Buffer &buffer);
+  void setBufferIdle(bool idle);
   void setState(StateE state) { state_ = state; }
   [[nodiscard]] const char *stateToString() const;
 
@@ -153,6 +329,8 @@ private:
   const string name_;
   StateE state_{StateE::kConnecting};
   bool reading_{false};
+  // In loop_->load().connections until connectDestroyed().
+  bool countedInLoad_{true};
   std::unique_ptr<Socket> socket_;
   std::unique_ptr<Channel> channel_;
   const InetAddress localAddr_;
@@ -165,9 +343,87 @@ private:
   HighWaterMarkCallback highWaterMarkCallback_;
   CloseCallback closeCallback_;
   size_t highWaterMark_{64 * 1024 * 1024};
-  Buffer inputBuffer_;
-  Buffer outputBuffer_;
+  // Only the prepend area until the first read or queued send grows them.
+  // Plain vector storage: BufferPool backs segmented output only.
+  Buffer inputBuffer_{0};
+  Buffer outputBuffer_{0};
+  SegmentedBuffer outputSegments_;
+  // sendv() messages waiting for bytesWritten_ to reach end.
+  struct PendingMessage {
+    uint64_t end;
+    WriteCompleteCallback onWritten;
+  };
+  std::deque<PendingMessage> pendingMessages_;
+  // Sends, gather sends and transfers from other threads, newest first:
+  // each push links its node with one CAS, each drain takes the whole list
+  // and frees the nodes as it sends them.
+  std::atomic<PendingSend *> pendingSends_{nullptr};
+  std::atomic<bool> drainQueued_{false};
+  // Reused by each drain.
+  std::vector<ByteSlice> drainBatch_;
+  // A sendFile() or sendPipe() range; owns its duplicate of the fd.
+  struct FileTransfer {
+    FileTransfer(int fdArg, off_t offsetArg, size_t length, bool pipeArg)
+        : fd(fdArg), offset(offsetArg), remaining(length), pipe(pipeArg) {}
+    FileTransfer(FileTransfer &&rhs) noexcept
+        : fd(std::exchange(rhs.fd, -1)), offset(rhs.offset),
+          remaining(rhs.remaining), pipe(rhs.pipe), start(rhs.start) {}
+    FileTransfer &operator=(FileTransfer &&) = delete;
+    ~FileTransfer();
+
+    int fd;
+    off_t offset;
+    size_t remaining;
+    bool pipe;
+    // Position of the first byte in the output stream, as bytesAccepted_.
+    uint64_t start{0};
+  };
+  std::deque<FileTransfer> fileTransfers_;
+  // Watches the front transfer's pipe while it is empty.
+  std::unique_ptr<Channel> pipeChannel_;
+
+  size_t zeroCopyThresholdRequested_{0};
+  size_t zeroCopyThreshold_{0};
+  // Payloads of MSG_ZEROCOPY sends, in id order; several slices can share
+  // one id, and completed ones wait for those before them.
+  struct PinnedSend {
+    uint32_t id;
+    ByteSlice slice;
+    bool done{false};
+  };
+  std::deque<PinnedSend> zeroCopyPinned_;
+  uint32_t zeroCopyNextId_{0};
+  ZeroCopyStats zeroCopyStats_;
+  // Output bytes accepted by send() and written to the socket so far.
+  uint64_t bytesAccepted_{0};
+  uint64_t bytesWritten_{0};
   std::any context_;
+
+  bool edgeTriggeredRequested_{false};
+  bool edgeTriggered_{false};
+  bool segmentedOutputRequested_{false};
+  bool segmentedOutput_{false};
+  bool deferredFlushRequested_{false};
+  bool deferredFlush_{false};
+  bool flushQueued_{false};
+  bool corkedWrites_{false};
+  std::chrono::microseconds bufferIdleTimeout_{0};
+  // Handle of checkBufferIdle() in the loop's BufferPool sweep.
+  std::optional<size_t> idleWatch_;
+  // Last time a buffer held data, at poll granularity.
+  Timestamp lastBufferUse_;
+  bool bufferIdle_{false};
+  // What this connection adds to BufferPool's idle bytes.
+  size_t idleBytesReported_{0};
+  bool ioUringCompletionRequested_{false};
+  IoUringPoller *uring_{nullptr};
+  int recvOp_{-1};
+  int sendOp_{-1};
+  bool recvArmed_{false};
+  bool recvPending_{false};
+  bool sendInFlight_{false};
+  // Bytes handed to an io_uring send; outputBuffer_ queues behind them.
+  std::shared_ptr<Buffer> sendingBuffer_;
 };
 
 } // namespace muduo::net
@@ -6,7 +6,9 @@
 #include "muduo/net/EventLoopThreadPool.h"
 #include "muduo/net/SocketsOps.h"
 
+#include <algorithm>
 #include <format>
+#include <latch>
 #include <utility>
 
 namespace muduo::net {
@@ -31,10 +33,11 @@ TcpServer::TcpServer(EventLoop *loop, const InetAddress &listenAddr,
       connectionCallback_(std::make_shared<ConnectionCallback>(
           ConnectionCallback(defaultConnectionCallback))),
       messageCallback_(std::make_shared<MessageCallback>(
-          MessageCallback(defaultMessageCallback))) {
-  acceptor_->setNewConnectionCallback(
-      [this](int sockfd, const InetAddress &peerAddr) {
-        newConnection(sockfd, peerAddr);
+          MessageCallback(defaultMessageCallback))),
+      reusePort_(option == Option::kReusePort) {
+  acceptor_->setNewConnectionBatchCallback(
+      [this](std::span<const Acceptor::Accepted> accepted) {
+        newConnections(accepted);
       });
 }
 
@@ -42,6 +45,22 @@ TcpServer::~TcpServer() {
   loop_->assertInLoopThread();
   muduo::logTrace("TcpServer::~TcpServer [{}] destructing", name_);
 
+  // Each shard stops accepting and destroys its connections in its own
+  // loop; they call back into this server, so it waits for all of them.
+  if (!shards_.empty()) {
+    std::latch stopped(static_cast<std::ptrdiff_t>(shards_.size()));
+    for (auto &shard : shards_) {
+      shard.loop->runInLoop([&shard, &stopped] {
+        shard.acceptor.reset();
+        for (auto &[_, conn] : std::exchange(shard.connections, {})) {
+          conn->connectDestroyed();
+        }
+        stopped.count_down();
+      });
+    }
+    stopped.wait();
+  }
+
   for (auto &[_, conn] : connections_) {
     TcpConnectionPtr guard(conn);
     conn.reset();
@@ -54,21 +73,126 @@ void TcpServer::setThreadNum(int numThreads) {
   threadPool_->setThreadNum(numThreads);
 }
 
+void TcpServer::setThreadNum(int numThreads,
+                             std::vector<std::vector<int>> cpuSets) {
+  setThreadNum(numThreads);
+  threadPool_->setCpuAffinity(std::move(cpuSets));
+}
+
+void TcpServer::setIoUringCompletion(bool on) {
+  ioUringCompletion_ = on;
+  threadPool_->setPollerBackend(on ? PollerBackend::kIoUring
+                                   : PollerBackend::kDefault);
+}
+
 void TcpServer::start() {
   if (started_.fetch_add(1, std::memory_order_acq_rel) == 0) {
     threadPool_->start(std::move(threadInitCallback_));
     assert(!acceptor_->listening());
-    loop_->runInLoop([this] { acceptor_->listen(); });
+    loop_->runInLoop([this] {
+      if (shardedAccept_) {
+        startShardedAccept();
+        return;
+      }
+      acceptor_->setAcceptBatch(acceptBatch_);
+      acceptor_->listen();
+    });
+  }
+}
+
+void TcpServer::startShardedAccept() {
+  loop_->assertInLoopThread();
+  const std::vector<EventLoop *> ioLoops = threadPool_->getAllLoops();
+  if (!reusePort_ || ioLoops.front() == loop_) {
+    muduo::logWarn("TcpServer::start [{}] - sharded accept needs "
+                   "Option::kReusePort and I/O threads, accepting on the "
+                   "base loop",
+                   name_);
+    acceptor_->setAcceptBatch(acceptBatch_);
+    acceptor_->listen();
+    return;
+  }
+
+  // The shards bind the address acceptor_ holds, port 0 resolved, and join
+  // its reuseport group; it closes without ever listening once they have.
+  // The callbacks hold on to their Shard, so shards_ never grows after this.
+  const InetAddress listenAddr = acceptor_->listenAddress();
+  shards_.reserve(ioLoops.size());
+  for (EventLoop *ioLoop : ioLoops) {
+    Shard &shard = shards_.emplace_back(
+        ioLoop, std::make_unique<Acceptor>(ioLoop, listenAddr, true));
+    shard.acceptor->setNewConnectionBatchCallback(
+        [this, &shard](std::span<const Acceptor::Accepted> accepted) {
+          newShardConnections(shard, accepted);
+        });
+    if (const auto cpus = threadPool_->cpusOf(ioLoop); !cpus.empty()) {
+      shard.acceptor->setIncomingCpu(cpus.front());
+    }
+    ioLoop->runInLoop([acceptor = shard.acceptor.get(), batch = acceptBatch_] {
+      acceptor->setAcceptBatch(batch);
+      acceptor->listen();
+    });
   }
+  acceptor_.reset();
 }
 
-void TcpServer::newConnection(int sockfd, const InetAddress &peerAddr) {
+void TcpServer::newConnections(std::span<const Acceptor::Accepted> accepted) {
   loop_->assertInLoopThread();
-  EventLoop *ioLoop = threadPool_->getNextLoop();
+  if (accepted.size() == 1) {
+    EventLoop *ioLoop = loopForConnection(accepted.front().sockfd);
+    auto conn = createConnection(ioLoop, accepted.front().sockfd,
+                                 accepted.front().peerAddr, nullptr);
+    ioLoop->runInLoop([conn] { conn->connectEstablished(); });
+    return;
+  }
+
+  // One task per I/O loop for its share of the batch.
+  std::vector<std::pair<EventLoop *, std::vector<TcpConnectionPtr>>> byLoop;
+  for (const auto &[sockfd, peerAddr] : accepted) {
+    EventLoop *ioLoop = loopForConnection(sockfd);
+    auto it = std::ranges::find(byLoop, ioLoop,
+                                &decltype(byLoop)::value_type::first);
+    if (it == byLoop.end()) {
+      it = byLoop.emplace(byLoop.end(), ioLoop,
+                          std::vector<TcpConnectionPtr>{});
+    }
+    it->second.push_back(createConnection(ioLoop, sockfd, peerAddr, nullptr));
+  }
+  for (auto &[ioLoop, conns] : byLoop) {
+    ioLoop->runInLoop([conns = std::move(conns)] {
+      for (const auto &conn : conns) {
+        conn->connectEstablished();
+      }
+    });
+  }
+}
+
+EventLoop *TcpServer::loopForConnection(int sockfd) {
+  if (incomingCpuPlacement_) {
+    const int cpu = sockets::getIncomingCpu(sockfd);
+    EventLoop *ioLoop = cpu >= 0 ? threadPool_->getLoopForCpu(cpu) : nullptr;
+    if (ioLoop != nullptr) {
+      return ioLoop;
+    }
+  }
+  return threadPool_->getNextLoop();
+}
+
+void TcpServer::newShardConnections(
+    Shard &shard, std::span<const Acceptor::Accepted> accepted) {
+  shard.loop->assertInLoopThread();
+  for (const auto &[sockfd, peerAddr] : accepted) {
+    createConnection(shard.loop, sockfd, peerAddr, &shard)
+        ->connectEstablished();
+  }
+}
 
-  auto connName =
-      std::format("{}-{}#{}", name_, ipPort_, static_cast<long>(nextConnId_));
-  ++nextConnId_;
+TcpConnectionPtr TcpServer::createConnection(EventLoop *ioLoop, int sockfd,
+                                             const InetAddress &peerAddr,
+                                             Shard *shard) {
+  auto connName = std::format(
+      "{}-{}#{}", name_, ipPort_,
+      static_cast<long>(nextConnId_.fetch_add(1, std::memory_order_relaxed)));
 
   muduo::logInfo("TcpServer::newConnection [{}] - new connection [{}] from {}",
                  name_, connName, peerAddr.toIpPort());
@@ -76,7 +200,13 @@ void TcpServer::newConnection(int sockfd, const InetAddress &peerAddr) {
   InetAddress localAddr(sockets::getLocalAddr(sockfd));
   auto conn = std::make_shared<TcpConnection>(ioLoop, connName, sockfd, localAddr,
                                               peerAddr);
-  connections_[connName] = conn;
+  conn->setIoUringCompletion(ioUringCompletion_);
+  conn->setEdgeTriggered(edgeTriggered_);
+  conn->setSegmentedOutput(segmentedOutput_);
+  conn->setDeferredFlush(deferredFlush_);
+  conn->setCorkedWrites(corkedWrites_);
+  conn->setBufferIdleTimeout(bufferIdleTimeout_);
+  conn->setZeroCopyThreshold(zeroCopyThreshold_);
 
   auto connectionCb = connectionCallback_;
   auto messageCb = messageCallback_;
@@ -91,10 +221,17 @@ void TcpServer::newConnection(int sockfd, const InetAddress &peerAddr) {
   conn->setWriteCompleteCallback([writeCompleteCb](const TcpConnectionPtr &c) {
     invokeCallbackIfSet(writeCompleteCb, c);
   });
-  conn->setCloseCallback(
-      [this](const TcpConnectionPtr &c) { removeConnection(c); });
-
-  ioLoop->runInLoop([conn] { conn->connectEstablished(); });
+  if (shard != nullptr) {
+    shard->connections.emplace(conn.get(), conn);
+    conn->setCloseCallback([this, shard](const TcpConnectionPtr &c) {
+      removeShardConnection(*shard, c);
+    });
+  } else {
+    connections_[conn->name()] = conn;
+    conn->setCloseCallback(
+        [this](const TcpConnectionPtr &c) { removeConnection(c); });
+  }
+  return conn;
 }
 
 void TcpServer::removeConnection(const TcpConnectionPtr &conn) {
@@ -114,4 +251,18 @@ void TcpServer::removeConnectionInLoop(const TcpConnectionPtr &conn) {
   ioLoop->queueInLoop([conn] { conn->connectDestroyed(); });
 }
 
+void TcpServer::removeShardConnection(Shard &shard,
+                                      const TcpConnectionPtr &conn) {
+  shard.loop->assertInLoopThread();
+  muduo::logInfo("TcpServer::removeShardConnection [{}] - connection {}",
+                 name_, conn->name());
+
+  const size_t erased = shard.connections.erase(conn.get());
+  (void)erased;
+  assert(erased == 1);
+
+  // Queued, not called: conn's channel is still handling the close event.
+  shard.loop->queueInLoop([conn] { conn->connectDestroyed(); });
+}
+
 } // namespace muduo::net
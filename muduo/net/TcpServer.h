@@ -1,19 +1,21 @@
 #pragma once
 
 #include "muduo/base/noncopyable.h"
+#include "muduo/net/Acceptor.h"
 #include "muduo/net/Callbacks.h"
 #include "muduo/net/TcpConnection.h"
 
 #include <atomic>
+#include <chrono>
 #include <concepts>
 #include <memory>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace muduo::net {
 
-class Acceptor;
 class EventLoop;
 class EventLoopThreadPool;
 
@@ -31,6 +33,46 @@ public:
   [[nodiscard]] EventLoop *getLoop() const { return loop_; }
 
   void setThreadNum(int numThreads);
+  // Also pins I/O loop i to cpuSets[i % cpuSets.size()] with its memory on
+  // that NUMA node (see EventLoopThreadPool::setCpuAffinity). With sharded
+  // accept, each loop's listening socket takes the connections received on
+  // the first of its CPUs (SO_INCOMING_CPU), and connections are created in
+  // their loop, so they are node-local too.
+  void setThreadNum(int numThreads, std::vector<std::vector<int>> cpuSets);
+  // Connections read and write through io_uring recv/send completions
+  // (see TcpConnection::setIoUringCompletion). Call before start(); the I/O
+  // loops are then created on the io_uring backend. With no I/O threads the
+  // base loop must run it itself.
+  void setIoUringCompletion(bool on);
+  // See TcpConnection::setEdgeTriggered. Call before start().
+  void setEdgeTriggered(bool on) { edgeTriggered_ = on; }
+  // See TcpConnection::setSegmentedOutput. Call before start().
+  void setSegmentedOutput(bool on) { segmentedOutput_ = on; }
+  // See TcpConnection::setDeferredFlush. Call before start().
+  void setDeferredFlush(bool on) { deferredFlush_ = on; }
+  // See TcpConnection::setCorkedWrites. Call before start().
+  void setCorkedWrites(bool on) { corkedWrites_ = on; }
+  // See TcpConnection::setBufferIdleTimeout. Call before start().
+  void setBufferIdleTimeout(std::chrono::microseconds timeout) {
+    bufferIdleTimeout_ = timeout;
+  }
+  // See TcpConnection::setZeroCopyThreshold. Call before start().
+  void setZeroCopyThreshold(size_t threshold) { zeroCopyThreshold_ = threshold; }
+  // Listens with one SO_REUSEPORT socket and Acceptor per I/O loop instead
+  // of one on the base loop: the kernel spreads incoming connections over
+  // them, and each is accepted, established and, once closed, unregistered
+  // and destroyed on the loop that owns it, without a hop through the base
+  // loop. Needs Option::kReusePort and at least one thread. Call before
+  // start().
+  void setShardedAccept(bool on) { shardedAccept_ = on; }
+  // Accepts up to maxAccepts connections per readiness event instead of
+  // one, and hands each I/O loop its share of them in one task. For
+  // reconnect storms. Call before start().
+  void setAcceptBatch(size_t maxAccepts) { acceptBatch_ = maxAccepts; }
+  // Without sharded accept, hands each connection to the loop pinned to
+  // the CPU that received it, if any, instead of the pool's selection, so
+  // it is served where the NIC queue delivers it. Call before start().
+  void setIncomingCpuPlacement(bool on) { incomingCpuPlacement_ = on; }
   void setThreadInitCallback(ThreadInitCallback cb) {
     threadInitCallback_ = std::move(cb);
   }
@@ -67,16 +109,36 @@ public:
   }
 
 private:
-  void newConnection(int sockfd, const InetAddress &peerAddr);
+  using ConnectionMap = std::unordered_map<string, TcpConnectionPtr>;
+  // With sharded accept, an I/O loop's acceptor and the connections it
+  // accepted, only touched in that loop.
+  struct Shard {
+    EventLoop *loop;
+    std::unique_ptr<Acceptor> acceptor;
+    std::unordered_map<const TcpConnection *, TcpConnectionPtr> connections;
+  };
+
+  void startShardedAccept();
+  void newConnections(std::span<const Acceptor::Accepted> accepted);
+  [[nodiscard]] EventLoop *loopForConnection(int sockfd);
+  // Accepted by the shard's own acceptor, in its loop.
+  void newShardConnections(Shard &shard,
+                           std::span<const Acceptor::Accepted> accepted);
+  // Registers the connection in shard, or in connections_ if null.
+  [[nodiscard]] TcpConnectionPtr createConnection(EventLoop *ioLoop,
+                                                  int sockfd,
+                                                  const InetAddress &peerAddr,
+                                                  Shard *shard);
   void removeConnection(const TcpConnectionPtr &conn);
   void removeConnectionInLoop(const TcpConnectionPtr &conn);
-
-  using ConnectionMap = std::unordered_map<string, TcpConnectionPtr>;
+  void removeShardConnection(Shard &shard, const TcpConnectionPtr &conn);
 
   EventLoop *loop_;
   const string ipPort_;
   const string name_;
   std::unique_ptr<Acceptor> acceptor_;
+  // One per I/O loop with setShardedAccept(); sized once, in start().
+  std::vector<Shard> shards_;
   std::shared_ptr<EventLoopThreadPool> threadPool_;
 
   std::shared_ptr<ConnectionCallback> connectionCallback_;
@@ -84,7 +146,19 @@ private:
   std::shared_ptr<WriteCompleteCallback> writeCompleteCallback_;
   ThreadInitCallback threadInitCallback_;
   std::atomic<int> started_{0};
-  int nextConnId_{1};
+  const bool reusePort_;
+  bool shardedAccept_{false};
+  size_t acceptBatch_{1};
+  bool incomingCpuPlacement_{false};
+  bool ioUringCompletion_{false};
+  bool edgeTriggered_{false};
+  bool segmentedOutput_{false};
+  bool deferredFlush_{false};
+  bool corkedWrites_{false};
+  std::chrono::microseconds bufferIdleTimeout_{0};
+  size_t zeroCopyThreshold_{0};
+  std::atomic<int> nextConnId_{1};
+  // Connections accepted by acceptor_; base loop only.
   ConnectionMap connections_;
 };
 
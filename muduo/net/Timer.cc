@@ -1,5 +1,6 @@
 #include "muduo/net/Timer.h"
 
+#include <bit>
 #include <utility>
 
 using namespace muduo::net;
@@ -8,8 +9,23 @@ std::atomic<std::int64_t> Timer::s_numCreated_{0};
 
 void Timer::restart(Timestamp now) {
   if (repeat_) {
-    expiration_ = Timestamp{now.timePoint() + interval_};
+    requested_ = Timestamp{now.timePoint() + interval_};
+    expiration_ = coalesce(requested_, slack_);
   } else {
+    requested_ = Timestamp::invalid();
     expiration_ = Timestamp::invalid();
   }
 }
+
+muduo::Timestamp Timer::coalesce(Timestamp when, std::chrono::microseconds slack) {
+  if (slack <= std::chrono::microseconds::zero()) {
+    return when;
+  }
+  const auto low = static_cast<std::uint64_t>(when.microSecondsSinceEpoch());
+  const auto high = low + static_cast<std::uint64_t>(slack.count());
+  // Clearing the bits below the highest one that differs between low - 1
+  // and high gives the roundest value that is still >= low.
+  const auto roundBits = std::bit_width((low - 1) ^ high) - 1;
+  const std::uint64_t mask = (std::uint64_t{1} << roundBits) - 1;
+  return Timestamp(static_cast<std::int64_t>(high & ~mask));
+}
@@ -13,26 +13,50 @@ namespace muduo::net {
 class Timer : muduo::noncopyable {
 public:
   Timer(TimerCallback cb, Timestamp when, std::chrono::microseconds interval)
-      : callback_(std::move(cb)), expiration_(when), interval_(interval),
+      : callback_(std::move(cb)), requested_(when), expiration_(when),
+        interval_(interval), slack_(0),
         repeat_(interval > std::chrono::microseconds::zero()),
-        sequence_(s_numCreated_.fetch_add(1, std::memory_order_relaxed) + 1) {}
+        sequence_(newSequence()) {}
+  // For a sequence reserved with newSequence() ahead of construction. With
+  // slack, the timer fires at coalesce(when, slack) instead of when.
+  Timer(TimerCallback cb, Timestamp when, std::chrono::microseconds interval,
+        std::int64_t sequence,
+        std::chrono::microseconds slack = std::chrono::microseconds::zero())
+      : callback_(std::move(cb)), requested_(when),
+        expiration_(coalesce(when, slack)), interval_(interval), slack_(slack),
+        repeat_(interval > std::chrono::microseconds::zero()),
+        sequence_(sequence) {}
 
   void run() { callback_(); }
 
+  // When the timer fires; requested() plus at most slack().
   [[nodiscard]] Timestamp expiration() const { return expiration_; }
+  [[nodiscard]] Timestamp requested() const { return requested_; }
+  [[nodiscard]] std::chrono::microseconds slack() const { return slack_; }
   [[nodiscard]] bool repeat() const { return repeat_; }
   [[nodiscard]] std::int64_t sequence() const { return sequence_; }
 
   void restart(Timestamp now);
 
+  // The roundest time in [when, when + slack]: the one with the most
+  // trailing zero bits in microseconds since the epoch. Timers with
+  // overlapping windows tend to pick the same time and share a wakeup.
+  [[nodiscard]] static Timestamp coalesce(Timestamp when,
+                                          std::chrono::microseconds slack);
+
+  [[nodiscard]] static std::int64_t newSequence() {
+    return s_numCreated_.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
   [[nodiscard]] static std::int64_t numCreated() {
     return s_numCreated_.load(std::memory_order_relaxed);
   }
 
 private:
   TimerCallback callback_;
+  Timestamp requested_;
   Timestamp expiration_;
   const std::chrono::microseconds interval_;
+  const std::chrono::microseconds slack_;
   const bool repeat_;
   const std::int64_t sequence_;
 
@@ -4,10 +4,9 @@
 #include "muduo/base/Types.h"
 #include "muduo/net/EventLoop.h"
 #include "muduo/net/Timer.h"
+#include "muduo/net/timer/TimerStore.h"
 
 #include <algorithm>
-#include <iterator>
-#include <limits>
 #include <ranges>
 #include <sys/timerfd.h>
 #include <unistd.h>
@@ -56,14 +55,26 @@ void resetTimerfd(int timerfd, Timestamp expiration) {
   }
 }
 
+void disarmTimerfd(int timerfd) {
+  const itimerspec newValue{};
+  if (::timerfd_settime(timerfd, 0, &newValue, nullptr) != 0) {
+    muduo::logSysErr("timerfd_settime()");
+  }
+}
+
 } // namespace muduo::net::detail
 
 using namespace muduo;
 using namespace muduo::net;
 
 TimerQueue::TimerQueue(EventLoop *loop)
+    : TimerQueue(loop, TimerBackend::kDefault) {}
+
+TimerQueue::TimerQueue(EventLoop *loop, TimerBackend backend)
     : loop_(loop), timerfd_(detail::createTimerfd()),
-      timerfdChannel_(loop, timerfd_), callingExpiredTimers_(false) {
+      timerfdChannel_(loop, timerfd_),
+      store_(TimerStore::newTimerStore(backend)),
+      callingExpiredTimers_(false) {
   timerfdChannel_.setReadCallback(
       [this]([[maybe_unused]] Timestamp ts) { handleRead(ts); });
   timerfdChannel_.enableReading();
@@ -77,10 +88,19 @@ TimerQueue::~TimerQueue() {
 
 TimerId TimerQueue::addTimer(TimerCallback cb, Timestamp when,
                              std::chrono::microseconds interval) {
-  auto timer = std::make_unique<Timer>(std::move(cb), when, interval);
-  const auto sequence = timer->sequence();
-  loop_->runInLoop([this, timer = std::move(timer)]() mutable {
-    addTimerInLoop(std::move(timer));
+  return addTimer(std::move(cb), when, interval,
+                  std::chrono::microseconds::zero());
+}
+
+TimerId TimerQueue::addTimer(TimerCallback cb, Timestamp when,
+                             std::chrono::microseconds interval,
+                             std::chrono::microseconds slack) {
+  // The Timer itself is built in the loop thread, where the store allocates
+  // it.
+  const auto sequence = Timer::newSequence();
+  loop_->runInLoop([this, cb = std::move(cb), when, interval, slack,
+                    sequence]() mutable {
+    addTimerInLoop(std::move(cb), when, interval, slack, sequence);
   });
   return TimerId{sequence};
 }
@@ -89,44 +109,48 @@ void TimerQueue::cancel(TimerId timerId) {
   loop_->runInLoop([this, timerId] { cancelInLoop(timerId); });
 }
 
-void TimerQueue::addTimerInLoop(std::unique_ptr<Timer> timer) {
+void TimerQueue::addTimerInLoop(TimerCallback cb, Timestamp when,
+                                std::chrono::microseconds interval,
+                                std::chrono::microseconds slack,
+                                TimerSequence sequence) {
   loop_->assertInLoopThread();
-  assert(timers_.size() == activeTimers_.size());
-  const auto timerSeq = timer->sequence();
-  const Timestamp expiration = timer->expiration();
-  const bool earliestChanged = insertTimer(*timer);
-  const auto [ownerIt, ownerInserted] =
-      timerOwners_.emplace(timerSeq, std::move(timer));
-  (void)ownerIt;
-  assert(ownerInserted);
-  if (earliestChanged) {
-    detail::resetTimerfd(timerfd_, expiration);
+  const Timestamp earliest = store_->nextExpiration();
+  store_->add(std::move(cb), when, interval, sequence, slack);
+  const Timestamp next = store_->nextExpiration();
+  if (!earliest.valid() || next < earliest) {
+    armTimerfd(next);
   }
 }
 
 void TimerQueue::cancelInLoop(TimerId timerId) {
   loop_->assertInLoopThread();
-  assert(timers_.size() == activeTimers_.size());
   if (!timerId.valid()) {
     return;
   }
 
-  const ActiveTimer timer = timerId.sequence();
-  const auto it = activeTimers_.find(timer);
-  if (it != activeTimers_.end()) {
-    const auto ownerIt = timerOwners_.find(*it);
-    assert(ownerIt != timerOwners_.end());
-    const size_t erased =
-        timers_.erase(Entry(ownerIt->second->expiration(), *it));
-    assert(erased == 1);
-    [[maybe_unused]] const auto ownersErased = timerOwners_.erase(*it);
-    assert(ownersErased == 1);
-    activeTimers_.erase(it);
-  } else if (callingExpiredTimers_) {
-    cancelingTimers_.insert(timer);
+  if (!store_->cancel(timerId.sequence()) && callingExpiredTimers_) {
+    cancelingTimers_.insert(timerId.sequence());
   }
+}
 
-  assert(timers_.size() == activeTimers_.size());
+void TimerQueue::setDeadlinePolling(bool on) {
+  loop_->assertInLoopThread();
+  if (on == deadlinePolling_) {
+    return;
+  }
+  deadlinePolling_ = on;
+  if (on) {
+    timerfdChannel_.disableAll();
+    detail::disarmTimerfd(timerfd_);
+  } else {
+    timerfdChannel_.enableReading();
+    armTimerfd(store_->nextExpiration());
+  }
+}
+
+Timestamp TimerQueue::nextExpiration() const {
+  loop_->assertInLoopThread();
+  return store_->nextExpiration();
 }
 
 void TimerQueue::handleRead([[maybe_unused]] Timestamp receiveTime) {
@@ -134,92 +158,65 @@ void TimerQueue::handleRead([[maybe_unused]] Timestamp receiveTime) {
 
   const Timestamp now(Timestamp::now());
   detail::readTimerfd(timerfd_, now);
-  auto expired = getExpired(now);
+  expire(now);
+}
+
+void TimerQueue::expire(Timestamp now) {
+  loop_->assertInLoopThread();
+  expired_.clear();
+  store_->takeExpired(now, expired_);
+  countExpired();
 
   callingExpiredTimers_ = true;
   cancelingTimers_.clear();
-  std::ranges::for_each(expired, [this](const Entry &entry) {
-    auto ownerIt = timerOwners_.find(entry.second);
-    if (ownerIt != timerOwners_.end()) {
-      ownerIt->second->run();
-    }
-  });
+  std::ranges::for_each(expired_, [](Timer *timer) { timer->run(); });
   callingExpiredTimers_ = false;
 
-  reset(expired, now);
+  reset(now);
 }
 
-std::vector<TimerQueue::Entry> TimerQueue::getExpired(Timestamp now) {
-  assert(timers_.size() == activeTimers_.size());
-
-  std::vector<Entry> expired;
-  const auto sentry = Entry(now, std::numeric_limits<TimerSequence>::max());
-  const auto end = timers_.upper_bound(sentry);
-  expired.reserve(static_cast<size_t>(
-      std::ranges::distance(std::ranges::begin(timers_), end)));
-
-  const auto first = std::ranges::begin(timers_);
-  std::ranges::copy(std::ranges::subrange(first, end),
-                    std::back_inserter(expired));
-  timers_.erase(first, end);
-
-  std::ranges::for_each(expired, [this](const Entry &entry) {
-    [[maybe_unused]] const size_t erased = activeTimers_.erase(entry.second);
-    assert(erased == 1);
+void TimerQueue::reset(Timestamp now) {
+  std::ranges::for_each(expired_, [this, now](Timer *timer) {
+    if (timer->repeat() && !cancelingTimers_.contains(timer->sequence())) {
+      store_->restart(*timer, now);
+    } else {
+      store_->release(*timer);
+    }
   });
+  expired_.clear();
 
-  assert(timers_.size() == activeTimers_.size());
-  return expired;
+  armTimerfd(store_->nextExpiration());
 }
 
-void TimerQueue::reset(std::span<const Entry> expired, Timestamp now) {
-  Timestamp nextExpire;
-
-  std::ranges::for_each(expired, [this, now](const Entry &entry) {
-    const auto timerSeq = entry.second;
-    auto ownerIt = timerOwners_.find(timerSeq);
-    if (ownerIt == timerOwners_.end()) {
-      return;
-    }
-
-    auto &timer = *ownerIt->second;
-    if (timer.repeat() && !cancelingTimers_.contains(timerSeq)) {
-      timer.restart(now);
-      (void)insertTimer(timer);
+void TimerQueue::countExpired() {
+  if (expired_.empty()) {
+    return;
+  }
+  bool requested = false;
+  movedRequests_.clear();
+  for (const Timer *timer : expired_) {
+    if (timer->requested() == timer->expiration()) {
+      requested = true;
     } else {
-      [[maybe_unused]] const auto ownersErased = timerOwners_.erase(timerSeq);
-      assert(ownersErased == 1);
+      movedRequests_.push_back(timer->requested().microSecondsSinceEpoch());
     }
-  });
-
-  if (!timers_.empty()) {
-    nextExpire = std::ranges::begin(timers_)->first;
   }
-
-  if (nextExpire.valid()) {
-    detail::resetTimerfd(timerfd_, nextExpire);
+  std::ranges::sort(movedRequests_);
+  const auto distinct = static_cast<std::int64_t>(
+      std::ranges::distance(movedRequests_.begin(),
+                            std::ranges::unique(movedRequests_).begin()));
+
+  expiryWakeups_.fetch_add(1, std::memory_order_relaxed);
+  expiredTimers_.fetch_add(static_cast<std::int64_t>(expired_.size()),
+                           std::memory_order_relaxed);
+  if (distinct > 0) {
+    coalescedWakeups_.fetch_add(requested ? distinct : distinct - 1,
+                                std::memory_order_relaxed);
   }
 }
 
-bool TimerQueue::insertTimer(Timer &timer) {
-  loop_->assertInLoopThread();
-  assert(timers_.size() == activeTimers_.size());
-
-  bool earliestChanged = false;
-  const Timestamp when = timer.expiration();
-  const TimerSequence seq = timer.sequence();
-  if (timers_.empty() || when < std::ranges::begin(timers_)->first) {
-    earliestChanged = true;
+void TimerQueue::armTimerfd(Timestamp expiration) {
+  if (!deadlinePolling_ && expiration.valid()) {
+    detail::resetTimerfd(timerfd_, expiration);
   }
-
-  const auto [timerIt, timerInserted] = timers_.insert(Entry(when, seq));
-  (void)timerIt;
-  assert(timerInserted);
-
-  const auto [activeIt, activeInserted] = activeTimers_.insert(seq);
-  (void)activeIt;
-  assert(activeInserted);
-
-  assert(timers_.size() == activeTimers_.size());
-  return earliestChanged;
 }
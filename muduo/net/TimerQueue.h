@@ -6,13 +6,13 @@
 #include "muduo/net/Channel.h"
 #include "muduo/net/TimerId.h"
 
+#include <atomic>
 #include <chrono>
 #include <concepts>
+#include <cstdint>
 #include <set>
-#include <span>
 #include <memory>
 #include <type_traits>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -20,10 +20,13 @@ namespace muduo::net {
 
 class EventLoop;
 class Timer;
+class TimerStore;
+enum class TimerBackend : std::uint8_t;
 
 class TimerQueue : muduo::noncopyable {
 public:
   explicit TimerQueue(EventLoop *loop);
+  TimerQueue(EventLoop *loop, TimerBackend backend);
   ~TimerQueue();
 
   [[nodiscard]] TimerId addTimer(TimerCallback cb, Timestamp when,
@@ -34,33 +37,61 @@ public:
                                  std::chrono::microseconds interval) {
     return addTimer(TimerCallback(std::forward<F>(cb)), when, interval);
   }
+  // The timer may fire up to slack after when (and after each interval), so
+  // that it can share a wakeup with timers nearby; see Timer::coalesce.
+  [[nodiscard]] TimerId addTimer(TimerCallback cb, Timestamp when,
+                                 std::chrono::microseconds interval,
+                                 std::chrono::microseconds slack);
   void cancel(TimerId timerId);
 
+  // Expiry passes that ran at least one timer, timers run, and wakeups that
+  // slack saved: per pass, the distinct requested times of the timers that
+  // slack moved, less one if no timer asked for that pass itself. Any
+  // thread.
+  [[nodiscard]] std::int64_t expiryWakeups() const noexcept {
+    return expiryWakeups_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] std::int64_t expiredTimers() const noexcept {
+    return expiredTimers_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] std::int64_t coalescedWakeups() const noexcept {
+    return coalescedWakeups_.load(std::memory_order_relaxed);
+  }
+
+  // Deadline polling: the timerfd stays disarmed, the loop passes
+  // nextExpiration() to the poller as its timeout and calls expire() once the
+  // poll returns. Loop thread only.
+  void setDeadlinePolling(bool on);
+  [[nodiscard]] Timestamp nextExpiration() const;
+  void expire(Timestamp now);
+
 private:
   using TimerSequence = std::int64_t;
-  using Entry = std::pair<Timestamp, TimerSequence>;
-  using TimerList = std::set<Entry>;
-  using ActiveTimer = TimerSequence;
-  using ActiveTimerSet = std::set<ActiveTimer>;
-  using TimerOwnerMap = std::unordered_map<TimerSequence, std::unique_ptr<Timer>>;
+  using ActiveTimerSet = std::set<TimerSequence>;
 
-  void addTimerInLoop(std::unique_ptr<Timer> timer);
+  void addTimerInLoop(TimerCallback cb, Timestamp when,
+                      std::chrono::microseconds interval,
+                      std::chrono::microseconds slack, TimerSequence sequence);
   void cancelInLoop(TimerId timerId);
   void handleRead(Timestamp receiveTime);
-  [[nodiscard]] std::vector<Entry> getExpired(Timestamp now);
-  void reset(std::span<const Entry> expired, Timestamp now);
-
-  [[nodiscard]] bool insertTimer(Timer &timer);
+  void reset(Timestamp now);
+  void countExpired();
+  void armTimerfd(Timestamp expiration);
 
   EventLoop *loop_;
   const int timerfd_;
   Channel timerfdChannel_;
-  TimerList timers_;
+  std::unique_ptr<TimerStore> store_;
 
-  ActiveTimerSet activeTimers_;
+  bool deadlinePolling_{false};
   bool callingExpiredTimers_;
+  std::vector<Timer *> expired_;
   ActiveTimerSet cancelingTimers_;
-  TimerOwnerMap timerOwners_;
+  std::vector<std::int64_t> movedRequests_;
+
+  std::atomic<std::int64_t> expiryWakeups_{0};
+  std::atomic<std::int64_t> expiredTimers_{0};
+  std::atomic<std::int64_t> coalescedWakeups_{0};
 };
 
 } // namespace muduo::net
@@ -3,34 +3,41 @@
 #include "muduo/net/Buffer.h"
 
 #include <format>
+#include <iterator>
 
 namespace muduo::net {
 
 void HttpResponse::appendToBuffer(Buffer *output) const {
-  const auto statusLine =
-      std::format("HTTP/1.1 {} ", static_cast<int>(statusCode_));
-  output->append(std::string_view(statusLine));
-  output->append(std::string_view(statusMessage_));
-  output->append(std::string_view("\r\n"));
+  output->append(std::string_view(formatHead()));
+  output->append(std::string_view(body_));
+}
+
+std::array<ByteSlice, 2> HttpResponse::takeMessage() {
+  return {ByteSlice(formatHead()), ByteSlice(std::move(body_))};
+}
+
+string HttpResponse::formatHead() const {
+  string head = std::format("HTTP/1.1 {} ", static_cast<int>(statusCode_));
+  head += statusMessage_;
+  head += "\r\n";
 
   if (closeConnection_) {
-    output->append(std::string_view("Connection: close\r\n"));
+    head += "Connection: close\r\n";
   } else {
-    const auto contentLength =
-        std::format("Content-Length: {}\r\n", body_.size());
-    output->append(std::string_view(contentLength));
-    output->append(std::string_view("Connection: Keep-Alive\r\n"));
+    std::format_to(std::back_inserter(head), "Content-Length: {}\r\n",
+                   body_.size());
+    head += "Connection: Keep-Alive\r\n";
   }
 
   for (const auto &[key, value] : headers_) {
-    output->append(std::string_view(key));
-    output->append(std::string_view(": "));
-    output->append(std::string_view(value));
-    output->append(std::string_view("\r\n"));
+    head += key;
+    head += ": ";
+    head += value;
+    head += "\r\n";
   }
 
-  output->append(std::string_view("\r\n"));
-  output->append(std::string_view(body_));
+  head += "\r\n";
+  return head;
 }
 
 } // namespace muduo::net
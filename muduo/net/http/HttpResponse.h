@@ -1,7 +1,9 @@
 #pragma once
 
 #include "muduo/base/Types.h"
+#include "muduo/net/ByteSlice.h"
 
+#include <array>
 #include <map>
 #include <string_view>
 
@@ -46,8 +48,13 @@ public:
   void setBody(std::string_view body) { body_.assign(body); }
 
   void appendToBuffer(Buffer *output) const;
+  // Status line and headers, then the body, which is moved out rather than
+  // copied; for TcpConnection::sendv().
+  [[nodiscard]] std::array<ByteSlice, 2> takeMessage();
 
 private:
+  [[nodiscard]] string formatHead() const;
+
   std::map<string, string> headers_;
   HttpStatusCode statusCode_{kUnknown};
   string statusMessage_;
@@ -77,9 +77,8 @@ void HttpServer::onRequest(const TcpConnectionPtr &conn, const HttpRequest &req)
   HttpResponse response(close);
   httpCallback_(req, &response);
 
-  Buffer buf;
-  response.appendToBuffer(&buf);
-  conn->send(&buf);
+  const auto message = response.takeMessage();
+  conn->sendv(message);
   if (response.closeConnection()) {
     conn->shutdown();
   }
@@ -1,6 +1,9 @@
 #include "muduo/net/Poller.h"
 
+#include "muduo/base/Logging.h"
+#include "muduo/net/EventLoop.h"
 #include "muduo/net/poller/EPollPoller.h"
+#include "muduo/net/poller/IoUringPoller.h"
 #include "muduo/net/poller/PollPoller.h"
 
 #include <cstdlib>
@@ -11,5 +14,27 @@ std::unique_ptr<Poller> Poller::newDefaultPoller(EventLoop *loop) {
   if (::getenv("MUDUO_USE_POLL") != nullptr) {
     return std::make_unique<PollPoller>(loop);
   }
+  if (::getenv("MUDUO_USE_IO_URING") != nullptr) {
+    return newPoller(loop, PollerBackend::kIoUring);
+  }
   return std::make_unique<EPollPoller>(loop);
 }
+
+std::unique_ptr<Poller> Poller::newPoller(EventLoop *loop,
+                                          PollerBackend backend) {
+  switch (backend) {
+  case PollerBackend::kEPoll:
+    return std::make_unique<EPollPoller>(loop);
+  case PollerBackend::kPoll:
+    return std::make_unique<PollPoller>(loop);
+  case PollerBackend::kIoUring:
+    if (IoUringPoller::isSupported()) {
+      return std::make_unique<IoUringPoller>(loop);
+    }
+    muduo::logWarn("io_uring is unavailable, falling back to epoll");
+    return std::make_unique<EPollPoller>(loop);
+  case PollerBackend::kDefault:
+  default:
+    return newDefaultPoller(loop);
+  }
+}
@@ -6,7 +6,9 @@
 
 #include <cerrno>
 #include <poll.h>
+#include <atomic>
 #include <sys/epoll.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 
 using namespace muduo;
@@ -19,6 +21,15 @@ static_assert(EPOLLRDHUP == POLLRDHUP, "epoll uses same flag values as poll");
 static_assert(EPOLLERR == POLLERR, "epoll uses same flag values as poll");
 static_assert(EPOLLHUP == POLLHUP, "epoll uses same flag values as poll");
 
+namespace {
+
+#ifdef SYS_epoll_pwait2
+// Cleared on the first ENOSYS.
+std::atomic<bool> g_hasEpollPwait2{true};
+#endif
+
+} // namespace
+
 EPollPoller::EPollPoller(EventLoop *loop)
     : Poller(loop), epollfd_(::epoll_create1(EPOLL_CLOEXEC)),
       events_(kInitEventListSize) {
@@ -32,9 +43,41 @@ EPollPoller::~EPollPoller() { ::close(epollfd_); }
 Timestamp EPollPoller::poll(int timeoutMs, ChannelList *activeChannels) {
   muduo::logTrace("fd total count {}", channels_.size());
 
-  int numEvents = ::epoll_wait(epollfd_, events_.data(),
-                               static_cast<int>(events_.size()), timeoutMs);
-  const int savedErrno = errno;
+  const int numEvents = ::epoll_wait(epollfd_, events_.data(),
+                                     static_cast<int>(events_.size()),
+                                     timeoutMs);
+  return finishPoll(numEvents, errno, activeChannels);
+}
+
+Timestamp EPollPoller::pollFor(std::chrono::nanoseconds timeout,
+                               ChannelList *activeChannels) {
+#ifdef SYS_epoll_pwait2
+  // Whole milliseconds are as good with epoll_wait.
+  const bool subMillisecond =
+      timeout % std::chrono::milliseconds(1) != std::chrono::nanoseconds::zero();
+  if (timeout > std::chrono::nanoseconds::zero() && subMillisecond &&
+      g_hasEpollPwait2.load(std::memory_order_relaxed)) {
+    muduo::logTrace("fd total count {}", channels_.size());
+    const auto seconds = std::chrono::floor<std::chrono::seconds>(timeout);
+    timespec ts{};
+    ts.tv_sec = static_cast<time_t>(seconds.count());
+    ts.tv_nsec = static_cast<long>((timeout - seconds).count());
+    const auto numEvents = static_cast<int>(
+        ::syscall(SYS_epoll_pwait2, epollfd_, events_.data(),
+                  static_cast<int>(events_.size()), &ts, nullptr, 0));
+    if (numEvents >= 0 || errno != ENOSYS) {
+      return finishPoll(numEvents, errno, activeChannels);
+    }
+    muduo::logWarn("epoll_pwait2 is unavailable, rounding poll timeouts up "
+                   "to milliseconds");
+    g_hasEpollPwait2.store(false, std::memory_order_relaxed);
+  }
+#endif
+  return Poller::pollFor(timeout, activeChannels);
+}
+
+Timestamp EPollPoller::finishPoll(int numEvents, int savedErrno,
+                                  ChannelList *activeChannels) {
   const Timestamp now(Timestamp::now());
 
   if (numEvents > 0) {
@@ -65,12 +108,7 @@ void EPollPoller::fillActiveChannels(int numEvents,
                           static_cast<size_t>(numEvents));
   for (int i = 0; i < numEvents; ++i) {
     auto *channel = static_cast<Channel *>(events_[i].data.ptr);
-#ifndef NDEBUG
-    const int fd = channel->fd();
-    const auto it = channels_.find(fd);
-    assert(it != channels_.end());
-    assert(it->second == channel);
-#endif
+    assert(channels_.find(channel->fd()) == channel);
     channel->setRevents(static_cast<int>(events_[i].events));
     activeChannels->push_back(channel);
   }
@@ -86,7 +124,7 @@ void EPollPoller::updateChannel(Channel *channel) {
   if (index == kNew || index == kDeleted) {
     const int fd = channel->fd();
     if (index == kNew) {
-      channels_[fd] = channel;
+      channels_.insert(fd, channel);
     }
 
     channel->setIndex(kAdded);
@@ -96,8 +134,7 @@ void EPollPoller::updateChannel(Channel *channel) {
 
   const int fd = channel->fd();
   (void)fd;
-  assert(channels_.contains(fd));
-  assert(channels_[fd] == channel);
+  assert(channels_.find(fd) == channel);
   assert(index == kAdded);
 
   if (channel->isNoneEvent()) {
@@ -115,8 +152,7 @@ void EPollPoller::removeChannel(Channel *channel) {
   const int fd = channel->fd();
   muduo::logTrace("fd = {}", fd);
 
-  assert(channels_.contains(fd));
-  assert(channels_[fd] == channel);
+  assert(channels_.find(fd) == channel);
   assert(channel->isNoneEvent());
 
   const int index = channel->index();
@@ -134,6 +170,9 @@ void EPollPoller::removeChannel(Channel *channel) {
 void EPollPoller::update(int operation, Channel *channel) const {
   epoll_event event{};
   event.events = static_cast<uint32_t>(channel->events());
+  if (channel->isEdgeTriggered()) {
+    event.events |= EPOLLET;
+  }
   event.data.ptr = channel;
 
   const int fd = channel->fd();
@@ -15,8 +15,13 @@ public:
 
   [[nodiscard]] Timestamp poll(int timeoutMs,
                                ChannelList *activeChannels) override;
+  // epoll_pwait2 where the kernel has it (5.11), for sub-millisecond
+  // timeouts.
+  [[nodiscard]] Timestamp pollFor(std::chrono::nanoseconds timeout,
+                                  ChannelList *activeChannels) override;
   void updateChannel(Channel *channel) override;
   void removeChannel(Channel *channel) override;
+  [[nodiscard]] bool supportsEdgeTriggered() const override { return true; }
 
 private:
   static constexpr int kInitEventListSize = 16;
@@ -26,6 +31,8 @@ private:
 
   static const char *operationToString(int op);
 
+  [[nodiscard]] Timestamp finishPoll(int numEvents, int savedErrno,
+                                     ChannelList *activeChannels);
   void fillActiveChannels(int numEvents, ChannelList *activeChannels) const;
   void update(int operation, Channel *channel) const;
 
@@ -0,0 +1,287 @@
+#include "muduo/net/poller/IoUring.h"
+
+#include "muduo/base/Logging.h"
+
+#include <algorithm>
+#include <cassert>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <linux/time_types.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+namespace {
+
+constexpr unsigned kRequiredFeatures =
+    IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+
+int sysSetup(unsigned entries, io_uring_params *params) {
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int sysEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags,
+             const void *arg, size_t argSize) {
+  return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit,
+                                    minComplete, flags, arg, argSize));
+}
+
+int sysRegister(int fd, unsigned opcode, const void *arg, unsigned nrArgs) {
+  return static_cast<int>(
+      ::syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs));
+}
+
+template <typename T> T *ringPtr(void *base, std::uint32_t offset) {
+  return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+}
+
+unsigned loadAcquire(unsigned *p) noexcept {
+  return std::atomic_ref<unsigned>(*p).load(std::memory_order_acquire);
+}
+
+void storeRelease(unsigned *p, unsigned v) noexcept {
+  std::atomic_ref<unsigned>(*p).store(v, std::memory_order_release);
+}
+
+void *mapAnonymous(size_t size) {
+  void *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  return p == MAP_FAILED ? nullptr : p;
+}
+
+} // namespace
+
+bool IoUring::probe() {
+  static const bool supported = [] {
+    io_uring_params params{};
+    const int fd = sysSetup(4, &params);
+    if (fd < 0) {
+      return false;
+    }
+    ::close(fd);
+    return (params.features & kRequiredFeatures) == kRequiredFeatures;
+  }();
+  return supported;
+}
+
+IoUring::IoUring(unsigned entries, unsigned cqEntries) {
+  params_.flags = IORING_SETUP_CLAMP;
+  if (cqEntries > entries) {
+    params_.flags |= IORING_SETUP_CQSIZE;
+    params_.cq_entries = cqEntries;
+  }
+
+  ringFd_ = sysSetup(entries, &params_);
+  if (ringFd_ < 0) {
+    muduo::logSysFatal("IoUring::IoUring io_uring_setup");
+  }
+  if ((params_.features & kRequiredFeatures) != kRequiredFeatures) {
+    muduo::logFatal("IoUring::IoUring kernel lacks required features {:#x}",
+                    kRequiredFeatures & ~params_.features);
+  }
+
+  sqRingSize_ = params_.sq_off.array + params_.sq_entries * sizeof(unsigned);
+  cqRingSize_ = params_.cq_off.cqes + params_.cq_entries * sizeof(io_uring_cqe);
+  // IORING_FEAT_SINGLE_MMAP: both rings live in one mapping.
+  sqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+  cqRingSize_ = sqRingSize_;
+
+  sqRing_ = ::mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQ_RING);
+  if (sqRing_ == MAP_FAILED) {
+    muduo::logSysFatal("IoUring::IoUring mmap sq ring");
+  }
+  cqRing_ = sqRing_;
+
+  sqesSize_ = params_.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = ::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    muduo::logSysFatal("IoUring::IoUring mmap sqes");
+  }
+  sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+  sqHead_ = ringPtr<unsigned>(sqRing_, params_.sq_off.head);
+  sqTail_ = ringPtr<unsigned>(sqRing_, params_.sq_off.tail);
+  sqMask_ = *ringPtr<unsigned>(sqRing_, params_.sq_off.ring_mask);
+  sqEntries_ = *ringPtr<unsigned>(sqRing_, params_.sq_off.ring_entries);
+  sqeTail_ = *sqTail_;
+  // SQE slots are handed out in ring order, so the indirection array is
+  // simply the identity mapping.
+  auto *array = ringPtr<unsigned>(sqRing_, params_.sq_off.array);
+  for (unsigned i = 0; i < sqEntries_; ++i) {
+    array[i] = i;
+  }
+
+  cqHeadPtr_ = ringPtr<unsigned>(cqRing_, params_.cq_off.head);
+  cqTailPtr_ = ringPtr<unsigned>(cqRing_, params_.cq_off.tail);
+  cqMask_ = *ringPtr<unsigned>(cqRing_, params_.cq_off.ring_mask);
+  cqes_ = ringPtr<io_uring_cqe>(cqRing_, params_.cq_off.cqes);
+}
+
+IoUring::~IoUring() {
+  if (sqes_ != nullptr) {
+    ::munmap(sqes_, sqesSize_);
+  }
+  if (sqRing_ != nullptr && sqRing_ != MAP_FAILED) {
+    ::munmap(sqRing_, sqRingSize_);
+  }
+  if (ringFd_ >= 0) {
+    ::close(ringFd_);
+  }
+}
+
+bool IoUring::submitForRoom() {
+  const int ret = submit();
+  if (ret > 0) {
+    return true;
+  }
+  if (ret < 0 && ret != -EBUSY && ret != -EAGAIN && ret != -EINTR) {
+    errno = -ret;
+    muduo::logSysFatal("IoUring::getSqe submit");
+  }
+  return false;
+}
+
+io_uring_sqe *IoUring::nextSqe() noexcept {
+  assert(pendingSqes() < sqEntries_);
+  io_uring_sqe *sqe = &sqes_[sqeTail_ & sqMask_];
+  ++sqeTail_;
+  std::memset(sqe, 0, sizeof(*sqe));
+  return sqe;
+}
+
+unsigned IoUring::pendingSqes() const noexcept {
+  return sqeTail_ - loadAcquire(sqHead_);
+}
+
+unsigned IoUring::flushSq() noexcept {
+  storeRelease(sqTail_, sqeTail_);
+  return sqeTail_ - loadAcquire(sqHead_);
+}
+
+int IoUring::submit() {
+  const unsigned toSubmit = flushSq();
+  if (toSubmit == 0) {
+    return 0;
+  }
+  return enter(toSubmit, 0, 0, nullptr, 0);
+}
+
+int IoUring::submitAndWait(int timeoutMs) {
+  return submitAndWait(timeoutMs < 0 ? std::chrono::nanoseconds(-1)
+                                     : std::chrono::milliseconds(timeoutMs));
+}
+
+int IoUring::submitAndWait(std::chrono::nanoseconds timeout) {
+  const unsigned toSubmit = flushSq();
+  if (timeout == std::chrono::nanoseconds::zero()) {
+    return toSubmit == 0 ? 0 : enter(toSubmit, 0, 0, nullptr, 0);
+  }
+  if (cqTail() != cqHead()) {
+    // Completions are already waiting, only push the submissions.
+    return toSubmit == 0 ? 0 : enter(toSubmit, 0, 0, nullptr, 0);
+  }
+
+  __kernel_timespec ts{};
+  io_uring_getevents_arg arg{};
+  arg.sigmask_sz = _NSIG / 8;
+  if (timeout > std::chrono::nanoseconds::zero()) {
+    const auto seconds = std::chrono::floor<std::chrono::seconds>(timeout);
+    ts.tv_sec = seconds.count();
+    ts.tv_nsec = (timeout - seconds).count();
+    arg.ts = reinterpret_cast<std::uint64_t>(&ts);
+  }
+  const int ret = enter(toSubmit, 1,
+                        IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg,
+                        sizeof(arg));
+  return ret == -ETIME ? 0 : ret;
+}
+
+int IoUring::enter(unsigned toSubmit, unsigned minComplete, unsigned flags,
+                   const void *arg, size_t argSize) {
+  const int ret = sysEnter(ringFd_, toSubmit, minComplete, flags, arg, argSize);
+  return ret < 0 ? -errno : ret;
+}
+
+unsigned IoUring::cqHead() const noexcept { return *cqHeadPtr_; }
+
+unsigned IoUring::cqTail() const noexcept { return loadAcquire(cqTailPtr_); }
+
+void IoUring::advanceCq(unsigned head) noexcept {
+  storeRelease(cqHeadPtr_, head);
+}
+
+int IoUring::registerBufferRing(io_uring_buf *bufs, unsigned entries,
+                                std::uint16_t groupId) {
+  io_uring_buf_reg reg{};
+  reg.ring_addr = reinterpret_cast<std::uint64_t>(bufs);
+  reg.ring_entries = entries;
+  reg.bgid = groupId;
+  const int ret = sysRegister(ringFd_, IORING_REGISTER_PBUF_RING, &reg, 1);
+  return ret < 0 ? -errno : ret;
+}
+
+int IoUring::unregisterBufferRing(std::uint16_t groupId) {
+  io_uring_buf_reg reg{};
+  reg.bgid = groupId;
+  const int ret = sysRegister(ringFd_, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+  return ret < 0 ? -errno : ret;
+}
+
+IoUringBufferRing::IoUringBufferRing(IoUring &ring, std::uint16_t groupId,
+                                     unsigned count, unsigned bufferSize)
+    : ring_(ring), groupId_(groupId), count_(count), bufferSize_(bufferSize) {
+  assert(count > 0 && (count & (count - 1)) == 0 && count <= 32768);
+
+  // The ring must be page aligned; the buffers are only faulted in once the
+  // kernel first writes into them.
+  bufsSize_ = static_cast<size_t>(count) * sizeof(io_uring_buf);
+  bufs_ = static_cast<io_uring_buf *>(mapAnonymous(bufsSize_));
+  dataSize_ = static_cast<size_t>(count) * bufferSize;
+  data_ = static_cast<std::byte *>(mapAnonymous(dataSize_));
+  if (bufs_ == nullptr || data_ == nullptr) {
+    muduo::logSysErr("IoUringBufferRing mmap");
+    return;
+  }
+
+  const int ret = ring_.registerBufferRing(bufs_, count, groupId);
+  if (ret < 0) {
+    errno = -ret;
+    muduo::logSysErr("IoUringBufferRing register group {}", groupId);
+    return;
+  }
+  registered_ = true;
+  for (unsigned bid = 0; bid < count; ++bid) {
+    recycle(bid);
+  }
+}
+
+IoUringBufferRing::~IoUringBufferRing() {
+  if (registered_) {
+    (void)ring_.unregisterBufferRing(groupId_);
+  }
+  if (data_ != nullptr) {
+    ::munmap(data_, dataSize_);
+  }
+  if (bufs_ != nullptr) {
+    ::munmap(bufs_, bufsSize_);
+  }
+}
+
+void IoUringBufferRing::recycle(unsigned bid) noexcept {
+  assert(bid < count_);
+  io_uring_buf &buf = bufs_[tail_ & (count_ - 1)];
+  buf.addr = reinterpret_cast<std::uint64_t>(buffer(bid, 0).data());
+  buf.len = bufferSize_;
+  buf.bid = static_cast<std::uint16_t>(bid);
+  ++tail_;
+  // The shared tail overlays the resv field of the first entry.
+  std::atomic_ref<std::uint16_t>(bufs_[0].resv)
+      .store(tail_, std::memory_order_release);
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "muduo/base/noncopyable.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <linux/io_uring.h>
+#include <span>
+
+namespace muduo::net {
+
+// Thin owner of one io_uring instance: the SQ/CQ rings mapped into this
+// process plus the raw io_uring_setup/io_uring_enter syscalls. It is meant to
+// be driven by exactly one EventLoop thread, so no locking is done here.
+class IoUring : muduo::noncopyable {
+public:
+  explicit IoUring(unsigned entries, unsigned cqEntries = 0);
+  ~IoUring();
+
+  // Whether the running kernel accepts io_uring_setup and supports the
+  // features IoUring relies on (EXT_ARG timeouts, NODROP completions).
+  [[nodiscard]] static bool probe();
+
+  [[nodiscard]] int fd() const noexcept { return ringFd_; }
+
+  // Returns a zeroed SQE. If the submission ring is full the pending entries
+  // are pushed to the kernel first; while it takes none of them (-EBUSY once
+  // the completion ring backs up) the waiting CQEs are consumed through reap
+  // and the submit is retried. A slot is only reused once the kernel has
+  // consumed its entry, so this never fails.
+  template <typename F> [[nodiscard]] io_uring_sqe *getSqe(F &&reap) {
+    while (pendingSqes() >= sqEntries_) {
+      if (!submitForRoom()) {
+        (void)forEachCqe(reap);
+      }
+    }
+    return nextSqe();
+  }
+  [[nodiscard]] unsigned pendingSqes() const noexcept;
+
+  // Submits pending SQEs without waiting. Returns the number submitted or
+  // -errno.
+  int submit();
+  // Submits pending SQEs and waits up to timeoutMs for at least one
+  // completion (timeoutMs < 0 waits forever, 0 does not wait at all).
+  // Returns >= 0 on success or a timeout, -errno otherwise.
+  int submitAndWait(int timeoutMs);
+  // Same with a nanosecond timeout; negative waits forever.
+  int submitAndWait(std::chrono::nanoseconds timeout);
+
+  // IORING_REGISTER_PBUF_RING / IORING_UNREGISTER_PBUF_RING. Return 0 or
+  // -errno.
+  int registerBufferRing(io_uring_buf *bufs, unsigned entries,
+                         std::uint16_t groupId);
+  int unregisterBufferRing(std::uint16_t groupId);
+
+  // Consumes every CQE currently in the completion ring.
+  template <typename F> unsigned forEachCqe(F &&f) {
+    unsigned head = cqHead();
+    const unsigned tail = cqTail();
+    unsigned count = 0;
+    for (; head != tail; ++head, ++count) {
+      f(cqes_[head & cqMask_]);
+    }
+    if (count > 0) {
+      advanceCq(head);
+    }
+    return count;
+  }
+
+private:
+  [[nodiscard]] unsigned cqHead() const noexcept;
+  [[nodiscard]] unsigned cqTail() const noexcept;
+  void advanceCq(unsigned head) noexcept;
+  unsigned flushSq() noexcept;
+  // One submit of a full ring: true if the kernel consumed entries.
+  bool submitForRoom();
+  io_uring_sqe *nextSqe() noexcept;
+  int enter(unsigned toSubmit, unsigned minComplete, unsigned flags,
+            const void *arg, size_t argSize);
+
+  int ringFd_{-1};
+  io_uring_params params_{};
+
+  void *sqRing_{nullptr};
+  size_t sqRingSize_{0};
+  void *cqRing_{nullptr};
+  size_t cqRingSize_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqesSize_{0};
+
+  unsigned *sqHead_{nullptr};
+  unsigned *sqTail_{nullptr};
+  unsigned sqMask_{0};
+  unsigned sqEntries_{0};
+  unsigned sqeTail_{0};
+
+  unsigned *cqHeadPtr_{nullptr};
+  unsigned *cqTailPtr_{nullptr};
+  unsigned cqMask_{0};
+  io_uring_cqe *cqes_{nullptr};
+};
+
+// A provided-buffer ring: count equally sized buffers the kernel picks from
+// when a request is submitted with IOSQE_BUFFER_SELECT. A buffer handed out in
+// a CQE belongs to the application until recycle() gives it back.
+class IoUringBufferRing : muduo::noncopyable {
+public:
+  // count must be a power of two. Check valid() afterwards: kernels before
+  // 5.19 do not know about buffer rings.
+  IoUringBufferRing(IoUring &ring, std::uint16_t groupId, unsigned count,
+                    unsigned bufferSize);
+  ~IoUringBufferRing();
+
+  [[nodiscard]] bool valid() const noexcept { return registered_; }
+  [[nodiscard]] std::uint16_t groupId() const noexcept { return groupId_; }
+
+  [[nodiscard]] std::span<const std::byte> buffer(unsigned bid,
+                                                  size_t len) const noexcept {
+    return {data_ + static_cast<size_t>(bid) * bufferSize_, len};
+  }
+  void recycle(unsigned bid) noexcept;
+
+private:
+  IoUring &ring_;
+  const std::uint16_t groupId_;
+  const unsigned count_;
+  const unsigned bufferSize_;
+  bool registered_{false};
+  std::uint16_t tail_{0};
+  io_uring_buf *bufs_{nullptr};
+  size_t bufsSize_{0};
+  std::byte *data_{nullptr};
+  size_t dataSize_{0};
+};
+
+} // namespace muduo::net
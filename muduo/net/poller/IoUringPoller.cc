@@ -0,0 +1,378 @@
+#include "muduo/net/poller/IoUringPoller.h"
+
+#include "muduo/base/Logging.h"
+#include "muduo/net/Channel.h"
+
+#include <cassert>
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+
+using namespace muduo;
+using namespace muduo::net;
+
+IoUringPoller::IoUringPoller(EventLoop *loop)
+    : Poller(loop), ring_(kRingEntries, kCompletionEntries),
+      bufferRing_(ring_, kBufferGroup, kProvidedBuffers, kProvidedBufferSize),
+      completionChannel_(loop, ring_.fd()) {
+  // Never registered with a poller: poll() hands it out as active whenever
+  // operation completions are waiting.
+  completionChannel_.setReadCallback(
+      [this](Timestamp) { dispatchCompletions(); });
+}
+
+IoUringPoller::~IoUringPoller() = default;
+
+Timestamp IoUringPoller::poll(int timeoutMs, ChannelList *activeChannels) {
+  return pollFor(timeoutMs < 0 ? std::chrono::nanoseconds(-1)
+                               : std::chrono::milliseconds(timeoutMs),
+                 activeChannels);
+}
+
+Timestamp IoUringPoller::pollFor(std::chrono::nanoseconds timeout,
+                                 ChannelList *activeChannels) {
+  syncInterest();
+
+  // Completions reaped while queueing requests are already waiting.
+  const int ret = ring_.submitAndWait(
+      reaped_.empty() ? timeout : std::chrono::nanoseconds::zero());
+  const Timestamp now(Timestamp::now());
+  if (ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY) {
+    errno = -ret;
+    muduo::logSysErr("IoUringPoller::poll()");
+  }
+
+  // The reaped ones are older than anything still in the ring.
+  for (const io_uring_cqe &cqe : reaped_) {
+    fillActiveChannels(cqe, activeChannels);
+  }
+  const auto numReaped = static_cast<unsigned>(reaped_.size());
+  reaped_.clear();
+  const unsigned numEvents = numReaped + ring_.forEachCqe(
+      [this, activeChannels](const io_uring_cqe &cqe) {
+        fillActiveChannels(cqe, activeChannels);
+      });
+  if (numEvents > 0) {
+    muduo::logTrace("{} completions happened", numEvents);
+  } else {
+    muduo::logTrace("nothing happened");
+  }
+  if (!completions_.empty()) {
+    completionChannel_.setRevents(POLLIN);
+    activeChannels->push_back(&completionChannel_);
+  }
+  return now;
+}
+
+void IoUringPoller::fillActiveChannels(const io_uring_cqe &cqe,
+                                       ChannelList *activeChannels) {
+  if (cqe.user_data == kIgnoredUserData) {
+    return;
+  }
+  if ((cqe.user_data & kOperationTag) != 0) {
+    completions_.push_back({cqe.user_data, cqe.res, cqe.flags, false});
+    return;
+  }
+
+  const auto slot = static_cast<int>(cqe.user_data >> 32);
+  const auto generation = static_cast<std::uint32_t>(cqe.user_data);
+  if (static_cast<size_t>(slot) >= states_.size()) {
+    return;
+  }
+  auto &state = states_[static_cast<size_t>(slot)];
+  if (state.channel == nullptr || state.generation != generation) {
+    // Completion of a request that was already replaced or cancelled.
+    return;
+  }
+
+  // POLL_ADD without IORING_POLL_ADD_MULTI is one-shot, and the kernel may
+  // end a multishot one too; re-arm on the next poll() if the channel is
+  // still interested.
+  if ((cqe.flags & IORING_CQE_F_MORE) == 0) {
+    state.armed = false;
+    markDirty(slot);
+  }
+
+  if (cqe.res < 0) {
+    if (cqe.res != -ECANCELED) {
+      errno = -cqe.res;
+      muduo::logSysErr("IoUringPoller poll fd = {}", state.channel->fd());
+      state.channel->setRevents(POLLERR);
+      activeChannels->push_back(state.channel);
+    }
+    return;
+  }
+
+  state.channel->setRevents(cqe.res);
+  activeChannels->push_back(state.channel);
+}
+
+void IoUringPoller::updateChannel(Channel *channel) {
+  Poller::assertInLoopThread();
+  muduo::logTrace("fd = {} events = {} index = {}", channel->fd(),
+                  channel->events(), channel->index());
+
+  int slot = channel->index();
+  if (slot < 0) {
+    assert(!channels_.contains(channel->fd()));
+    if (freeSlots_.empty()) {
+      slot = static_cast<int>(states_.size());
+      states_.emplace_back();
+    } else {
+      slot = freeSlots_.back();
+      freeSlots_.pop_back();
+    }
+    auto &state = states_[static_cast<size_t>(slot)];
+    state.channel = channel;
+    state.armed = false;
+    state.dirty = false;
+    channel->setIndex(slot);
+    channels_.insert(channel->fd(), channel);
+  }
+
+  assert(channels_.find(channel->fd()) == channel);
+  assert(states_[static_cast<size_t>(slot)].channel == channel);
+  markDirty(slot);
+}
+
+void IoUringPoller::removeChannel(Channel *channel) {
+  Poller::assertInLoopThread();
+  muduo::logTrace("fd = {}", channel->fd());
+
+  assert(channels_.find(channel->fd()) == channel);
+  assert(channel->isNoneEvent());
+
+  const int slot = channel->index();
+  assert(slot >= 0 && static_cast<size_t>(slot) < states_.size());
+  auto &state = states_[static_cast<size_t>(slot)];
+  assert(state.channel == channel);
+
+  // The cancellation has to be queued now: the caller is about to close the
+  // fd, and an armed poll request would otherwise keep the file alive.
+  cancelPoll(state);
+  ++state.generation;
+  state.channel = nullptr;
+  state.dirty = false;
+  freeSlots_.push_back(slot);
+
+  [[maybe_unused]] const auto erased = channels_.erase(channel->fd());
+  assert(erased == 1);
+  channel->setIndex(-1);
+}
+
+io_uring_sqe *IoUringPoller::getSqe() {
+  return ring_.getSqe(
+      [this](const io_uring_cqe &cqe) { reaped_.push_back(cqe); });
+}
+
+void IoUringPoller::markDirty(int slot) {
+  auto &state = states_[static_cast<size_t>(slot)];
+  if (!state.dirty) {
+    state.dirty = true;
+    dirtySlots_.push_back(slot);
+  }
+}
+
+void IoUringPoller::syncInterest() {
+  for (const int slot : dirtySlots_) {
+    auto &state = states_[static_cast<size_t>(slot)];
+    if (!state.dirty || state.channel == nullptr) {
+      continue;
+    }
+    state.dirty = false;
+
+    const int wanted = state.channel->events();
+    if (state.armed && state.armedEvents == wanted &&
+        state.armedMultishot == state.channel->isEdgeTriggered()) {
+      continue;
+    }
+    if (state.armed) {
+      cancelPoll(state);
+    }
+    if (wanted != 0) {
+      armPoll(slot);
+    }
+  }
+  dirtySlots_.clear();
+}
+
+void IoUringPoller::armPoll(int slot) {
+  auto &state = states_[static_cast<size_t>(slot)];
+  if (++state.generation == 0) {
+    ++state.generation;
+  }
+  state.armed = true;
+  state.armedEvents = state.channel->events();
+  state.armedMultishot = state.channel->isEdgeTriggered();
+
+  io_uring_sqe *sqe = getSqe();
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = state.channel->fd();
+  sqe->poll32_events = static_cast<std::uint32_t>(state.armedEvents);
+  if (state.armedMultishot) {
+    sqe->len = IORING_POLL_ADD_MULTI;
+  }
+  sqe->user_data = makeUserData(slot, state.generation);
+  muduo::logTrace("io_uring poll add fd = {} event = {{ {} }}",
+                  state.channel->fd(), state.channel->eventsToString());
+}
+
+void IoUringPoller::cancelPoll(PollState &state) {
+  if (!state.armed) {
+    return;
+  }
+  const auto slot = static_cast<int>(&state - states_.data());
+  io_uring_sqe *sqe = getSqe();
+  sqe->opcode = IORING_OP_POLL_REMOVE;
+  sqe->fd = -1;
+  sqe->addr = makeUserData(slot, state.generation);
+  sqe->user_data = kIgnoredUserData;
+  state.armed = false;
+}
+
+int IoUringPoller::addOperation(CompletionCallback cb) {
+  Poller::assertInLoopThread();
+  int op = 0;
+  if (freeOperations_.empty()) {
+    op = static_cast<int>(operations_.size());
+    operations_.emplace_back();
+  } else {
+    op = freeOperations_.back();
+    freeOperations_.pop_back();
+  }
+  auto &operation = operations_[static_cast<size_t>(op)];
+  operation.callback = std::move(cb);
+  operation.removed = false;
+  return op;
+}
+
+void IoUringPoller::removeOperation(int op) {
+  Poller::assertInLoopThread();
+  auto &operation = operations_[static_cast<size_t>(op)];
+  assert(!operation.removed);
+  operation.callback = CompletionCallback{};
+  operation.removed = true;
+  if (operation.inflight) {
+    // The slot is recycled once the final completion shows up.
+    cancelOperation(op);
+  } else {
+    freeOperation(op);
+  }
+}
+
+void IoUringPoller::cancelOperation(int op) {
+  Poller::assertInLoopThread();
+  const auto &operation = operations_[static_cast<size_t>(op)];
+  if (!operation.inflight) {
+    return;
+  }
+  io_uring_sqe *sqe = getSqe();
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  sqe->addr = kOperationTag | makeUserData(op, operation.generation);
+  sqe->user_data = kIgnoredUserData;
+}
+
+void IoUringPoller::submitRecvMultishot(int op, int fd) {
+  assert(supportsCompletionIo());
+  io_uring_sqe *sqe = prepareOperation(op);
+  sqe->opcode = IORING_OP_RECV;
+  sqe->fd = fd;
+  sqe->ioprio = IORING_RECV_MULTISHOT;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = bufferRing_.groupId();
+}
+
+void IoUringPoller::submitSend(int op, int fd, std::span<const std::byte> data,
+                               std::shared_ptr<const void> keepAlive) {
+  io_uring_sqe *sqe = prepareOperation(op);
+  sqe->opcode = IORING_OP_SEND;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<std::uint64_t>(data.data());
+  sqe->len = static_cast<std::uint32_t>(data.size());
+  sqe->msg_flags = MSG_NOSIGNAL;
+  operations_[static_cast<size_t>(op)].keepAlive = std::move(keepAlive);
+}
+
+io_uring_sqe *IoUringPoller::prepareOperation(int op) {
+  Poller::assertInLoopThread();
+  auto &operation = operations_[static_cast<size_t>(op)];
+  assert(!operation.removed && !operation.inflight);
+  operation.inflight = true;
+  io_uring_sqe *sqe = getSqe();
+  sqe->user_data = kOperationTag | makeUserData(op, operation.generation);
+  return sqe;
+}
+
+void IoUringPoller::freeOperation(int op) {
+  auto &operation = operations_[static_cast<size_t>(op)];
+  operation.keepAlive.reset();
+  if (++operation.generation == 0) {
+    ++operation.generation;
+  }
+  freeOperations_.push_back(op);
+}
+
+IoUringPoller::Operation *IoUringPoller::liveOperation(std::uint64_t userData) {
+  const auto op = static_cast<size_t>((userData & ~kOperationTag) >> 32);
+  auto &operation = operations_[op];
+  return operation.generation == static_cast<std::uint32_t>(userData)
+             ? &operation
+             : nullptr;
+}
+
+void IoUringPoller::dispatchCompletions() {
+  dispatching_.swap(completions_);
+
+  // Walk backwards once to flag the final completion of each operation.
+  ++batch_;
+  for (auto it = dispatching_.rbegin(); it != dispatching_.rend(); ++it) {
+    if (Operation *operation = liveOperation(it->userData);
+        operation != nullptr && operation->batch != batch_) {
+      operation->batch = batch_;
+      it->lastInBatch = true;
+    }
+  }
+
+  for (const auto &cqe : dispatching_) {
+    const bool hasBuffer = (cqe.flags & IORING_CQE_F_BUFFER) != 0;
+    const auto bid = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+    const bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+
+    Operation *operation = liveOperation(cqe.userData);
+    if (operation == nullptr) {
+      if (hasBuffer) {
+        bufferRing_.recycle(bid);
+      }
+      continue;
+    }
+
+    if (!more) {
+      operation->inflight = false;
+      operation->keepAlive.reset();
+    }
+    const auto op = static_cast<int>((cqe.userData & ~kOperationTag) >> 32);
+    if (operation->removed) {
+      if (!more) {
+        freeOperation(op);
+      }
+    } else {
+      Completion completion{cqe.res, {}, more, cqe.lastInBatch};
+      if (hasBuffer && cqe.res > 0) {
+        completion.data = bufferRing_.buffer(bid, static_cast<size_t>(cqe.res));
+      }
+      // The handler may remove its own operation, so it must not run from
+      // inside the slot.
+      auto callback = std::move(operation->callback);
+      callback(completion);
+      if (!operation->removed &&
+          operation->generation == static_cast<std::uint32_t>(cqe.userData)) {
+        operation->callback = std::move(callback);
+      }
+    }
+    if (hasBuffer) {
+      bufferRing_.recycle(bid);
+    }
+  }
+  dispatching_.clear();
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "muduo/net/Channel.h"
+#include "muduo/net/Poller.h"
+#include "muduo/net/poller/IoUring.h"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace muduo::net {
+
+// Readiness poller on top of io_uring POLL_ADD requests.
+//
+// Interest changes do not issue a syscall: updateChannel() only marks the
+// channel dirty, and poll() turns the net change of every dirty channel into
+// SQEs that ride along with the io_uring_enter() that waits for events. A
+// Channel flipping POLLOUT on and off within one loop iteration therefore
+// costs nothing at all.
+//
+// It also runs completion-based operations (multishot recv into a provided
+// buffer ring, send) for TcpConnection. Their CQEs are collected by poll()
+// and dispatched through an internal Channel, so completion handlers run in
+// the event-handling phase like any other channel callback.
+class IoUringPoller : public Poller {
+public:
+  struct Completion {
+    // CQE result.
+    int res;
+    // For recv, the received bytes in a provided buffer; only valid during
+    // the callback.
+    std::span<const std::byte> data;
+    // IORING_CQE_F_MORE: false once the request is finished and may be
+    // submitted again.
+    bool more;
+    // No further completion for this operation in the current batch. Lets a
+    // reader hand over everything that arrived at once, like one readv().
+    bool lastInBatch;
+  };
+  using CompletionCallback = CallbackFunction<void(const Completion &)>;
+
+  explicit IoUringPoller(EventLoop *loop);
+  ~IoUringPoller() override;
+
+  [[nodiscard]] static bool isSupported() { return IoUring::probe(); }
+  [[nodiscard]] bool supportsCompletionIo() const noexcept {
+    return bufferRing_.valid();
+  }
+
+  [[nodiscard]] Timestamp poll(int timeoutMs,
+                               ChannelList *activeChannels) override;
+  // The io_uring_enter() wait takes a nanosecond timeout.
+  [[nodiscard]] Timestamp pollFor(std::chrono::nanoseconds timeout,
+                                  ChannelList *activeChannels) override;
+  void updateChannel(Channel *channel) override;
+  void removeChannel(Channel *channel) override;
+  // Edge-triggered channels use multishot POLL_ADD, which the kernel only
+  // offers edge triggered; it stays armed across events.
+  [[nodiscard]] bool supportsEdgeTriggered() const override { return true; }
+
+  // An operation slot carries at most one request at a time.
+  [[nodiscard]] int addOperation(CompletionCallback cb);
+  // Cancels the in-flight request, if any. Its remaining completions are
+  // dropped and their buffers recycled.
+  void removeOperation(int op);
+  void cancelOperation(int op);
+  void submitRecvMultishot(int op, int fd);
+  // keepAlive owns data until the send completes, even if the operation is
+  // removed in the meantime.
+  void submitSend(int op, int fd, std::span<const std::byte> data,
+                  std::shared_ptr<const void> keepAlive);
+
+private:
+  static constexpr unsigned kRingEntries = 256;
+  static constexpr unsigned kCompletionEntries = 4096;
+  static constexpr std::uint64_t kIgnoredUserData = 0;
+  static constexpr std::uint64_t kOperationTag = std::uint64_t{1} << 63;
+  static constexpr std::uint16_t kBufferGroup = 0;
+  static constexpr unsigned kProvidedBuffers = 512;
+  static constexpr unsigned kProvidedBufferSize = 16 * 1024;
+
+  struct PollState {
+    Channel *channel{nullptr};
+    std::uint32_t generation{0};
+    int armedEvents{0};
+    bool armed{false};
+    bool armedMultishot{false};
+    bool dirty{false};
+  };
+
+  struct Operation {
+    CompletionCallback callback;
+    std::shared_ptr<const void> keepAlive;
+    std::uint32_t generation{1};
+    std::uint32_t batch{0};
+    bool inflight{false};
+    bool removed{false};
+  };
+
+  struct Cqe {
+    std::uint64_t userData;
+    int res;
+    std::uint32_t flags;
+    bool lastInBatch;
+  };
+
+  [[nodiscard]] static std::uint64_t makeUserData(int slot,
+                                                  std::uint32_t generation) {
+    return (static_cast<std::uint64_t>(slot) << 32) | generation;
+  }
+
+  // ring_.getSqe() that keeps the CQEs it has to consume to make room for
+  // the next poll().
+  [[nodiscard]] io_uring_sqe *getSqe();
+  void markDirty(int slot);
+  void syncInterest();
+  void armPoll(int slot);
+  void cancelPoll(PollState &state);
+  void fillActiveChannels(const io_uring_cqe &cqe,
+                          ChannelList *activeChannels);
+  [[nodiscard]] io_uring_sqe *prepareOperation(int op);
+  void freeOperation(int op);
+  [[nodiscard]] Operation *liveOperation(std::uint64_t userData);
+  void dispatchCompletions();
+
+  IoUring ring_;
+  IoUringBufferRing bufferRing_;
+  std::vector<PollState> states_;
+  std::vector<int> freeSlots_;
+  std::vector<int> dirtySlots_;
+  // Consumed by getSqe() outside poll(), reported by the next one.
+  std::vector<io_uring_cqe> reaped_;
+
+  // deque: handlers may add operations while one of them is running.
+  std::deque<Operation> operations_;
+  std::vector<int> freeOperations_;
+  std::vector<Cqe> completions_;
+  std::vector<Cqe> dispatching_;
+  std::uint32_t batch_{0};
+  Channel completionChannel_;
+};
+
+} // namespace muduo::net
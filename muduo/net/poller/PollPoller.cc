@@ -14,9 +14,24 @@ PollPoller::PollPoller(EventLoop *loop) : Poller(loop) {}
 PollPoller::~PollPoller() = default;
 
 Timestamp PollPoller::poll(int timeoutMs, ChannelList *activeChannels) {
-  int numEvents =
+  const int numEvents =
       ::poll(pollfds_.empty() ? nullptr : pollfds_.data(), pollfds_.size(), timeoutMs);
-  const int savedErrno = errno;
+  return finishPoll(numEvents, errno, activeChannels);
+}
+
+Timestamp PollPoller::pollFor(std::chrono::nanoseconds timeout,
+                              ChannelList *activeChannels) {
+  const auto seconds = std::chrono::floor<std::chrono::seconds>(timeout);
+  timespec ts{};
+  ts.tv_sec = static_cast<time_t>(seconds.count());
+  ts.tv_nsec = static_cast<long>((timeout - seconds).count());
+  const int numEvents = ::ppoll(pollfds_.empty() ? nullptr : pollfds_.data(),
+                                pollfds_.size(), &ts, nullptr);
+  return finishPoll(numEvents, errno, activeChannels);
+}
+
+Timestamp PollPoller::finishPoll(int numEvents, int savedErrno,
+                                 ChannelList *activeChannels) const {
   const Timestamp now(Timestamp::now());
 
   if (numEvents > 0) {
@@ -46,10 +61,8 @@ void PollPoller::fillActiveChannels(int numEvents,
 
     --numEvents;
     const int fd = pfd.fd >= 0 ? pfd.fd : -pfd.fd - 1;
-    const auto it = channels_.find(fd);
-    assert(it != channels_.end());
-
-    auto *channel = it->second;
+    auto *channel = channels_.find(fd);
+    assert(channel != nullptr);
     channel->setRevents(pfd.revents);
     activeChannels->push_back(channel);
   }
@@ -70,12 +83,11 @@ void PollPoller::updateChannel(Channel *channel) {
 
     const int idx = static_cast<int>(pollfds_.size()) - 1;
     channel->setIndex(idx);
-    channels_[pfd.fd] = channel;
+    channels_.insert(pfd.fd, channel);
     return;
   }
 
-  assert(channels_.contains(channel->fd()));
-  assert(channels_[channel->fd()] == channel);
+  assert(channels_.find(channel->fd()) == channel);
 
   const int idx = channel->index();
   assert(idx >= 0 && static_cast<size_t>(idx) < pollfds_.size());
@@ -95,8 +107,7 @@ void PollPoller::removeChannel(Channel *channel) {
   Poller::assertInLoopThread();
   muduo::logTrace("fd = {}", channel->fd());
 
-  assert(channels_.contains(channel->fd()));
-  assert(channels_[channel->fd()] == channel);
+  assert(channels_.find(channel->fd()) == channel);
   assert(channel->isNoneEvent());
 
   const int idx = channel->index();
@@ -120,6 +131,6 @@ void PollPoller::removeChannel(Channel *channel) {
   if (channelAtEnd < 0) {
     channelAtEnd = -channelAtEnd - 1;
   }
-  channels_[channelAtEnd]->setIndex(idx);
+  channels_.find(channelAtEnd)->setIndex(idx);
   pollfds_.pop_back();
 }
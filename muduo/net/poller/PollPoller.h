@@ -15,10 +15,15 @@ public:
 
   [[nodiscard]] Timestamp poll(int timeoutMs,
                                ChannelList *activeChannels) override;
+  // ppoll(), for sub-millisecond timeouts.
+  [[nodiscard]] Timestamp pollFor(std::chrono::nanoseconds timeout,
+                                  ChannelList *activeChannels) override;
   void updateChannel(Channel *channel) override;
   void removeChannel(Channel *channel) override;
 
 private:
+  [[nodiscard]] Timestamp finishPoll(int numEvents, int savedErrno,
+                                     ChannelList *activeChannels) const;
   void fillActiveChannels(int numEvents, ChannelList *activeChannels) const;
 
   using PollFdList = std::vector<struct pollfd>;
@@ -34,7 +34,7 @@ void ProtobufCodecLite::send(const TcpConnectionPtr &conn,
                              const ::google::protobuf::Message &message) {
   Buffer buf;
   fillEmptyBuffer(&buf, message);
-  conn->send(&buf);
+  conn->send(std::move(buf));
 }
 
 void ProtobufCodecLite::fillEmptyBuffer(
@@ -0,0 +1,286 @@
+#include "muduo/base/Logging.h"
+#include "muduo/net/ByteSlice.h"
+#include "muduo/net/EventLoop.h"
+#include "muduo/net/EventLoopThread.h"
+#include "muduo/net/InetAddress.h"
+#include "muduo/net/TcpServer.h"
+
+#include <benchmark/benchmark.h>
+
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+using namespace std::chrono_literals;
+
+constexpr int kIoThreads = 4;
+
+// Asks the kernel for a free port: with this many client sockets a fixed
+// range would collide with their ephemeral ports.
+uint16_t pickPort() {
+  const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  uint16_t port = 0;
+  if (::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0 &&
+      ::getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len) == 0) {
+    port = ntohs(addr.sin_port);
+  }
+  ::close(fd);
+  return port;
+}
+
+void quietOutput(const char *, int) {}
+void quietFlush() {}
+
+void prepareBenchLogging() {
+  static std::once_flag once;
+  std::call_once(once, [] {
+    muduo::Logger::setLogLevel(muduo::Logger::LogLevel::ERROR);
+    muduo::Logger::setOutput(&quietOutput);
+    muduo::Logger::setFlush(&quietFlush);
+  });
+}
+
+// A server spread over kIoThreads loops that only keeps its connections.
+class FanOutServerHarness {
+public:
+  FanOutServerHarness(uint16_t port, size_t expectedConnections)
+      : loopThread_({}, "FanOutBenchLoop"), port_(port),
+        expected_(expectedConnections) {
+    loop_ = loopThread_.startLoop();
+    loop_->runInLoop([this] {
+      server_ = std::make_unique<muduo::net::TcpServer>(
+          loop_, muduo::net::InetAddress(port_, true), "FanOutBench");
+      server_->setThreadNum(kIoThreads);
+      server_->setConnectionCallback(
+          [this](const muduo::net::TcpConnectionPtr &conn) {
+            if (!conn->connected()) {
+              return;
+            }
+            {
+              std::scoped_lock lock(mutex_);
+              connections_.push_back(conn);
+            }
+            cv_.notify_one();
+          });
+      server_->start();
+      {
+        std::scoped_lock lock(mutex_);
+        started_ = true;
+      }
+      cv_.notify_one();
+    });
+
+    std::unique_lock lock(mutex_);
+    (void)cv_.wait_for(lock, 2s, [this] { return started_; });
+  }
+
+  ~FanOutServerHarness() {
+    std::mutex doneMutex;
+    std::condition_variable doneCv;
+    bool done = false;
+    loop_->runInLoop([this, &doneMutex, &doneCv, &done] {
+      server_.reset();
+      loop_->quit();
+      {
+        std::scoped_lock lock(doneMutex);
+        done = true;
+      }
+      doneCv.notify_one();
+    });
+    std::unique_lock lock(doneMutex);
+    (void)doneCv.wait_for(lock, 5s, [&done] { return done; });
+  }
+
+  // Empty if not everyone connected in time.
+  [[nodiscard]] std::vector<muduo::net::TcpConnectionPtr> waitForConnections() {
+    std::unique_lock lock(mutex_);
+    if (!cv_.wait_for(lock, 5s,
+                      [this] { return connections_.size() == expected_; })) {
+      return {};
+    }
+    return connections_;
+  }
+
+  // Waits for the server to let go of every connection, so that none is
+  // left for its teardown to race with.
+  void waitForClosed() {
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    std::scoped_lock lock(mutex_);
+    for (const auto &conn : connections_) {
+      while (conn.use_count() > 1 &&
+             std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+      }
+    }
+    connections_.clear();
+  }
+
+private:
+  muduo::net::EventLoopThread loopThread_;
+  muduo::net::EventLoop *loop_{nullptr};
+  uint16_t port_;
+  size_t expected_;
+  std::unique_ptr<muduo::net::TcpServer> server_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool started_{false};
+  std::vector<muduo::net::TcpConnectionPtr> connections_;
+};
+
+// Subscribers: one thread drains all client sockets and counts the bytes.
+class Subscribers {
+public:
+  Subscribers(uint16_t port, size_t count) : epollFd_(::epoll_create1(0)) {
+    for (size_t i = 0; i < count; ++i) {
+      const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+      sockaddr_in addr{};
+      addr.sin_family = AF_INET;
+      addr.sin_port = htons(port);
+      (void)::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+      if (fd < 0 ||
+          ::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) !=
+              0) {
+        if (fd >= 0) {
+          ::close(fd);
+        }
+        continue;
+      }
+      epoll_event event{};
+      event.events = EPOLLIN;
+      event.data.fd = fd;
+      (void)::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event);
+      fds_.push_back(fd);
+    }
+    reader_ = std::thread([this] { readLoop(); });
+  }
+
+  ~Subscribers() {
+    stop_.store(true, std::memory_order_release);
+    reader_.join();
+    for (const int fd : fds_) {
+      ::close(fd);
+    }
+    ::close(epollFd_);
+  }
+
+  [[nodiscard]] bool ok(size_t count) const { return fds_.size() == count; }
+
+  // Waits until the subscribers have read total bytes altogether.
+  [[nodiscard]] bool waitFor(uint64_t total) const {
+    const auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (received_.load(std::memory_order_acquire) < total) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+    return true;
+  }
+
+private:
+  void readLoop() {
+    std::array<epoll_event, 256> events{};
+    std::vector<char> buf(256 * 1024);
+    while (!stop_.load(std::memory_order_acquire)) {
+      const int n = ::epoll_wait(epollFd_, events.data(),
+                                 static_cast<int>(events.size()), 10);
+      for (int i = 0; i < n; ++i) {
+        const ssize_t nread =
+            ::read(events[static_cast<size_t>(i)].data.fd, buf.data(),
+                   buf.size());
+        if (nread > 0) {
+          received_.fetch_add(static_cast<uint64_t>(nread),
+                              std::memory_order_release);
+        }
+      }
+    }
+  }
+
+  int epollFd_;
+  std::vector<int> fds_;
+  std::atomic<uint64_t> received_{0};
+  std::atomic<bool> stop_{false};
+  std::thread reader_;
+};
+
+// Sends one payload to every connection from outside the I/O loops, either
+// as one shared ByteSlice or as a copy per connection, the way a pub/sub
+// update is broadcast.
+static void BM_FanOut(benchmark::State &state, bool shared) {
+  prepareBenchLogging();
+
+  const auto connections = static_cast<size_t>(state.range(0));
+  const auto payloadSize = static_cast<size_t>(state.range(1));
+  const uint16_t port = pickPort();
+  FanOutServerHarness server(port, connections);
+  auto subscribers = std::make_unique<Subscribers>(port, connections);
+  auto conns = server.waitForConnections();
+  const auto teardown = [&] {
+    conns.clear();
+    subscribers.reset();
+    server.waitForClosed();
+  };
+  if (!subscribers->ok(connections) || conns.empty()) {
+    state.SkipWithError("subscribers failed to connect");
+    teardown();
+    return;
+  }
+
+  const std::string payload(payloadSize, 'x');
+  uint64_t sent = 0;
+  for (auto _ : state) {
+    if (shared) {
+      const auto slice = muduo::net::ByteSlice::copyOf(payload);
+      for (const auto &conn : conns) {
+        conn->send(slice);
+      }
+    } else {
+      for (const auto &conn : conns) {
+        conn->send(std::string_view{payload});
+      }
+    }
+    sent += connections * payloadSize;
+    if (!subscribers->waitFor(sent)) {
+      state.SkipWithError("subscribers stalled");
+      break;
+    }
+  }
+
+  teardown();
+
+  state.SetBytesProcessed(static_cast<int64_t>(sent));
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(connections));
+  // Payload bytes copied by send() per update.
+  state.counters["copied_per_update"] = static_cast<double>(
+      (shared ? 1 : connections) * payloadSize);
+}
+
+BENCHMARK_CAPTURE(BM_FanOut, shared, true)
+    ->ArgsProduct({{64, 256, 1024}, {4 << 10, 64 << 10}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_CAPTURE(BM_FanOut, copy, false)
+    ->ArgsProduct({{64, 256, 1024}, {4 << 10, 64 << 10}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+} // namespace
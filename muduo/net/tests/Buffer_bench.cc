@@ -0,0 +1,149 @@
+#include "muduo/net/Buffer.h"
+#include "muduo/net/ByteScan.h"
+#include "muduo/net/SegmentedBuffer.h"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using muduo::net::Buffer;
+using muduo::net::SegmentedBuffer;
+namespace scan = muduo::net::scan;
+
+// An output queue backing up: chunks are appended while the socket drains a
+// fraction of them, until state.range(0) bytes are queued, then it drains.
+// Buffer pays for every realloc and memmove of the backlog along the way.
+template <typename Queue> void BM_OutputBacklog(benchmark::State &state) {
+  const auto backlog = static_cast<size_t>(state.range(0));
+  constexpr size_t kChunk = 16 * 1024;
+  constexpr size_t kDrained = 4 * 1024;
+  const std::vector<std::byte> chunk(kChunk, std::byte{'x'});
+
+  for (auto _ : state) {
+    Queue queue;
+    while (queue.readableBytes() < backlog) {
+      queue.append(chunk);
+      queue.retrieve(kDrained);
+    }
+    benchmark::DoNotOptimize(queue.peek());
+    queue.retrieveAll();
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(backlog * kChunk /
+                                               (kChunk - kDrained)));
+}
+
+BENCHMARK_TEMPLATE(BM_OutputBacklog, Buffer)
+    ->RangeMultiplier(4)
+    ->Range(256 << 10, 16 << 20);
+BENCHMARK_TEMPLATE(BM_OutputBacklog, SegmentedBuffer)
+    ->RangeMultiplier(4)
+    ->Range(256 << 10, 16 << 20);
+
+// A request head of state.range(0) header lines of about 40 bytes each.
+std::string requestHead(size_t lines) {
+  std::string head = "GET /index.html HTTP/1.1\r\n";
+  for (size_t i = 0; i < lines; ++i) {
+    head += "X-Header-" + std::to_string(i) + ": " +
+            std::string(24, 'v') + "\r\n";
+  }
+  head += "\r\n";
+  return head;
+}
+
+// Runs the benchmark on kernel, or skips it where the CPU lacks it.
+bool useKernel(benchmark::State &state, scan::Kernel kernel) {
+  if (!scan::setKernel(kernel)) {
+    state.SkipWithError("kernel not supported here");
+    return false;
+  }
+  state.SetLabel(scan::kernelName(kernel));
+  return true;
+}
+
+// A line of state.range(0) bytes with its CRLF at the end, the way a long
+// header or a RESP bulk string is found.
+void BM_FindCRLF(benchmark::State &state, scan::Kernel kernel) {
+  if (!useKernel(state, kernel)) {
+    return;
+  }
+  const auto len = static_cast<size_t>(state.range(0));
+  Buffer buf;
+  buf.append(std::string_view{std::string(len, 'x') + "\r\n"});
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(buf.findCRLF());
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(len + 2));
+}
+
+void BM_FindEOL(benchmark::State &state, scan::Kernel kernel) {
+  if (!useKernel(state, kernel)) {
+    return;
+  }
+  const auto len = static_cast<size_t>(state.range(0));
+  Buffer buf;
+  buf.append(std::string_view{std::string(len, 'x') + "\n"});
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(buf.findEOL());
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(len + 1));
+}
+
+// Splits a request head into lines the way HttpContext does, one findCRLF()
+// from the end of the previous line...
+void BM_SplitLines(benchmark::State &state, scan::Kernel kernel) {
+  if (!useKernel(state, kernel)) {
+    return;
+  }
+  const std::string head = requestHead(static_cast<size_t>(state.range(0)));
+  Buffer buf;
+  buf.append(std::string_view{head});
+  for (auto _ : state) {
+    size_t lines = 0;
+    for (const std::byte *crlf = buf.findCRLF(); crlf != nullptr;
+         crlf = buf.findCRLF(crlf + 2)) {
+      ++lines;
+    }
+    benchmark::DoNotOptimize(lines);
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(head.size()));
+}
+
+// ...and with one findAllCRLF() pass.
+void BM_FindAllCRLF(benchmark::State &state, scan::Kernel kernel) {
+  if (!useKernel(state, kernel)) {
+    return;
+  }
+  const std::string head = requestHead(static_cast<size_t>(state.range(0)));
+  Buffer buf;
+  buf.append(std::string_view{head});
+  std::array<size_t, 256> offsets{};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(buf.findAllCRLF(offsets));
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(head.size()));
+}
+
+#define MUDUO_SCAN_BENCHMARK(func, ...)                                        \
+  BENCHMARK_CAPTURE(func, scalar, scan::Kernel::kScalar)->__VA_ARGS__;         \
+  BENCHMARK_CAPTURE(func, sse2, scan::Kernel::kSse2)->__VA_ARGS__;             \
+  BENCHMARK_CAPTURE(func, avx2, scan::Kernel::kAvx2)->__VA_ARGS__;             \
+  BENCHMARK_CAPTURE(func, neon, scan::Kernel::kNeon)->__VA_ARGS__
+
+MUDUO_SCAN_BENCHMARK(BM_FindCRLF, RangeMultiplier(8)->Range(16, 64 << 10));
+MUDUO_SCAN_BENCHMARK(BM_FindEOL, RangeMultiplier(8)->Range(16, 64 << 10));
+MUDUO_SCAN_BENCHMARK(BM_SplitLines, Arg(8)->Arg(32)->Arg(128));
+MUDUO_SCAN_BENCHMARK(BM_FindAllCRLF, Arg(8)->Arg(32)->Arg(128));
+
+} // namespace
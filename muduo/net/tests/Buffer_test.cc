@@ -1,4 +1,5 @@
 #include "muduo/net/Buffer.h"
+#include "muduo/net/ByteScan.h"
 
 #include <gtest/gtest.h>
 
@@ -243,3 +244,77 @@ TEST(BufferTest, CharViewHelpersForTextProtocols) {
   buf.retrieveUntil(crlf + 2);
   EXPECT_EQ(buf.readableChars().substr(0, 7), "Host: x");
 }
+
+TEST(BufferTest, FindAllCrLfScansOnce) {
+  Buffer buf;
+  buf.append("GET / HTTP/1.1\r\nHost: x\r\nAccept: */*\r\n\r\nbody"sv);
+
+  std::array<size_t, 8> offsets{};
+  ASSERT_EQ(buf.findAllCRLF(offsets), 4u);
+  EXPECT_EQ(offsets[0], 14u);
+  EXPECT_EQ(offsets[1], 23u);
+  EXPECT_EQ(offsets[2], 36u);
+  EXPECT_EQ(offsets[3], 38u);
+
+  // A full span stops the scan; resuming from start keeps peek() offsets.
+  std::array<size_t, 2> firstTwo{};
+  ASSERT_EQ(buf.findAllCRLF(firstTwo), 2u);
+  std::array<size_t, 8> rest{};
+  ASSERT_EQ(buf.findAllCRLF(rest, buf.peek() + firstTwo[1] + 2), 2u);
+  EXPECT_EQ(rest[0], 36u);
+  EXPECT_EQ(rest[1], 38u);
+}
+
+// Each kernel agrees with the scalar one on every delimiter position around
+// its block sizes, including CRLFs split across two blocks.
+TEST(BufferTest, ScanKernelsMatchScalar) {
+  namespace scan = muduo::net::scan;
+  const scan::Kernel detected = scan::kernel();
+
+  for (const auto kernel : {scan::Kernel::kScalar, scan::Kernel::kSse2,
+                            scan::Kernel::kAvx2, scan::Kernel::kNeon}) {
+    if (!scan::setKernel(kernel)) {
+      continue;
+    }
+    SCOPED_TRACE(scan::kernelName(kernel));
+    for (size_t len = 0; len <= 100; ++len) {
+      for (size_t pos = 0; pos + 1 < len; ++pos) {
+        std::string text(len, 'a');
+        text[pos] = '\r';
+        text[pos + 1] = '\n';
+        // Lone halves must not match.
+        if (pos >= 2) {
+          text[pos - 2] = '\r';
+        }
+        if (pos + 3 < len) {
+          text[pos + 3] = '\n';
+        }
+        Buffer buf;
+        buf.append(std::string_view{text});
+
+        ASSERT_EQ(buf.findCRLF(), buf.peek() + pos) << len << ' ' << pos;
+        ASSERT_EQ(buf.findEOL(), buf.peek() + pos + 1) << len << ' ' << pos;
+        std::array<size_t, 4> offsets{};
+        ASSERT_EQ(buf.findAllCRLF(offsets), 1u) << len << ' ' << pos;
+        ASSERT_EQ(offsets[0], pos);
+      }
+    }
+
+    std::string lines;
+    for (int i = 0; i < 50; ++i) {
+      lines += std::string(static_cast<size_t>(i % 37), 'h') + "\r\n";
+    }
+    Buffer buf;
+    buf.append(std::string_view{lines});
+    std::array<size_t, 64> offsets{};
+    ASSERT_EQ(buf.findAllCRLF(offsets), 50u);
+    size_t expected = 0;
+    for (size_t i = 0; i < 50; ++i) {
+      expected += i % 37;
+      ASSERT_EQ(offsets[i], expected);
+      expected += 2;
+    }
+  }
+
+  ASSERT_TRUE(scan::setKernel(detected));
+}
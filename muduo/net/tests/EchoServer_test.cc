@@ -1,23 +1,38 @@
 #include "muduo/net/TcpServer.h"
 
+#include "muduo/net/BufferPool.h"
+#include "muduo/net/ByteSlice.h"
 #include "muduo/net/EventLoop.h"
+#include "muduo/net/EventLoopThreadPool.h"
 #include "muduo/net/InetAddress.h"
 #include "muduo/net/SocketsOps.h"
+#include "muduo/net/poller/IoUringPoller.h"
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cerrno>
 #include <chrono>
+#include <cstdint>
 #include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <span>
 #include <string>
 #include <string_view>
 #include <thread>
 #include <tuple>
+#include <vector>
 
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <sched.h>
 #include <sys/socket.h>
+#include <sys/time.h>
 #include <unistd.h>
 
 namespace {
@@ -71,6 +86,14 @@ public:
     server_.setConnectionCallback(
         [this](const muduo::net::TcpConnectionPtr &conn) {
           if (conn->connected()) {
+            completionConnections_.fetch_add(conn->ioUringCompletion() ? 1 : 0,
+                                             std::memory_order_relaxed);
+            edgeTriggeredConnections_.fetch_add(conn->edgeTriggered() ? 1 : 0,
+                                                std::memory_order_relaxed);
+            segmentedConnections_.fetch_add(conn->segmentedOutput() ? 1 : 0,
+                                            std::memory_order_relaxed);
+            deferredConnections_.fetch_add(conn->deferredFlush() ? 1 : 0,
+                                           std::memory_order_relaxed);
             conn->send("hello\n"sv);
           }
         });
@@ -90,11 +113,37 @@ public:
     server_.setThreadNum(threadNum);
   }
 
+  void setIoUringCompletion(bool on) { server_.setIoUringCompletion(on); }
+  void setEdgeTriggered(bool on) { server_.setEdgeTriggered(on); }
+  void setSegmentedOutput(bool on) { server_.setSegmentedOutput(on); }
+  void setDeferredFlush(bool on) {
+    server_.setDeferredFlush(on);
+    server_.setCorkedWrites(on);
+  }
+  void setBufferIdleTimeout(std::chrono::microseconds timeout) {
+    server_.setBufferIdleTimeout(timeout);
+  }
   void start() { server_.start(); }
+  [[nodiscard]] int completionConnections() const {
+    return completionConnections_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] int edgeTriggeredConnections() const {
+    return edgeTriggeredConnections_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] int segmentedConnections() const {
+    return segmentedConnections_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] int deferredConnections() const {
+    return deferredConnections_.load(std::memory_order_relaxed);
+  }
 
 private:
   muduo::net::EventLoop *loop_;
   muduo::net::TcpServer server_;
+  std::atomic<int> completionConnections_{0};
+  std::atomic<int> edgeTriggeredConnections_{0};
+  std::atomic<int> segmentedConnections_{0};
+  std::atomic<int> deferredConnections_{0};
 };
 
 class EchoServerTest : public ::testing::Test {};
@@ -213,6 +262,129 @@ bool runEchoClientV6(int port, std::atomic<bool> &gotHello) {
   return writeOk;
 }
 
+// Connects to the server on the loopback port, retrying while it does not
+// listen yet: sharded listeners come up on their own loops. Reads time out
+// after 5 s instead of hanging; rcvBuf > 0 sets SO_RCVBUF before the
+// connect. Returns -1 on failure.
+int connectClient(int port, int rcvBuf = 0) {
+  using namespace std::chrono_literals;
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<uint16_t>(port));
+  (void)::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  const auto deadline = std::chrono::steady_clock::now() + 5s;
+  while (true) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+      return -1;
+    }
+    if (rcvBuf > 0) {
+      (void)::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvBuf, sizeof(rcvBuf));
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) ==
+        0) {
+      timeval timeout{5, 0};
+      (void)::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+                         sizeof(timeout));
+      return fd;
+    }
+    const int savedErrno = errno;
+    ::close(fd);
+    if (savedErrno != ECONNREFUSED ||
+        std::chrono::steady_clock::now() >= deadline) {
+      return -1;
+    }
+    std::this_thread::sleep_for(1ms);
+  }
+}
+
+// Appends what arrives on fd to out until it holds total bytes; false if the
+// peer closed or a read timed out first.
+bool receiveInto(int fd, size_t total, std::string &out) {
+  std::array<char, 65536> buf{};
+  while (out.size() < total) {
+    const auto n = readSome(fd, buf);
+    if (n <= 0) {
+      return false;
+    }
+    out.append(buf.data(), static_cast<size_t>(n));
+  }
+  return true;
+}
+
+// Connects, reads total bytes and closes.
+std::string receiveAll(int port, size_t total, int rcvBuf = 0) {
+  std::string received;
+  const int fd = connectClient(port, rcvBuf);
+  if (fd >= 0) {
+    (void)receiveInto(fd, total, received);
+    ::close(fd);
+  }
+  return received;
+}
+
+// Writes "ping" on fd; whether the server echoed it back.
+bool pingEchoed(int fd) {
+  std::array<char, 4> buf{};
+  return writeExact(fd, "ping") && readSome(fd, buf) == 4 &&
+         std::string_view{buf.data(), buf.size()} == "ping";
+}
+
+// Runs loop while client runs on its own thread, until a server callback
+// quits it or the watchdog fires. The server is started, so it listens
+// before the client connects.
+template <typename Client>
+void runLoopWithClient(muduo::net::EventLoop &loop, Client &&client,
+                       std::chrono::milliseconds watchdog =
+                           std::chrono::seconds(5)) {
+  std::thread thread(std::forward<Client>(client));
+  (void)loop.runAfter(watchdog, [&loop] { loop.quit(); });
+  loop.loop();
+  thread.join();
+}
+
+bool runBulkEchoClient(int port, size_t payloadSize,
+                       std::chrono::milliseconds idleBeforeQuit = {}) {
+  const int fd = connectClient(port);
+  if (fd < 0) {
+    return false;
+  }
+
+  std::string payload(payloadSize, 'x');
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<char>('a' + i % 26);
+  }
+  const std::string expected = "hello\n" + payload;
+
+  // Interleave writes and reads so neither side's socket buffer fills up.
+  std::string received;
+  std::array<char, 16384> buf{};
+  size_t written = 0;
+  bool ok = true;
+  while (ok && received.size() < expected.size()) {
+    if (written < payload.size()) {
+      const size_t chunk = std::min<size_t>(payload.size() - written, 8192);
+      ok = writeExact(fd, std::string_view{payload}.substr(written, chunk));
+      written += chunk;
+    }
+    while (ok && received.size() < 6 + written) {
+      const auto n = readSome(fd, buf);
+      if (n <= 0) {
+        ok = false;
+        break;
+      }
+      received.append(buf.data(), static_cast<size_t>(n));
+    }
+  }
+
+  ok = ok && received == expected;
+  std::this_thread::sleep_for(idleBeforeQuit);
+  ok = ok && writeExact(fd, "quit\n");
+  ::close(fd);
+  return ok;
+}
+
 void runEchoServerCase(bool ipv6, int threadNum) {
   using namespace std::chrono_literals;
 
@@ -275,3 +447,965 @@ TEST_F(EchoServerTest, ExitCommandSendsByeAndShutdown) {
   ASSERT_TRUE(clientOk.load(std::memory_order_acquire));
   EXPECT_TRUE(gotBye.load(std::memory_order_acquire));
 }
+
+namespace {
+
+// One server configuration run through the bulk-echo and exit cases.
+struct EchoMode {
+  const char *name;
+  muduo::net::PollerBackend backend;
+  int threadNum;
+  // Large enough to span the mode's read budget and fill the socket buffers.
+  size_t bulkSize;
+  std::function<void(EchoServer &)> configure;
+  // Connections that came up in the mode under test.
+  std::function<int(const EchoServer &)> connectionsInMode;
+};
+
+void PrintTo(const EchoMode &mode, std::ostream *os) { *os << mode.name; }
+
+class EchoServerModeTest : public ::testing::TestWithParam<EchoMode> {
+protected:
+  void SetUp() override {
+    if (GetParam().backend == muduo::net::PollerBackend::kIoUring &&
+        !muduo::net::IoUringPoller::isSupported()) {
+      GTEST_SKIP() << "io_uring unavailable";
+    }
+  }
+
+  // Runs the loop until the client is done; the server listens before the
+  // client thread starts, so it connects without waiting.
+  template <typename Client>
+  void runWithClient(EchoServer &server, muduo::net::EventLoop &loop,
+                     int port, Client client) {
+    using namespace std::chrono_literals;
+
+    GetParam().configure(server);
+    server.start();
+    runLoopWithClient(
+        loop,
+        [&] {
+          client(port);
+          loop.queueInLoop([&loop] { loop.quit(); });
+        },
+        10s);
+  }
+};
+
+} // namespace
+
+TEST_P(EchoServerModeTest, BulkEcho) {
+  const EchoMode &mode = GetParam();
+  const int port = pickPort(false);
+  ASSERT_GT(port, 0);
+  muduo::net::EventLoop loop(mode.backend);
+  muduo::net::InetAddress listenAddr(static_cast<uint16_t>(port), true, false);
+  EchoServer server(&loop, listenAddr, mode.threadNum);
+
+  bool clientOk = false;
+  runWithClient(server, loop, port, [&](int p) {
+    clientOk = runBulkEchoClient(p, mode.bulkSize);
+  });
+
+  EXPECT_TRUE(clientOk);
+  EXPECT_EQ(mode.connectionsInMode(server), 1);
+}
+
+// "bye" and the echoed "exit" are queued before shutdown(); the write side
+// closes only after both have been sent.
+TEST_P(EchoServerModeTest, ExitShutsDownAfterSend) {
+  const EchoMode &mode = GetParam();
+  const int port = pickPort(false);
+  ASSERT_GT(port, 0);
+  muduo::net::EventLoop loop(mode.backend);
+  muduo::net::InetAddress listenAddr(static_cast<uint16_t>(port), true, false);
+  EchoServer server(&loop, listenAddr, mode.threadNum);
+
+  std::atomic<bool> gotBye{false};
+  bool clientOk = false;
+  runWithClient(server, loop, port, [&](int p) {
+    clientOk = runEchoClientV4Exit(p, gotBye);
+  });
+
+  ASSERT_TRUE(clientOk);
+  EXPECT_TRUE(gotBye.load(std::memory_order_acquire));
+  EXPECT_EQ(mode.connectionsInMode(server), 1);
+}
+
+namespace {
+
+std::string modeName(const ::testing::TestParamInfo<EchoMode> &info) {
+  return info.param.name;
+}
+
+EchoMode ioUringMode(const char *name, int threadNum) {
+  return {name, muduo::net::PollerBackend::kIoUring, threadNum, 1024 * 1024,
+          [](EchoServer &server) { server.setIoUringCompletion(true); },
+          [](const EchoServer &server) {
+            return server.completionConnections();
+          }};
+}
+
+EchoMode edgeTriggeredMode(const char *name, int threadNum) {
+  return {name, muduo::net::PollerBackend::kEPoll, threadNum, 4 * 1024 * 1024,
+          [](EchoServer &server) { server.setEdgeTriggered(true); },
+          [](const EchoServer &server) {
+            return server.edgeTriggeredConnections();
+          }};
+}
+
+EchoMode segmentedMode(const char *name, bool edgeTriggered) {
+  return {name, muduo::net::PollerBackend::kEPoll, 0, 4 * 1024 * 1024,
+          [edgeTriggered](EchoServer &server) {
+            server.setSegmentedOutput(true);
+            server.setEdgeTriggered(edgeTriggered);
+          },
+          [](const EchoServer &server) {
+            return server.segmentedConnections();
+          }};
+}
+
+EchoMode deferredFlushMode(const char *name, bool edgeTriggered) {
+  return {name, muduo::net::PollerBackend::kEPoll, 0, 4 * 1024 * 1024,
+          [edgeTriggered](EchoServer &server) {
+            server.setDeferredFlush(true);
+            server.setEdgeTriggered(edgeTriggered);
+          },
+          [](const EchoServer &server) {
+            return server.deferredConnections();
+          }};
+}
+
+} // namespace
+
+INSTANTIATE_TEST_SUITE_P(IoUring, EchoServerModeTest,
+                         ::testing::Values(ioUringMode("InLoop", 0),
+                                           ioUringMode("Threads", 2)),
+                         modeName);
+INSTANTIATE_TEST_SUITE_P(EdgeTriggered, EchoServerModeTest,
+                         ::testing::Values(edgeTriggeredMode("InLoop", 0),
+                                           edgeTriggeredMode("Threads", 2)),
+                         modeName);
+INSTANTIATE_TEST_SUITE_P(
+    SegmentedOutput, EchoServerModeTest,
+    ::testing::Values(segmentedMode("LevelTriggered", false),
+                      segmentedMode("EdgeTriggered", true)),
+    modeName);
+INSTANTIATE_TEST_SUITE_P(
+    DeferredFlush, EchoServerModeTest,
+    ::testing::Values(deferredFlushMode("LevelTriggered", false),
+                      deferredFlushMode("EdgeTriggered", true)),
+    modeName);
+
+// Parameter: segmented output.
+class EchoServerBufferIdleTest : public ::testing::TestWithParam<bool> {};
+
+TEST_P(EchoServerBufferIdleTest, IdleConnectionGivesBufferMemoryBack) {
+  using namespace std::chrono_literals;
+
+  const int port = pickPort(false);
+  ASSERT_GT(port, 0);
+  muduo::net::EventLoop loop(muduo::net::PollerBackend::kEPoll);
+  muduo::net::InetAddress listenAddr(static_cast<uint16_t>(port), true, false);
+  EchoServer server(&loop, listenAddr, 0);
+  server.setSegmentedOutput(GetParam());
+  server.setBufferIdleTimeout(50ms);
+  server.start();
+
+  auto *pool = loop.bufferPool();
+  muduo::net::BufferPool::Stats idle;
+  (void)loop.runEvery(20ms, [&] {
+    if (const auto stats = pool->stats(); stats.idleConnections > 0) {
+      idle = stats;
+    }
+  });
+  // The client's "quit" stops the loop once it has idled.
+  bool clientOk = false;
+  runLoopWithClient(loop, [&] {
+    clientOk = runBulkEchoClient(port, 1024 * 1024, 500ms);
+  });
+
+  EXPECT_TRUE(clientOk);
+  EXPECT_EQ(idle.idleConnections, 1);
+  // Both contiguous buffers down to their prepend area; segmented output
+  // holds nothing once drained.
+  constexpr auto kReleased =
+      static_cast<std::int64_t>(muduo::net::Buffer::kCheapPrepend);
+  EXPECT_LE(idle.bytesPerIdleConnection(), 2 * kReleased);
+  EXPECT_GT(idle.bytesPerIdleConnection(), 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(SegmentedOutput, EchoServerBufferIdleTest,
+                         ::testing::Bool());
+
+// The contiguous buffers hold nothing until the first read or send.
+TEST(EchoServerBufferTest, NewConnectionReservesNoBufferSpace) {
+  const int port = pickPort(false);
+  ASSERT_GT(port, 0);
+  muduo::net::EventLoop loop(muduo::net::PollerBackend::kEPoll);
+  muduo::net::InetAddress listenAddr(static_cast<uint16_t>(port), true, false);
+  muduo::net::TcpServer server(&loop, listenAddr, "BufferTest");
+
+  size_t capacity = 0;
+  server.setConnectionCallback([&](const muduo::net::TcpConnectionPtr &conn) {
+    if (!conn->connected()) {
+      loop.quit();
+      return;
+    }
+    capacity = conn->inputBuffer()->internalCapacity() +
+               conn->outputBuffer()->internalCapacity();
+    conn->shutdown();
+  });
+  server.start();
+
+  runLoopWithClient(loop, [port] {
+    const int fd = connectClient(port);
+    if (fd >= 0) {
+      std::array<char, 1> buf{};
+      (void)readSome(fd, buf);
+      ::close(fd);
+    }
+  });
+
+  EXPECT_EQ(capacity, 2 * muduo::net::Buffer::kCheapPrepend);
+}
+
+enum class OwnedSend : std::uint8_t { kSlice, kString, kBytes, kBuffer };
+
+class OwnedSendTest : public ::testing::TestWithParam<OwnedSend> {};
+
+// The client's receive window is small, so most of the payload has to queue.
+TEST_P(OwnedSendTest, LargePayloadArrivesIntact) {
+  const int port = pickPort(false);
+  ASSERT_GT(port, 0);
+  muduo::net::EventLoop loop(muduo::net::PollerBackend::kEPoll);
+  muduo::net::InetAddress listenAddr(static_cast<uint16_t>(port), true, false);
+  muduo::net::TcpServer server(&loop, listenAddr, "OwnedSendTest");
+
+  constexpr size_t kPayload = 8 * 1024 * 1024;
+  constexpr int kClientRcvBuf = 64 * 1024;
+  std::string payload(kPayload, '\0');
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<char>('a' + i % 26);
+  }
+  auto slice = muduo::net::ByteSlice::copyOf(payload);
+  long sharedWhileQueued = 0;
+  long sharedWhenDone = 0;
+
+  server.setConnectionCallback([&](const muduo::net::TcpConnectionPtr &conn) {
+    if (!conn->connected()) {
+      loop.quit();
+      return;
+    }
+    switch (GetParam()) {
+    case OwnedSend::kSlice:
+      conn->send(slice);
+      sharedWhileQueued = slice.useCount();
+      break;
+    case OwnedSend::kString:
+      conn->send(std::string{payload});
+      break;
+    case OwnedSend::kBytes: {
+      const auto bytes = std::as_bytes(std::span{payload});
+      conn->send(std::vector<std::byte>(bytes.begin(), bytes.end()));
+      break;
+    }
+    case OwnedSend::kBuffer: {
+      muduo::net::Buffer buffer;
+      buffer.append(std::string_view{payload});
+      conn->send(std::move(buffer));
+      EXPECT_EQ(buffer.readableBytes(), 0);
+      break;
+    }
+    }
+  });
+  server.setWriteCompleteCallback([&](const muduo::net::TcpConnectionPtr &) {
+    sharedWhenDone = slice.useCount();
+  });
+  server.start();
+
+  std::string received;
+  runLoopWithClient(loop, [&] {
+    received = receiveAll(port, kPayload, kClientRcvBuf);
+  });
+
+  EXPECT_TRUE(received == payload);
+  if (GetParam() == OwnedSend::kSlice) {
+    // Queued by reference, and let go of once written.
+    EXPECT_GT(sharedWhileQueued, 1);
+    EXPECT_EQ(sharedWhenDone, 1);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Kinds, OwnedSendTest,
+                         ::testing::Values(OwnedSend::kSlice,
+                                           OwnedSend::kString,
+                                           OwnedSend::kBytes,
+                                           OwnedSend::kBuffer));
+
+// Each message completes on its own once its last part has been written,
+// while the connection's write-complete callback waits for all of them. A
+// filler larger than the socket can hold goes first, so every message is
+// queued behind it and the output drains exactly once.
+TEST(GatherSendTest, MessagesCompleteInOrder) {
+  const int port = pickPort(false);
+  ASSERT_GT(port, 0);
+  muduo::net::EventLoop loop(muduo::net::PollerBackend::kEPoll);
+  muduo::net::InetAddress listenAddr(static_cast<uint16_t>(port), true, false);
+  muduo::net::TcpServer server(&loop, listenAddr, "GatherSendTest");
+
+  constexpr int kMessages = 3;
+  constexpr size_t kBody = 2 * 1024 * 1024;
+  constexpr auto kHeader = "header:"sv;
+  constexpr auto kTrailer = ":trailer\n"sv;
+  // More than the server's maximum send buffer plus the client's receive
+  // buffer.
+  constexpr size_t kFiller = 8 * 1024 * 1024;
+  constexpr int kClientRcvBuf = 64 * 1024;
+  std::string expected(kFiller, 'f');
+  std::vector<int> completed;
+  int writeCompleteCalls = 0;
+
+  server.setConnectionCallback([&](const muduo::net::TcpConnectionPtr &conn) {
+    if (!conn->connected()) {
+      loop.quit();
+      return;
+    }
+    conn->send(std::string(kFiller, 'f'));
+    for (int i = 0; i < kMessages; ++i) {
+      std::string body(kBody, static_cast<char>('a' + i));
+      expected.append(kHeader).append(body).append(kTrailer);
+      const std::array parts{muduo::net::ByteSlice::borrow(kHeader),
+                             muduo::net::ByteSlice(std::move(body)),
+                             muduo::net::ByteSlice::borrow(kTrailer)};
+      conn->sendv(parts, [&completed, i](const muduo::net::TcpConnectionPtr &) {
+        completed.push_back(i);
+      });
+    }
+  });
+  server.setWriteCompleteCallback(
+      [&](const muduo::net::TcpConnectionPtr &) { ++writeCompleteCalls; });
+  server.start();
+
+  std::string received;
+  const size_t total =
+      kFiller + kMessages * (kHeader.size() + kBody + kTrailer.size());
+  runLoopWithClient(loop, [&] {
+    received = receiveAll(port, total, kClientRcvBuf);
+  });
+
+  EXPECT_TRUE(received == expected);
+  EXPECT_EQ(completed, (std::vector<int>{0, 1, 2}));
+  EXPECT_EQ(writeCompleteCalls, 1);
+}
+
+class FileTransferTest : public ::testing::TestWithParam<bool> {};
+
+// The transfer goes out between the bytes sent before and after it; the
+// pipe writer trickles its data in, so the transfer has to wait for it.
+TEST_P(FileTransferTest, TransferQueuedInOrder) {
+  using namespace std::chrono_literals;
+  const bool pipe = GetParam();
+
+  const int port = pickPort(false);
+  ASSERT_GT(port, 0);
+  muduo::net::EventLoop loop(muduo::net::PollerBackend::kEPoll);
+  muduo::net::InetAddress listenAddr(static_cast<uint16_t>(port), true, false);
+  muduo::net::TcpServer server(&loop, listenAddr, "FileTransferTest");
+
+  constexpr size_t kContent = 4 * 1024 * 1024;
+  constexpr off_t kOffset = 1000;
+  std::string content(kContent, '\0');
+  for (size_t i = 0; i < content.size(); ++i) {
+    content[i] = static_cast<char>('a' + i % 26);
+  }
+
+  std::array<char, 32> path{"/tmp/muduo_sendfile_XXXXXX"};
+  std::array<int, 2> pipeFds{-1, -1};
+  int sourceFd = -1;
+  if (pipe) {
+    ASSERT_EQ(::pipe2(pipeFds.data(), O_CLOEXEC), 0);
+    sourceFd = pipeFds[0];
+  } else {
+    sourceFd = ::mkstemp(path.data());
+    ASSERT_GE(sourceFd, 0);
+    (void)::unlink(path.data());
+    const std::string padding(static_cast<size_t>(kOffset), '#');
+    ASSERT_EQ(::write(sourceFd, padding.data(), padding.size()),
+              static_cast<ssize_t>(padding.size()));
+    ASSERT_EQ(::write(sourceFd, content.data(), content.size()),
+              static_cast<ssize_t>(content.size()));
+  }
+  const std::string expected = "head:" + content + ":tail";
+  int writeCompleteCalls = 0;
+
+  server.setConnectionCallback([&](const muduo::net::TcpConnectionPtr &conn) {
+    if (!conn->connected()) {
+      loop.quit();
+      return;
+    }
+    conn->send("head:"sv);
+    if (pipe) {
+      conn->sendPipe(sourceFd, kContent);
+    } else {
+      conn->sendFile(sourceFd, kOffset, kContent);
+    }
+    // The connection keeps its own descriptor.
+    ::close(sourceFd);
+    conn->send(":tail"sv);
+  });
+  server.setWriteCompleteCallback(
+      [&](const muduo::net::TcpConnectionPtr &) { ++writeCompleteCalls; });
+  server.start();
+
+  std::thread writer;
+  if (pipe) {
+    writer = std::thread([&] {
+      std::this_thread::sleep_for(200ms);
+      for (size_t sent = 0; sent < content.size();) {
+        const size_t chunk =
+            std::min<size_t>(256 * 1024, content.size() - sent);
+        const auto n = ::write(pipeFds[1], content.data() + sent, chunk);
+        if (n <= 0) {
+          break;
+        }
+        sent += static_cast<size_t>(n);
+        std::this_thread::sleep_for(10ms);
+      }
+      ::close(pipeFds[1]);
+    });
+  }
+
+  std::string received;
+  runLoopWithClient(loop, [&] {
+    received = receiveAll(port, expected.size());
+  });
+  if (writer.joinable()) {
+    writer.join();
+  }
+
+  EXPECT_TRUE(received == expected);
+  EXPECT_GE(writeCompleteCalls, 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(PipeSource, FileTransferTest, ::testing::Bool());
+
+// Large owned payloads go out with MSG_ZEROCOPY and stay pinned until the
+// kernel reports them sent; small ones are copied as before.
+TEST(ZeroCopySendTest, PayloadsReleasedAfterCompletion) {
+  using namespace std::chrono_literals;
+
+  const int port = pickPort(false);
+  ASSERT_GT(port, 0);
+  muduo::net::EventLoop loop(muduo::net::PollerBackend::kEPoll);
+  muduo::net::InetAddress listenAddr(static_cast<uint16_t>(port), true, false);
+  muduo::net::TcpServer server(&loop, listenAddr, "ZeroCopySendTest");
+  server.setZeroCopyThreshold(64 * 1024);
+
+  constexpr size_t kSlice = 4 * 1024 * 1024;
+  std::string payload(kSlice, '\0');
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<char>('a' + i % 26);
+  }
+  auto slice = muduo::net::ByteSlice::copyOf(payload);
+  const std::string tail(256 * 1024, 'z');
+  const std::string expected = "head" + payload + tail;
+
+  bool supported = false;
+  muduo::net::TcpConnection::ZeroCopyStats stats;
+  server.setConnectionCallback([&](const muduo::net::TcpConnectionPtr &conn) {
+    if (!conn->connected()) {
+      stats = conn->zeroCopyStats();
+      loop.quit();
+      return;
+    }
+    supported = conn->zeroCopyThreshold() > 0;
+    conn->send("head"sv);
+    conn->send(slice);
+    conn->send(std::string{tail});
+  });
+  server.start();
+
+  std::string received;
+  runLoopWithClient(loop, [&] {
+    const int fd = connectClient(port);
+    if (fd >= 0) {
+      (void)receiveInto(fd, expected.size(), received);
+      // Gives the completions time to arrive before the close.
+      std::this_thread::sleep_for(100ms);
+      ::close(fd);
+    }
+  });
+
+  EXPECT_TRUE(received == expected);
+  if (!supported) {
+    GTEST_SKIP() << "SO_ZEROCOPY not supported";
+  }
+  EXPECT_GT(stats.sends, 0U);
+  EXPECT_EQ(stats.pinned, 0U);
+  EXPECT_EQ(slice.useCount(), 1);
+}
+
+// Sends, gather sends and file transfers from several threads are batched
+// per connection and still arrive in each thread's order.
+TEST(CrossThreadSendTest, ProducersKeepTheirOrder) {
+  using namespace std::chrono_literals;
+
+  const int port = pickPort(false);
+  ASSERT_GT(port, 0);
+  muduo::net::EventLoop loop(muduo::net::PollerBackend::kEPoll);
+  muduo::net::InetAddress listenAddr(static_cast<uint16_t>(port), true, false);
+  muduo::net::TcpServer server(&loop, listenAddr, "CrossThreadSendTest");
+
+  constexpr int kProducers = 4;
+  constexpr int kMessages = 20000;
+  // "<producer><6-digit sequence>\n"
+  constexpr size_t kMessageSize = 8;
+  const auto makeMessage = [](int producer, int seq) {
+    std::string message(kMessageSize, '\n');
+    message[0] = static_cast<char>('0' + producer);
+    for (size_t i = kMessageSize - 2; i > 0; --i, seq /= 10) {
+      message[i] = static_cast<char>('0' + seq % 10);
+    }
+    return message;
+  };
+  // Each producer's messages, for its sendFile() calls.
+  std::array<int, kProducers> files{};
+  for (int p = 0; p < kProducers; ++p) {
+    std::array<char, 32> path{"/tmp/muduo_crosssend_XXXXXX"};
+    const int fd = ::mkstemp(path.data());
+    ASSERT_GE(fd, 0);
+    (void)::unlink(path.data());
+    for (int i = 0; i < kMessages; ++i) {
+      ASSERT_TRUE(writeExact(fd, makeMessage(p, i)));
+    }
+    files[static_cast<size_t>(p)] = fd;
+  }
+  std::vector<std::thread> producers;
+  server.setConnectionCallback([&](const muduo::net::TcpConnectionPtr &conn) {
+    if (!conn->connected()) {
+      loop.quit();
+      return;
+    }
+    for (int p = 0; p < kProducers; ++p) {
+      producers.emplace_back([conn, p, makeMessage,
+                              file = files[static_cast<size_t>(p)]] {
+        for (int i = 0; i < kMessages; ++i) {
+          auto message = makeMessage(p, i);
+          switch (i % 4) {
+          case 0:
+            conn->send(std::string_view{message});
+            break;
+          case 1:
+            conn->send(std::move(message));
+            break;
+          case 2: {
+            const std::array parts{
+                muduo::net::ByteSlice::copyOf(
+                    std::string_view{message}.substr(0, 3)),
+                muduo::net::ByteSlice::copyOf(
+                    std::string_view{message}.substr(3))};
+            conn->sendv(parts);
+            break;
+          }
+          default:
+            conn->sendFile(file, static_cast<off_t>(i * kMessageSize),
+                           kMessageSize);
+            break;
+          }
+        }
+      });
+    }
+  });
+  server.start();
+
+  std::string received;
+  constexpr size_t kExpected = kProducers * kMessages * kMessageSize;
+  runLoopWithClient(
+      loop, [&] { received = receiveAll(port, kExpected); }, 10s);
+  for (auto &producer : producers) {
+    producer.join();
+  }
+  for (const int fd : files) {
+    ::close(fd);
+  }
+
+  ASSERT_EQ(received.size(), kExpected);
+  std::array<int, kProducers> next{};
+  for (size_t pos = 0; pos < received.size(); pos += kMessageSize) {
+    const int p = received[pos] - '0';
+    ASSERT_GE(p, 0);
+    ASSERT_LT(p, kProducers);
+    auto &seq = next[static_cast<size_t>(p)];
+    ASSERT_EQ(received.substr(pos, kMessageSize), makeMessage(p, seq));
+    ++seq;
+  }
+}
+
+// A shutdown() from another thread waits for the sends queued before it,
+// including other threads' ones not drained yet.
+TEST(CrossThreadSendTest, ShutdownWaitsForQueuedSends) {
+  using namespace std::chrono_literals;
+
+  const int port = pickPort(false);
+  ASSERT_GT(port, 0);
+  muduo::net::EventLoop loop(muduo::net::PollerBackend::kEPoll);
+  muduo::net::InetAddress listenAddr(static_cast<uint16_t>(port), true, false);
+  muduo::net::TcpServer server(&loop, listenAddr, "CrossThreadShutdownTest");
+
+  constexpr int kMessages = 50000;
+  constexpr auto kMessage = "0123456789abcdef"sv;
+  std::thread sender;
+  server.setConnectionCallback([&](const muduo::net::TcpConnectionPtr &conn) {
+    if (!conn->connected()) {
+      loop.quit();
+      return;
+    }
+    sender = std::thread([conn] {
+      std::thread producer([conn] {
+        for (int i = 0; i < kMessages; ++i) {
+          conn->send(kMessage);
+        }
+      });
+      producer.join();
+      conn->shutdown();
+    });
+  });
+  server.start();
+
+  constexpr size_t kExpected = kMessages * kMessage.size();
+  std::string received;
+  bool eof = false;
+  runLoopWithClient(
+      loop,
+      [&] {
+        const int fd = connectClient(port);
+        if (fd >= 0) {
+          std::array<char, 1> rest{};
+          eof = receiveInto(fd, kExpected, received) && readSome(fd, rest) == 0;
+          ::close(fd);
+        }
+      },
+      10s);
+  sender.join();
+
+  EXPECT_TRUE(eof);
+  EXPECT_EQ(received.size(), kExpected);
+}
+
+// One slice sent to connections on several I/O loops reaches each of them
+// from the same storage, which is released once all have written it.
+TEST(BroadcastTest, SharedSliceReachesEveryConnection) {
+  using namespace std::chrono_literals;
+
+  const int port = pickPort(false);
+  ASSERT_GT(port, 0);
+  muduo::net::EventLoop loop(muduo::net::PollerBackend::kEPoll);
+  muduo::net::InetAddress listenAddr(static_cast<uint16_t>(port), true, false);
+  muduo::net::TcpServer server(&loop, listenAddr, "BroadcastTest");
+  server.setThreadNum(2);
+
+  constexpr int kClients = 4;
+  constexpr size_t kPayload = 1024 * 1024;
+  std::string payload(kPayload, '\0');
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<char>('a' + i % 26);
+  }
+  auto slice = muduo::net::ByteSlice::copyOf(payload);
+
+  std::mutex mutex;
+  std::vector<muduo::net::TcpConnectionPtr> connections;
+  std::atomic<int> disconnected{0};
+  server.setConnectionCallback([&](const muduo::net::TcpConnectionPtr &conn) {
+    if (!conn->connected()) {
+      if (disconnected.fetch_add(1) + 1 == kClients) {
+        loop.queueInLoop([&loop] { loop.quit(); });
+      }
+      return;
+    }
+    std::scoped_lock lock(mutex);
+    connections.push_back(conn);
+    if (connections.size() == kClients) {
+      // Off the I/O loops, like a publisher thread.
+      loop.queueInLoop([&connections, &slice] {
+        for (const auto &c : connections) {
+          c->send(slice);
+        }
+      });
+    }
+  });
+  server.start();
+
+  std::array<std::string, kClients> received;
+  std::vector<std::thread> clients;
+  for (int i = 0; i < kClients; ++i) {
+    clients.emplace_back([&, i] {
+      received[static_cast<size_t>(i)] = receiveAll(port, kPayload);
+    });
+  }
+
+  (void)loop.runAfter(5s, [&loop] { loop.quit(); });
+  loop.loop();
+  for (auto &client : clients) {
+    client.join();
+  }
+
+  for (const auto &out : received) {
+    EXPECT_TRUE(out == payload);
+  }
+  connections.clear();
+  EXPECT_EQ(slice.useCount(), 1);
+}
+
+TEST(ShardedAcceptTest, ConnectionsAcceptedOnTheirOwnLoops) {
+  using namespace std::chrono_literals;
+
+  const int port = pickPort(false);
+  ASSERT_GT(port, 0);
+  muduo::net::EventLoop loop;
+  muduo::net::InetAddress listenAddr(static_cast<uint16_t>(port), true, false);
+  muduo::net::TcpServer server(&loop, listenAddr, "ShardedAcceptTest",
+                               muduo::net::TcpServer::Option::kReusePort);
+  server.setThreadNum(4);
+  server.setShardedAccept(true);
+
+  constexpr int kClients = 16;
+  std::mutex mutex;
+  std::vector<muduo::net::EventLoop *> loops;
+  std::atomic<int> disconnected{0};
+  server.setConnectionCallback([&](const muduo::net::TcpConnectionPtr &conn) {
+    if (!conn->connected()) {
+      if (disconnected.fetch_add(1) + 1 == kClients) {
+        loop.queueInLoop([&loop] { loop.quit(); });
+      }
+      return;
+    }
+    std::scoped_lock lock(mutex);
+    loops.push_back(conn->getLoop());
+  });
+  server.setMessageCallback([](const muduo::net::TcpConnectionPtr &conn,
+                               muduo::net::Buffer *buf, muduo::Timestamp) {
+    conn->send(buf->retrieveAllAsString());
+  });
+  server.start();
+
+  std::atomic<int> echoed{0};
+  std::vector<std::thread> clients;
+  for (int i = 0; i < kClients; ++i) {
+    clients.emplace_back([&] {
+      const int fd = connectClient(port);
+      if (fd >= 0) {
+        if (pingEchoed(fd)) {
+          echoed.fetch_add(1);
+        }
+        ::close(fd);
+      }
+    });
+  }
+
+  (void)loop.runAfter(5s, [&loop] { loop.quit(); });
+  loop.loop();
+  for (auto &client : clients) {
+    client.join();
+  }
+
+  EXPECT_EQ(echoed.load(), kClients);
+  ASSERT_EQ(loops.size(), static_cast<size_t>(kClients));
+  const auto ioLoops = server.threadPool()->getAllLoops();
+  for (auto *ioLoop : loops) {
+    EXPECT_NE(ioLoop, &loop);
+    EXPECT_NE(std::ranges::find(ioLoops, ioLoop), ioLoops.end());
+  }
+  // The kernel hashes each connection to one of the listeners.
+  std::ranges::sort(loops);
+  EXPECT_GT(std::ranges::unique(loops).begin() - loops.begin(), 1);
+}
+
+// The base loop never runs here, so any setup or teardown step that went
+// through it would stall.
+TEST(ShardedAcceptTest, ChurnStaysOnIoLoops) {
+  using namespace std::chrono_literals;
+
+  const int port = pickPort(false);
+  ASSERT_GT(port, 0);
+  muduo::net::EventLoop loop;
+  muduo::net::InetAddress listenAddr(static_cast<uint16_t>(port), true, false);
+  auto server = std::make_unique<muduo::net::TcpServer>(
+      &loop, listenAddr, "ShardedChurnTest",
+      muduo::net::TcpServer::Option::kReusePort);
+  server->setThreadNum(2);
+  server->setShardedAccept(true);
+
+  std::atomic<int> connected{0};
+  std::atomic<int> disconnected{0};
+  std::mutex mutex;
+  std::vector<std::weak_ptr<muduo::net::TcpConnection>> accepted;
+  server->setConnectionCallback([&](const muduo::net::TcpConnectionPtr &conn) {
+    EXPECT_NE(conn->getLoop(), &loop);
+    if (conn->connected()) {
+      std::scoped_lock lock(mutex);
+      accepted.push_back(conn);
+    }
+    (conn->connected() ? connected : disconnected).fetch_add(1);
+  });
+  server->setMessageCallback([](const muduo::net::TcpConnectionPtr &conn,
+                                muduo::net::Buffer *buf, muduo::Timestamp) {
+    conn->send(buf->retrieveAllAsString());
+  });
+  server->start();
+
+  const auto waitFor = [](const std::atomic<int> &count, int expected) {
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (count.load() < expected &&
+           std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(1ms);
+    }
+    return count.load() == expected;
+  };
+
+  constexpr int kRounds = 32;
+  int echoed = 0;
+  for (int i = 0; i < kRounds; ++i) {
+    const int fd = connectClient(port);
+    ASSERT_GE(fd, 0);
+    if (pingEchoed(fd)) {
+      ++echoed;
+    }
+    ::close(fd);
+  }
+  EXPECT_EQ(echoed, kRounds);
+  // Released only once unregistered and destroyed.
+  const auto deadline = std::chrono::steady_clock::now() + 5s;
+  const auto released = [&] {
+    std::scoped_lock lock(mutex);
+    return std::ranges::all_of(accepted,
+                               [](const auto &conn) { return conn.expired(); });
+  };
+  while (!released() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(1ms);
+  }
+  EXPECT_TRUE(released());
+  EXPECT_EQ(disconnected.load(), kRounds);
+
+  // Connections still open when the server goes are destroyed in their
+  // loops.
+  const int open = connectClient(port);
+  ASSERT_GE(open, 0);
+  EXPECT_TRUE(waitFor(connected, kRounds + 1));
+  server.reset();
+  EXPECT_EQ(disconnected.load(), kRounds + 1);
+  ::close(open);
+}
+
+TEST(IncomingCpuPlacementTest, ConnectionsGoToTheLoopPinnedToTheirCpu) {
+  using namespace std::chrono_literals;
+
+  // Loop 0 may run on any CPU this process may, loop 1 is left unpinned, so
+  // every connection belongs on loop 0 whichever CPU received it.
+  cpu_set_t allowed;
+  ASSERT_EQ(::sched_getaffinity(0, sizeof allowed, &allowed), 0);
+  std::vector<int> cpus;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &allowed)) {
+      cpus.push_back(cpu);
+    }
+  }
+
+  const int port = pickPort(false);
+  ASSERT_GT(port, 0);
+  muduo::net::EventLoop loop;
+  muduo::net::InetAddress listenAddr(static_cast<uint16_t>(port), true, false);
+  muduo::net::TcpServer server(&loop, listenAddr, "IncomingCpuPlacementTest");
+  server.setThreadNum(2, {cpus, {}});
+  server.setIncomingCpuPlacement(true);
+
+  constexpr int kClients = 8;
+  std::mutex mutex;
+  std::vector<muduo::net::EventLoop *> loops;
+  server.setConnectionCallback([&](const muduo::net::TcpConnectionPtr &conn) {
+    if (!conn->connected()) {
+      return;
+    }
+    std::scoped_lock lock(mutex);
+    loops.push_back(conn->getLoop());
+    if (loops.size() == static_cast<size_t>(kClients)) {
+      loop.queueInLoop([&loop] { loop.quit(); });
+    }
+  });
+  server.start();
+
+  std::vector<int> fds;
+  for (int i = 0; i < kClients; ++i) {
+    const int fd = connectClient(port);
+    ASSERT_GE(fd, 0);
+    fds.push_back(fd);
+  }
+
+  (void)loop.runAfter(5s, [&loop] { loop.quit(); });
+  loop.loop();
+  for (const int fd : fds) {
+    ::close(fd);
+  }
+
+  const auto ioLoops = server.threadPool()->getAllLoops();
+  std::scoped_lock lock(mutex);
+  ASSERT_EQ(loops.size(), static_cast<size_t>(kClients));
+  for (auto *ioLoop : loops) {
+    EXPECT_EQ(ioLoop, ioLoops[0]);
+  }
+}
+
+class AcceptBatchTest : public ::testing::TestWithParam<bool> {};
+
+TEST_P(AcceptBatchTest, ConnectStormIsServed) {
+  const bool sharded = GetParam();
+
+  const int port = pickPort(false);
+  ASSERT_GT(port, 0);
+  muduo::net::EventLoop loop;
+  muduo::net::InetAddress listenAddr(static_cast<uint16_t>(port), true, false);
+  muduo::net::TcpServer server(&loop, listenAddr, "AcceptBatchTest",
+                               muduo::net::TcpServer::Option::kReusePort);
+  server.setThreadNum(3);
+  server.setShardedAccept(sharded);
+  server.setAcceptBatch(16);
+
+  constexpr int kClients = 64;
+  std::atomic<int> connected{0};
+  std::atomic<int> disconnected{0};
+  server.setConnectionCallback([&](const muduo::net::TcpConnectionPtr &conn) {
+    if (conn->connected()) {
+      connected.fetch_add(1);
+    } else if (disconnected.fetch_add(1) + 1 == kClients) {
+      loop.queueInLoop([&loop] { loop.quit(); });
+    }
+  });
+  server.setMessageCallback([](const muduo::net::TcpConnectionPtr &conn,
+                               muduo::net::Buffer *buf, muduo::Timestamp) {
+    conn->send(buf->retrieveAllAsString());
+  });
+  server.start();
+
+  // All clients connect before any of them is served, so the listen
+  // backlog fills up and each readiness event has several to accept.
+  std::atomic<int> echoed{0};
+  runLoopWithClient(loop, [&] {
+    std::vector<int> fds;
+    for (int i = 0; i < kClients; ++i) {
+      if (const int fd = connectClient(port); fd >= 0) {
+        fds.push_back(fd);
+      }
+    }
+    for (const int fd : fds) {
+      if (pingEchoed(fd)) {
+        echoed.fetch_add(1);
+      }
+      ::close(fd);
+    }
+  });
+
+  EXPECT_EQ(connected.load(), kClients);
+  EXPECT_EQ(echoed.load(), kClients);
+}
+
+INSTANTIATE_TEST_SUITE_P(Sharded, AcceptBatchTest, ::testing::Bool());
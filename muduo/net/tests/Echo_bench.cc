@@ -70,11 +70,16 @@ bool readFull(int fd, std::span<char> data) {
 
 class EchoServerHarness {
 public:
-  explicit EchoServerHarness(uint16_t port) : port_(port) {
+  EchoServerHarness(uint16_t port, muduo::net::PollerBackend backend,
+                    bool ioUringCompletion,
+                    std::chrono::microseconds busyPollBudget)
+      : loopThread_({}, "EchoBenchLoop", backend), port_(port) {
     loop_ = loopThread_.startLoop();
-    loop_->runInLoop([this] {
+    loop_->setBusyPollBudget(busyPollBudget);
+    loop_->runInLoop([this, ioUringCompletion] {
       server_ = std::make_unique<muduo::net::TcpServer>(
           loop_, muduo::net::InetAddress(port_, true), "EchoBench");
+      server_->setIoUringCompletion(ioUringCompletion);
       server_->setConnectionCallback([](const muduo::net::TcpConnectionPtr &) {});
       server_->setMessageCallback([](const muduo::net::TcpConnectionPtr &conn,
                                      muduo::net::Buffer *buf, muduo::Timestamp) {
@@ -159,12 +164,15 @@ private:
   int fd_{-1};
 };
 
-static void BM_EchoRoundTrip(benchmark::State &state) {
+static void BM_EchoRoundTrip(benchmark::State &state,
+                             muduo::net::PollerBackend backend,
+                             bool ioUringCompletion = false,
+                             std::chrono::microseconds busyPollBudget = {}) {
   prepareBenchLogging();
 
   const auto payloadSize = static_cast<size_t>(state.range(0));
   const uint16_t port = static_cast<uint16_t>(pickPort());
-  EchoServerHarness server(port);
+  EchoServerHarness server(port, backend, ioUringCompletion, busyPollBudget);
   TcpSocketClient client(port);
 
   if (!client.ok()) {
@@ -189,7 +197,41 @@ static void BM_EchoRoundTrip(benchmark::State &state) {
   state.SetItemsProcessed(state.iterations());
 }
 
-BENCHMARK(BM_EchoRoundTrip)
+BENCHMARK_CAPTURE(BM_EchoRoundTrip, epoll, muduo::net::PollerBackend::kEPoll)
+    ->Arg(64)
+    ->Arg(256)
+    ->Arg(1024)
+    ->Arg(4096)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_CAPTURE(BM_EchoRoundTrip, poll, muduo::net::PollerBackend::kPoll)
+    ->Arg(64)
+    ->Arg(4096)
+    ->Unit(benchmark::kMicrosecond);
+
+// The server loop spins for up to 1 ms between requests instead of sleeping
+// in epoll_wait.
+BENCHMARK_CAPTURE(BM_EchoRoundTrip, epoll_busy_poll,
+                  muduo::net::PollerBackend::kEPoll, false,
+                  std::chrono::microseconds{1000})
+    ->Arg(64)
+    ->Arg(256)
+    ->Arg(1024)
+    ->Arg(4096)
+    ->Unit(benchmark::kMicrosecond);
+
+// Falls back to epoll (with a warning) when io_uring is unavailable.
+BENCHMARK_CAPTURE(BM_EchoRoundTrip, io_uring,
+                  muduo::net::PollerBackend::kIoUring)
+    ->Arg(64)
+    ->Arg(256)
+    ->Arg(1024)
+    ->Arg(4096)
+    ->Unit(benchmark::kMicrosecond);
+
+// recv/send completions instead of readiness plus read()/write().
+BENCHMARK_CAPTURE(BM_EchoRoundTrip, io_uring_completion,
+                  muduo::net::PollerBackend::kIoUring, true)
     ->Arg(64)
     ->Arg(256)
     ->Arg(1024)
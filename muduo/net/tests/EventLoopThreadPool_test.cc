@@ -4,9 +4,13 @@
 
 #include <gtest/gtest.h>
 
+#include <sched.h>
+
 #include <atomic>
 #include <chrono>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 class EventLoopThreadPoolTest : public ::testing::Test {};
 
@@ -78,3 +82,132 @@ TEST_F(EventLoopThreadPoolTest, RoundRobinWithThreeThreads) {
   const auto all = pool.getAllLoops();
   EXPECT_EQ(all.size(), 3u);
 }
+
+TEST_F(EventLoopThreadPoolTest, BusyPollAppliesToSelectedLoops) {
+  using namespace std::chrono_literals;
+  muduo::net::EventLoop loop;
+  muduo::net::EventLoopThreadPool pool(&loop, "busy");
+  pool.setThreadNum(3);
+  pool.setBusyPoll(2, 200us, 50us);
+  pool.start();
+
+  const auto all = pool.getAllLoops();
+  ASSERT_EQ(all.size(), 3u);
+  EXPECT_EQ(all[0]->busyPollBudget(), 200us);
+  EXPECT_EQ(all[0]->socketBusyPoll(), 50us);
+  EXPECT_EQ(all[1]->busyPollBudget(), 200us);
+  EXPECT_EQ(all[2]->busyPollBudget(), 0us);
+  EXPECT_EQ(all[2]->socketBusyPoll(), 0us);
+  EXPECT_EQ(loop.busyPollBudget(), 0us);
+
+  std::atomic<bool> ran{false};
+  all[0]->runInLoop([&ran] { ran.store(true, std::memory_order_release); });
+  for (int i = 0; i < 200 && !ran.load(std::memory_order_acquire); ++i) {
+    std::this_thread::sleep_for(5ms);
+  }
+  EXPECT_TRUE(ran.load(std::memory_order_acquire));
+}
+
+TEST_F(EventLoopThreadPoolTest, LeastConnectionsSkipsLoadedLoop) {
+  muduo::net::EventLoop loop;
+  muduo::net::EventLoopThreadPool pool(&loop, "leastconn");
+  pool.setThreadNum(3);
+  pool.setLoopSelection(muduo::net::LoopSelection::kLeastConnections);
+  pool.start();
+
+  const auto all = pool.getAllLoops();
+  all[0]->addConnectionLoad(2);
+  all[1]->addConnectionLoad(1);
+  EXPECT_EQ(pool.getNextLoop(), all[2]);
+  all[2]->addConnectionLoad(2);
+  EXPECT_EQ(pool.getNextLoop(), all[1]);
+  all[1]->addConnectionLoad(1);
+  // All tied: taken in turn.
+  auto *first = pool.getNextLoop();
+  EXPECT_NE(pool.getNextLoop(), first);
+
+  for (auto *ioLoop : all) {
+    ioLoop->addConnectionLoad(-ioLoop->load().connections);
+  }
+}
+
+TEST_F(EventLoopThreadPoolTest, LeastPendingSkipsBackloggedLoop) {
+  using namespace std::chrono_literals;
+  muduo::net::EventLoop loop;
+  muduo::net::EventLoopThreadPool pool(&loop, "leastpending");
+  pool.setThreadNum(2);
+  pool.setLoopSelection(muduo::net::LoopSelection::kLeastPending);
+  pool.start();
+
+  const auto all = pool.getAllLoops();
+  std::atomic<bool> release{false};
+  std::atomic<bool> blocked{false};
+  all[0]->runInLoop([&] {
+    blocked.store(true, std::memory_order_release);
+    while (!release.load(std::memory_order_acquire)) {
+      std::this_thread::sleep_for(1ms);
+    }
+  });
+  while (!blocked.load(std::memory_order_acquire)) {
+    std::this_thread::sleep_for(1ms);
+  }
+  for (int i = 0; i < 3; ++i) {
+    all[0]->queueInLoop([] {});
+  }
+  EXPECT_EQ(all[0]->load().pendingFunctors, 3u);
+
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(pool.getNextLoop(), all[1]);
+  }
+  release.store(true, std::memory_order_release);
+}
+
+TEST_F(EventLoopThreadPoolTest, PowerOfTwoChoicesAvoidsBusyLoop) {
+  using namespace std::chrono_literals;
+  muduo::net::EventLoop loop;
+  muduo::net::EventLoopThreadPool pool(&loop, "p2c");
+  pool.setThreadNum(2);
+  pool.setLoopSelection(muduo::net::LoopSelection::kPowerOfTwoChoices);
+  pool.start();
+
+  const auto all = pool.getAllLoops();
+  (void)pool.getNextLoop();
+  all[0]->runInLoop([] { std::this_thread::sleep_for(60ms); });
+  std::this_thread::sleep_for(100ms);
+
+  EXPECT_GT(all[0]->load().busyMicros, 50000);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(pool.getNextLoop(), all[1]);
+  }
+}
+
+TEST_F(EventLoopThreadPoolTest, CpuAffinityPinsLoopThreads) {
+  cpu_set_t allowed;
+  ASSERT_EQ(::sched_getaffinity(0, sizeof allowed, &allowed), 0);
+  int cpu = 0;
+  while (!CPU_ISSET(cpu, &allowed)) {
+    ++cpu;
+  }
+
+  muduo::net::EventLoop loop;
+  muduo::net::EventLoopThreadPool pool(&loop, "pinned");
+  pool.setThreadNum(2);
+  pool.setCpuAffinity({{cpu}});
+  std::mutex mutex;
+  std::vector<int> pinnedCounts;
+  pool.start([&](muduo::net::EventLoop *) {
+    cpu_set_t set;
+    ASSERT_EQ(::sched_getaffinity(0, sizeof set, &set), 0);
+    std::scoped_lock lock(mutex);
+    pinnedCounts.push_back(CPU_ISSET(cpu, &set) ? CPU_COUNT(&set) : 0);
+  });
+  EXPECT_EQ(pinnedCounts, (std::vector<int>{1, 1}));
+
+  const auto all = pool.getAllLoops();
+  ASSERT_EQ(all.size(), 2u);
+  EXPECT_EQ(pool.getLoopForCpu(cpu), all[0]);
+  EXPECT_EQ(pool.getLoopForCpu(cpu + 1), nullptr);
+  ASSERT_EQ(pool.cpusOf(all[1]).size(), 1u);
+  EXPECT_EQ(pool.cpusOf(all[1]).front(), cpu);
+  EXPECT_TRUE(pool.cpusOf(&loop).empty());
+}
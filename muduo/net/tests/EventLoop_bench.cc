@@ -0,0 +1,163 @@
+#include "muduo/base/MpscQueue.h"
+#include "muduo/net/EventLoop.h"
+#include "muduo/net/EventLoopThread.h"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Functor = muduo::net::EventLoop::Functor;
+
+// The mutex + vector swap scheme, as a baseline for MpscQueue.
+class LockedFunctorQueue {
+public:
+  void push(Functor cb) {
+    std::scoped_lock lock(mutex_);
+    functors_.push_back(std::move(cb));
+  }
+
+  template <typename F> size_t consume(F &&f) {
+    std::vector<Functor> functors;
+    {
+      std::scoped_lock lock(mutex_);
+      functors.swap(functors_);
+    }
+    for (auto &functor : functors) {
+      f(functor);
+    }
+    return functors.size();
+  }
+
+private:
+  std::mutex mutex_;
+  std::vector<Functor> functors_;
+};
+
+// `producers` threads push functors while the benchmark thread drains them,
+// the fan-in pattern of worker threads posting results to one I/O loop.
+template <typename Queue> void BM_FunctorQueueFanIn(benchmark::State &state) {
+  const auto producers = static_cast<int>(state.range(0));
+  constexpr int kPerProducer = 50'000;
+  const int total = producers * kPerProducer;
+
+  for (auto _ : state) {
+    Queue queue;
+    std::atomic<bool> go{false};
+    std::int64_t sum = 0;
+    std::vector<std::thread> threads;
+    threads.reserve(static_cast<size_t>(producers));
+    for (int p = 0; p < producers; ++p) {
+      threads.emplace_back([&queue, &go, &sum] {
+        while (!go.load(std::memory_order_acquire)) {
+          std::this_thread::yield();
+        }
+        for (int i = 0; i < kPerProducer; ++i) {
+          queue.push(Functor([&sum] { ++sum; }));
+        }
+      });
+    }
+
+    go.store(true, std::memory_order_release);
+    int consumed = 0;
+    while (consumed < total) {
+      const auto n = queue.consume([](Functor &functor) { functor(); });
+      if (n == 0) {
+        std::this_thread::yield();
+      }
+      consumed += static_cast<int>(n);
+    }
+    for (auto &t : threads) {
+      t.join();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+
+  state.SetItemsProcessed(state.iterations() * total);
+}
+
+BENCHMARK_TEMPLATE(BM_FunctorQueueFanIn, LockedFunctorQueue)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_FunctorQueueFanIn, muduo::MpscQueue<Functor>)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Throughput of runInLoop() from several threads into one running loop.
+void BM_CrossThreadRunInLoop(benchmark::State &state) {
+  const auto producers = static_cast<int>(state.range(0));
+  constexpr int kPerProducer = 20'000;
+  const std::int64_t total = std::int64_t{producers} * kPerProducer;
+
+  muduo::net::EventLoopThread loopThread({}, "RunInLoopBench");
+  muduo::net::EventLoop *loop = loopThread.startLoop();
+
+  for (auto _ : state) {
+    std::atomic<std::int64_t> done{0};
+    std::vector<std::thread> threads;
+    threads.reserve(static_cast<size_t>(producers));
+    for (int p = 0; p < producers; ++p) {
+      threads.emplace_back([loop, &done] {
+        for (int i = 0; i < kPerProducer; ++i) {
+          loop->runInLoop(
+              [&done] { done.fetch_add(1, std::memory_order_relaxed); });
+        }
+      });
+    }
+    for (auto &t : threads) {
+      t.join();
+    }
+    while (done.load(std::memory_order_acquire) < total) {
+      std::this_thread::yield();
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * total);
+}
+
+BENCHMARK(BM_CrossThreadRunInLoop)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Time from runInLoop() on another thread until the functor has run.
+void BM_CrossThreadRunInLoopLatency(benchmark::State &state) {
+  muduo::net::EventLoopThread loopThread({}, "RunInLoopLatency");
+  muduo::net::EventLoop *loop = loopThread.startLoop();
+
+  std::atomic<std::int64_t> done{0};
+  std::int64_t posted = 0;
+  for (auto _ : state) {
+    ++posted;
+    loop->runInLoop([&done] { done.fetch_add(1, std::memory_order_release); });
+    while (done.load(std::memory_order_acquire) < posted) {
+      std::this_thread::yield();
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_CrossThreadRunInLoopLatency)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace
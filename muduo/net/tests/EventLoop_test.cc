@@ -126,6 +126,87 @@ TEST_F(EventLoopTest, QueueInLoopFromManyThreadsNoLoss) {
   EXPECT_EQ(executed.load(std::memory_order_acquire), kTotalTasks);
 }
 
+TEST_F(EventLoopTest, CoalescedWakeupsNeverStall) {
+  using namespace std::chrono_literals;
+
+  muduo::net::EventLoop loop;
+  constexpr int kRounds = 20'000;
+  std::atomic<int> executed{0};
+
+  // Each round waits for the loop to go idle again, so every post has to
+  // wake it; bursts in between must only cost one eventfd write each.
+  std::thread producer([&loop, &executed] {
+    const auto deadline = std::chrono::steady_clock::now() + 15s;
+    for (int round = 1; round <= kRounds; ++round) {
+      for (int i = 0; i < 3; ++i) {
+        loop.queueInLoop([&executed] {
+          executed.fetch_add(1, std::memory_order_relaxed);
+        });
+      }
+      while (executed.load(std::memory_order_relaxed) < round * 3) {
+        if (std::chrono::steady_clock::now() > deadline) {
+          return;
+        }
+        std::this_thread::yield();
+      }
+    }
+    loop.queueInLoop([&loop] { loop.quit(); });
+  });
+
+  (void)loop.runAfter(20s, [&loop] { loop.quit(); });
+  loop.loop();
+  producer.join();
+
+  EXPECT_EQ(executed.load(std::memory_order_relaxed), kRounds * 3);
+}
+
+TEST_F(EventLoopTest, BusyPollRunsQueuedWorkAndQuits) {
+  using namespace std::chrono_literals;
+
+  muduo::net::EventLoop loop;
+  EXPECT_EQ(loop.busyPollBudget(), 0us);
+  // Longer than the test: the loop must react while still spinning.
+  loop.setBusyPollBudget(10s);
+  EXPECT_EQ(loop.busyPollBudget(), 10s);
+
+  std::atomic<int> ran{0};
+  (void)loop.runAfter(20ms, [&ran] { ran.fetch_add(1); });
+  std::thread producer([&loop, &ran] {
+    std::this_thread::sleep_for(50ms);
+    loop.runInLoop([&loop, &ran] {
+      ran.fetch_add(1);
+      loop.quit();
+    });
+  });
+
+  const auto start = std::chrono::steady_clock::now();
+  loop.loop();
+  producer.join();
+
+  EXPECT_EQ(ran.load(), 2);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+}
+
+TEST_F(EventLoopTest, FlushesRunAfterPendingFunctors) {
+  using namespace std::chrono_literals;
+
+  muduo::net::EventLoop loop;
+  std::vector<int> order;
+  // Queued before the loop runs: they run before the first poll.
+  loop.queueFlush([&loop, &order] {
+    order.push_back(2);
+    loop.queueFlush([&order] { order.push_back(3); });
+  });
+  loop.queueInLoop([&order] { order.push_back(1); });
+  loop.queueInLoop([&loop] { loop.quit(); });
+
+  const auto start = std::chrono::steady_clock::now();
+  loop.loop();
+
+  EXPECT_EQ(order, (std::vector<int>{1, 2, 3}));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+}
+
 #if GTEST_HAS_DEATH_TEST
 TEST_F(EventLoopTest, OneLoopPerThreadDeath) {
   ASSERT_DEATH(
@@ -0,0 +1,157 @@
+#include "muduo/net/Channel.h"
+#include "muduo/net/EventLoop.h"
+#include "muduo/net/Poller.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace {
+
+using muduo::net::Channel;
+using muduo::net::EventLoop;
+using muduo::net::PollerBackend;
+
+constexpr int kChannels = 100'000;
+
+// Raises the fd limit for count more descriptors; the hard limit only moves
+// with CAP_SYS_RESOURCE. False if that is still not enough.
+bool reserveFds(int count) {
+  rlimit limit{};
+  if (::getrlimit(RLIMIT_NOFILE, &limit) != 0) {
+    return false;
+  }
+  const auto wanted = static_cast<rlim_t>(count) + 64;
+  if (limit.rlim_cur >= wanted) {
+    return true;
+  }
+  rlimit raised{wanted, std::max(wanted, limit.rlim_max)};
+  if (::setrlimit(RLIMIT_NOFILE, &raised) == 0) {
+    return true;
+  }
+  raised.rlim_cur = std::min(wanted, limit.rlim_max);
+  raised.rlim_max = limit.rlim_max;
+  return ::setrlimit(RLIMIT_NOFILE, &raised) == 0 && raised.rlim_cur >= wanted;
+}
+
+// count eventfd channels, all reading, registered with loop.
+class ChannelSet {
+public:
+  ChannelSet(EventLoop *loop, int count) {
+    channels_.reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+      const int fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      if (fd < 0) {
+        break;
+      }
+      auto channel = std::make_unique<Channel>(loop, fd);
+      channel->enableReading();
+      channels_.push_back(std::move(channel));
+    }
+  }
+
+  ~ChannelSet() {
+    for (auto &channel : channels_) {
+      channel->disableAll();
+      channel->remove();
+      ::close(channel->fd());
+    }
+  }
+
+  [[nodiscard]] size_t size() const noexcept { return channels_.size(); }
+  [[nodiscard]] Channel &operator[](size_t i) const { return *channels_[i]; }
+
+private:
+  std::vector<std::unique_ptr<Channel>> channels_;
+};
+
+// One interest change (add EPOLLOUT, drop it again) on a different channel
+// each time, with kChannels registered: the Channel::enableWriting() /
+// disableWriting() pattern of every partial write.
+void BM_PollerInterestUpdate(benchmark::State &state) {
+  if (!reserveFds(kChannels)) {
+    state.SkipWithError("RLIMIT_NOFILE too low for 100k channels");
+    return;
+  }
+  EventLoop loop(static_cast<PollerBackend>(state.range(0)));
+  ChannelSet channels(&loop, kChannels);
+  if (channels.size() != static_cast<size_t>(kChannels)) {
+    state.SkipWithError("could not open 100k eventfds");
+    return;
+  }
+
+  size_t next = 0;
+  for (auto _ : state) {
+    Channel &channel = channels[next];
+    channel.enableWriting();
+    channel.disableWriting();
+    next = next + 7919 < channels.size() ? next + 7919
+                                         : next + 7919 - channels.size();
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+
+BENCHMARK(BM_PollerInterestUpdate)
+    ->ArgName("backend")
+    ->Arg(static_cast<int>(PollerBackend::kEPoll))
+    ->Arg(static_cast<int>(PollerBackend::kPoll))
+    ->Unit(benchmark::kNanosecond);
+
+// EventLoop::hasChannel() with kChannels registered: the table lookup alone,
+// without a syscall around it.
+void BM_PollerHasChannel(benchmark::State &state) {
+  if (!reserveFds(kChannels)) {
+    state.SkipWithError("RLIMIT_NOFILE too low for 100k channels");
+    return;
+  }
+  EventLoop loop(static_cast<PollerBackend>(state.range(0)));
+  ChannelSet channels(&loop, kChannels);
+
+  size_t next = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(loop.hasChannel(&channels[next]));
+    next = next + 7919 < channels.size() ? next + 7919
+                                         : next + 7919 - channels.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_PollerHasChannel)
+    ->ArgName("backend")
+    ->Arg(static_cast<int>(PollerBackend::kEPoll))
+    ->Arg(static_cast<int>(PollerBackend::kPoll));
+
+// The fd -> Channel table on its own, against the hash map it replaced.
+template <typename Map> void BM_ChannelTableLookup(benchmark::State &state) {
+  Map map;
+  std::vector<int> fds;
+  for (int fd = 3; fd < kChannels + 3; ++fd) {
+    if constexpr (std::is_same_v<Map, muduo::net::Poller::ChannelMap>) {
+      map.insert(fd, reinterpret_cast<Channel *>(std::uintptr_t{8}));
+    } else {
+      map[fd] = reinterpret_cast<Channel *>(std::uintptr_t{8});
+    }
+    fds.push_back(fd);
+  }
+
+  size_t next = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.find(fds[next]));
+    next = next + 7919 < fds.size() ? next + 7919 : next + 7919 - fds.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_ChannelTableLookup, std::unordered_map<int, Channel *>);
+BENCHMARK_TEMPLATE(BM_ChannelTableLookup, muduo::net::Poller::ChannelMap);
+
+} // namespace
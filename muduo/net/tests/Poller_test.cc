@@ -1,13 +1,20 @@
 #include "muduo/net/Channel.h"
 #include "muduo/net/EventLoop.h"
+#include "muduo/net/Poller.h"
+#include "muduo/net/poller/IoUring.h"
+#include "muduo/net/poller/IoUringPoller.h"
 
 #include <gtest/gtest.h>
 
 #include <array>
 #include <atomic>
+#include <chrono>
 #include <cstdlib>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include <fcntl.h>
 #include <unistd.h>
 
 namespace muduo::net {
@@ -56,6 +63,38 @@ struct PipeFd {
   }
 };
 
+// Reads one of four buffered bytes per callback: an edge-triggered channel
+// must not be reported again until more data arrives.
+void expectOneCallbackPerEdge(PollerBackend backend) {
+  EventLoop loop(backend);
+  ASSERT_TRUE(loop.supportsEdgeTriggered());
+  PipeFd pipeFd;
+  std::atomic<int> callbacks{0};
+
+  Channel channel(&loop, pipeFd.fds[0]);
+  channel.setReadCallback([&pipeFd, &callbacks](Timestamp) {
+    char byte = 0;
+    EXPECT_EQ(::read(pipeFd.fds[0], &byte, 1), 1);
+    callbacks.fetch_add(1, std::memory_order_relaxed);
+  });
+  channel.setEdgeTriggered(true);
+  channel.enableReading();
+
+  ASSERT_EQ(::write(pipeFd.fds[1], "abcd", 4), 4);
+  (void)loop.runAfter(std::chrono::milliseconds(50), [&] {
+    EXPECT_EQ(callbacks.load(std::memory_order_relaxed), 1);
+    ASSERT_EQ(::write(pipeFd.fds[1], "e", 1), 1);
+  });
+  (void)loop.runAfter(std::chrono::milliseconds(100), [&] {
+    channel.disableAll();
+    channel.remove();
+    loop.quit();
+  });
+  loop.loop();
+
+  EXPECT_EQ(callbacks.load(std::memory_order_relaxed), 2);
+}
+
 TEST(PollerSelectionTest, PollPollerReadEventPath) {
   ScopedEnv usePoll("MUDUO_USE_POLL", "1");
 
@@ -151,5 +190,252 @@ TEST(PollerSelectionTest, EPollDeletedToAddedRoundTrip) {
   EXPECT_EQ(callbacks.load(std::memory_order_relaxed), 2);
 }
 
+TEST(PollerSelectionTest, EPollEdgeTriggeredOncePerEdge) {
+  expectOneCallbackPerEdge(PollerBackend::kEPoll);
+}
+
+TEST(PollerSelectionTest, PollPollerIsLevelTriggeredOnly) {
+  EventLoop loop(PollerBackend::kPoll);
+  EXPECT_FALSE(loop.supportsEdgeTriggered());
+}
+
+TEST(PollerSelectionTest, IoUringReadEventPath) {
+  if (!IoUringPoller::isSupported()) {
+    GTEST_SKIP() << "io_uring unavailable";
+  }
+
+  EventLoop loop(PollerBackend::kIoUring);
+  PipeFd pipeFd;
+  std::atomic<int> callbacks{0};
+
+  Channel channel(&loop, pipeFd.fds[0]);
+  channel.setReadCallback([&loop, &channel, &pipeFd, &callbacks](Timestamp) {
+    char byte = 0;
+    EXPECT_EQ(::read(pipeFd.fds[0], &byte, 1), 1);
+    const int n = callbacks.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (n < 3) {
+      // One-shot requests must be re-armed for the next byte.
+      const char next = 'n';
+      EXPECT_EQ(::write(pipeFd.fds[1], &next, 1), 1);
+      return;
+    }
+    channel.disableAll();
+    channel.remove();
+    loop.quit();
+  });
+  channel.enableReading();
+
+  const char byte = 'u';
+  ASSERT_EQ(::write(pipeFd.fds[1], &byte, 1), 1);
+  loop.loop();
+
+  EXPECT_EQ(callbacks.load(std::memory_order_relaxed), 3);
+}
+
+TEST(PollerSelectionTest, IoUringLevelTriggeredUntilDrained) {
+  if (!IoUringPoller::isSupported()) {
+    GTEST_SKIP() << "io_uring unavailable";
+  }
+
+  EventLoop loop(PollerBackend::kIoUring);
+  PipeFd pipeFd;
+  std::atomic<int> callbacks{0};
+
+  Channel channel(&loop, pipeFd.fds[0]);
+  channel.setReadCallback([&loop, &channel, &pipeFd, &callbacks](Timestamp) {
+    // Consume one byte per wakeup; the rest must be reported again.
+    char byte = 0;
+    EXPECT_EQ(::read(pipeFd.fds[0], &byte, 1), 1);
+    if (callbacks.fetch_add(1, std::memory_order_relaxed) + 1 == 4) {
+      channel.disableAll();
+      channel.remove();
+      loop.quit();
+    }
+  });
+  channel.enableReading();
+
+  ASSERT_EQ(::write(pipeFd.fds[1], "abcd", 4), 4);
+  loop.loop();
+
+  EXPECT_EQ(callbacks.load(std::memory_order_relaxed), 4);
+}
+
+TEST(PollerSelectionTest, IoUringEdgeTriggeredOncePerEdge) {
+  if (!IoUringPoller::isSupported()) {
+    GTEST_SKIP() << "io_uring unavailable";
+  }
+  expectOneCallbackPerEdge(PollerBackend::kIoUring);
+}
+
+TEST(PollerSelectionTest, IoUringWriteInterestToggle) {
+  if (!IoUringPoller::isSupported()) {
+    GTEST_SKIP() << "io_uring unavailable";
+  }
+  ScopedEnv useIoUring("MUDUO_USE_IO_URING", "1");
+
+  EventLoop loop;
+  PipeFd pipeFd;
+  std::atomic<int> writes{0};
+
+  Channel channel(&loop, pipeFd.fds[1]);
+  channel.setWriteCallback([&loop, &channel, &writes] {
+    const int n = writes.fetch_add(1, std::memory_order_relaxed) + 1;
+    // Flip interest several times within one iteration; only the net
+    // result may reach the ring.
+    channel.disableWriting();
+    channel.enableWriting();
+    channel.disableWriting();
+    if (n < 3) {
+      channel.enableWriting();
+      return;
+    }
+    channel.disableAll();
+    channel.remove();
+    loop.quit();
+  });
+  channel.enableWriting();
+  loop.loop();
+
+  EXPECT_EQ(writes.load(std::memory_order_relaxed), 3);
+  EXPECT_FALSE(loop.hasChannel(&channel));
+}
+
+TEST(IoUringTest, FullRingWaitsForTheKernelToConsume) {
+  if (!IoUringPoller::isSupported()) {
+    GTEST_SKIP() << "io_uring unavailable";
+  }
+
+  // Four SQEs and eight CQEs: the submission ring fills every four requests
+  // and the completion ring backs up long before all of them are queued.
+  IoUring ring(4);
+  constexpr unsigned kRequests = 256;
+  std::vector<int> seen(kRequests, 0);
+  unsigned completed = 0;
+  const auto record = [&seen, &completed](const io_uring_cqe &cqe) {
+    ASSERT_LT(cqe.user_data, seen.size());
+    ++seen[cqe.user_data];
+    ++completed;
+  };
+  for (unsigned i = 0; i < kRequests; ++i) {
+    io_uring_sqe *sqe = ring.getSqe(record);
+    sqe->opcode = IORING_OP_NOP;
+    sqe->user_data = i;
+  }
+  for (int round = 0; round < 100 && completed < kRequests; ++round) {
+    (void)ring.submitAndWait(10);
+    (void)ring.forEachCqe(record);
+  }
+
+  // No request was overwritten before the kernel took it.
+  for (unsigned i = 0; i < kRequests; ++i) {
+    EXPECT_EQ(seen[i], 1) << "request " << i;
+  }
+}
+
+// More channels than the ring has SQEs become interested in one iteration.
+TEST(PollerSelectionTest, IoUringArmsMoreChannelsThanRingEntries) {
+  if (!IoUringPoller::isSupported()) {
+    GTEST_SKIP() << "io_uring unavailable";
+  }
+
+  using namespace std::chrono_literals;
+
+  EventLoop loop(PollerBackend::kIoUring);
+  PipeFd pipeFd;
+  constexpr int kChannels = 600;
+  std::vector<int> fds;
+  std::vector<std::unique_ptr<Channel>> channels;
+  int reported = 0;
+  for (int i = 0; i < kChannels; ++i) {
+    fds.push_back(::fcntl(pipeFd.fds[0], F_DUPFD_CLOEXEC, 0));
+    ASSERT_GE(fds.back(), 0);
+    auto channel = std::make_unique<Channel>(&loop, fds.back());
+    Channel *raw = channel.get();
+    raw->setReadCallback([&loop, raw, &reported](Timestamp) {
+      raw->disableAll();
+      raw->remove();
+      if (++reported == kChannels) {
+        loop.quit();
+      }
+    });
+    raw->enableReading();
+    channels.push_back(std::move(channel));
+  }
+
+  ASSERT_EQ(::write(pipeFd.fds[1], "x", 1), 1);
+  (void)loop.runAfter(5s, [&loop] { loop.quit(); });
+  loop.loop();
+
+  EXPECT_EQ(reported, kChannels);
+  for (auto &channel : channels) {
+    if (loop.hasChannel(channel.get())) {
+      channel->disableAll();
+      channel->remove();
+    }
+  }
+  for (const int fd : fds) {
+    ::close(fd);
+  }
+}
+
+TEST(PollerChannelMapTest, GrowsOnDemandAndTracksSize) {
+  Poller::ChannelMap map;
+  EventLoop loop;
+  Channel low(&loop, 3);
+  Channel high(&loop, 4000);
+
+  EXPECT_FALSE(map.contains(3));
+  EXPECT_EQ(map.find(100'000), nullptr);
+  map.insert(4000, &high);
+  map.insert(3, &low);
+  EXPECT_EQ(map.size(), 2u);
+  EXPECT_EQ(map.find(3), &low);
+  EXPECT_EQ(map.find(4000), &high);
+  EXPECT_FALSE(map.contains(3999));
+
+  EXPECT_EQ(map.erase(4000), 1u);
+  EXPECT_EQ(map.erase(4000), 0u);
+  EXPECT_EQ(map.erase(100'000), 0u);
+  EXPECT_EQ(map.size(), 1u);
+  EXPECT_FALSE(map.contains(4000));
+}
+
+class PollerSparseFdTest : public ::testing::TestWithParam<PollerBackend> {};
+
+TEST_P(PollerSparseFdTest, HighFdRegistersAndRemoves) {
+  if (GetParam() == PollerBackend::kIoUring && !IoUringPoller::isSupported()) {
+    GTEST_SKIP() << "io_uring unavailable";
+  }
+  EventLoop loop(GetParam());
+  PipeFd pipeFd;
+  // Far above every descriptor opened so far.
+  const int highFd = ::fcntl(pipeFd.fds[0], F_DUPFD_CLOEXEC, 900);
+  ASSERT_GE(highFd, 900);
+
+  std::atomic<int> reads{0};
+  Channel channel(&loop, highFd);
+  channel.setReadCallback([&](Timestamp) {
+    char buf[16];
+    (void)::read(highFd, buf, sizeof buf);
+    reads.fetch_add(1, std::memory_order_relaxed);
+    loop.quit();
+  });
+  channel.enableReading();
+  EXPECT_TRUE(loop.hasChannel(&channel));
+  ASSERT_EQ(::write(pipeFd.fds[1], "x", 1), 1);
+  loop.loop();
+
+  channel.disableAll();
+  channel.remove();
+  EXPECT_FALSE(loop.hasChannel(&channel));
+  EXPECT_EQ(reads.load(std::memory_order_relaxed), 1);
+  ::close(highFd);
+}
+
+INSTANTIATE_TEST_SUITE_P(Pollers, PollerSparseFdTest,
+                         ::testing::Values(PollerBackend::kEPoll,
+                                           PollerBackend::kPoll,
+                                           PollerBackend::kIoUring));
+
 } // namespace
 } // namespace muduo::net
@@ -0,0 +1,309 @@
+#include "muduo/net/SegmentedBuffer.h"
+
+#include "muduo/net/EventLoop.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+using muduo::net::BufferPool;
+using muduo::net::SegmentedBuffer;
+
+namespace {
+
+constexpr size_t kSlab = SegmentedBuffer::kSlabSize;
+
+std::string pattern(size_t size) {
+  std::string s(size, '\0');
+  for (size_t i = 0; i < size; ++i) {
+    s[i] = static_cast<char>('a' + i % 23);
+  }
+  return s;
+}
+
+} // namespace
+
+TEST(SegmentedBufferTest, AllocatesNothingUntilAppend) {
+  SegmentedBuffer buf;
+  EXPECT_EQ(buf.readableBytes(), 0);
+  EXPECT_EQ(buf.internalCapacity(), 0);
+  EXPECT_EQ(buf.prependableBytes(), SegmentedBuffer::kCheapPrepend);
+  EXPECT_TRUE(buf.frontSpan().empty());
+}
+
+TEST(SegmentedBufferTest, AppendSpansSlabsWithoutMovingData) {
+  SegmentedBuffer buf;
+  buf.append(std::string_view{"x"});
+  const std::byte *first = buf.peek();
+
+  const std::string payload = pattern(3 * kSlab + 100);
+  buf.append(payload);
+  EXPECT_EQ(buf.readableBytes(), payload.size() + 1);
+  EXPECT_EQ(buf.numSlabs(), 4);
+  EXPECT_EQ(buf.peek(), first);
+  EXPECT_EQ(buf.frontSpan().size(), kSlab - SegmentedBuffer::kCheapPrepend);
+
+  EXPECT_EQ(buf.retrieveAsString(1), "x");
+  EXPECT_EQ(buf.retrieveAllAsString(), payload);
+  EXPECT_EQ(buf.readableBytes(), 0);
+  EXPECT_EQ(buf.prependableBytes(), SegmentedBuffer::kCheapPrepend);
+}
+
+TEST(SegmentedBufferTest, DrainedSlabsBecomeSpareCapacity) {
+  SegmentedBuffer buf;
+  const std::string payload = pattern(10 * kSlab);
+  buf.append(payload);
+  EXPECT_EQ(buf.numSlabs(), 11);
+
+  buf.retrieve(payload.size() - 5);
+  EXPECT_EQ(buf.readableBytes(), 5);
+  EXPECT_EQ(buf.numSlabs(), 1 + SegmentedBuffer::kMaxSpareSlabs);
+  EXPECT_GE(buf.writableBytes(), SegmentedBuffer::kMaxSpareSlabs * kSlab);
+
+  // Spares are reused before anything new is allocated.
+  buf.append(pattern(2 * kSlab));
+  EXPECT_EQ(buf.numSlabs(), 1 + SegmentedBuffer::kMaxSpareSlabs);
+  EXPECT_EQ(buf.retrieveAsString(5), payload.substr(payload.size() - 5));
+  EXPECT_EQ(buf.retrieveAllAsString(), pattern(2 * kSlab));
+
+  buf.shrink();
+  EXPECT_EQ(buf.internalCapacity(), 0);
+}
+
+TEST(SegmentedBufferTest, IntegersCrossSlabBoundaries) {
+  SegmentedBuffer buf;
+  buf.append(std::string(kSlab - SegmentedBuffer::kCheapPrepend - 3, 'p'));
+  buf.appendInt64(-0x0102030405060708);
+  buf.appendInt32(0x0a0b0c0d);
+  buf.appendInt16(-2);
+  buf.appendInt8(7);
+  buf.retrieve(kSlab - SegmentedBuffer::kCheapPrepend - 3);
+
+  EXPECT_EQ(buf.readableBytes(), 15);
+  EXPECT_EQ(buf.frontSpan().size(), 3);
+  EXPECT_EQ(buf.readInt64(), -0x0102030405060708);
+  EXPECT_EQ(buf.readInt32(), 0x0a0b0c0d);
+  EXPECT_EQ(buf.readInt16(), -2);
+  EXPECT_EQ(buf.readInt8(), 7);
+}
+
+TEST(SegmentedBufferTest, PrependUsesFrontHeadRoom) {
+  SegmentedBuffer buf;
+  buf.append(std::string_view{"body"});
+  buf.prependInt32(4);
+  EXPECT_EQ(buf.prependableBytes(), SegmentedBuffer::kCheapPrepend - 4);
+  EXPECT_EQ(buf.readInt32(), 4);
+  EXPECT_EQ(buf.retrieveAllAsString(), "body");
+
+  SegmentedBuffer empty;
+  empty.prependInt8(1);
+  EXPECT_EQ(empty.readableBytes(), 1);
+  EXPECT_EQ(empty.readInt8(), 1);
+}
+
+TEST(SegmentedBufferTest, ReadFdScattersOverSlabs) {
+  std::array<int, 2> fds{};
+  ASSERT_EQ(::pipe2(fds.data(), O_CLOEXEC), 0);
+  (void)::fcntl(fds[1], F_SETPIPE_SZ, 1 << 20);
+
+  const std::string payload = pattern(3 * kSlab + 5);
+  ASSERT_EQ(::write(fds[1], payload.data(), payload.size()),
+            static_cast<ssize_t>(payload.size()));
+
+  SegmentedBuffer buf;
+  buf.append(std::string_view{"head"});
+  size_t total = 0;
+  while (total < payload.size()) {
+    int savedErrno = 0;
+    const ssize_t n = buf.readFd(fds[0], &savedErrno);
+    ASSERT_GT(n, 0) << savedErrno;
+    total += static_cast<size_t>(n);
+  }
+  EXPECT_EQ(buf.retrieveAllAsString(), "head" + payload);
+
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+TEST(SegmentedBufferTest, WriteFdGathersAndKeepsTheRest) {
+  std::array<int, 2> fds{};
+  ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                         0, fds.data()),
+            0);
+
+  // More than the socket takes at once, so writes are partial.
+  const std::string payload = pattern(64 * kSlab + 17);
+  SegmentedBuffer out;
+  out.append(payload);
+  std::array<iovec, 4> iov{};
+  EXPECT_EQ(out.readableIovecs(iov), iov.size());
+
+  std::string received;
+  std::array<char, 65536> chunk{};
+  while (received.size() < payload.size()) {
+    if (!out.empty()) {
+      int savedErrno = 0;
+      const ssize_t n = out.writeFd(fds[0], &savedErrno);
+      ASSERT_TRUE(n > 0 || savedErrno == EAGAIN) << savedErrno;
+    }
+    const ssize_t n = ::read(fds[1], chunk.data(), chunk.size());
+    if (n > 0) {
+      received.append(chunk.data(), static_cast<size_t>(n));
+    }
+  }
+  EXPECT_TRUE(out.empty());
+  EXPECT_EQ(received, payload);
+
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+TEST(SegmentedBufferTest, PooledBufferReturnsSlabsWhenDrained) {
+  BufferPool pool;
+  {
+    SegmentedBuffer buf(&pool);
+    buf.append(pattern(3 * kSlab));
+    EXPECT_EQ(pool.stats().slabsInUse, 4);
+    EXPECT_EQ(pool.stats().freeSlabs, 0);
+
+    buf.retrieve(2 * kSlab);
+    EXPECT_EQ(pool.stats().slabsInUse, 2);
+    EXPECT_EQ(pool.stats().freeSlabs, 2);
+
+    buf.retrieveAll();
+    EXPECT_EQ(buf.internalCapacity(), 0);
+    EXPECT_EQ(pool.stats().slabsInUse, 0);
+    EXPECT_EQ(pool.stats().freeSlabs, 4);
+
+    // Reuses the pooled slabs.
+    buf.append(pattern(kSlab));
+    EXPECT_EQ(pool.stats().slabsInUse, 2);
+    EXPECT_EQ(pool.stats().freeSlabs, 2);
+  }
+  EXPECT_EQ(pool.stats().slabsInUse, 0);
+  EXPECT_EQ(pool.stats().freeSlabs, 4);
+
+  pool.setMaxFreeBytes(kSlab);
+  EXPECT_EQ(pool.stats().freeSlabs, 1);
+}
+
+TEST(SegmentedBufferTest, MovedBufferKeepsItsPool) {
+  BufferPool pool;
+  SegmentedBuffer buf(&pool);
+  buf.append(std::string_view{"moved"});
+
+  SegmentedBuffer other(std::move(buf));
+  EXPECT_EQ(other.pool(), &pool);
+  EXPECT_EQ(other.retrieveAllAsString(), "moved");
+  EXPECT_EQ(pool.stats().slabsInUse, 0);
+  EXPECT_EQ(buf.internalCapacity(), 0);
+}
+
+TEST(BufferPoolTest, TracksIdleConnections) {
+  BufferPool pool;
+  pool.addIdle(1, 2048);
+  pool.addIdle(1, 4096);
+  EXPECT_EQ(pool.stats().idleConnections, 2);
+  EXPECT_EQ(pool.stats().bytesPerIdleConnection(), 3072);
+  pool.addIdle(-2, -6144);
+  EXPECT_EQ(pool.stats().bytesPerIdleConnection(), 0);
+}
+
+TEST(BufferPoolTest, OneSweepChecksEveryWatchedConnection) {
+  using namespace std::chrono_literals;
+
+  muduo::net::EventLoop loop;
+  BufferPool *pool = loop.bufferPool();
+  int fast = 0;
+  int slow = 0;
+  int gone = 0;
+  const size_t fastHandle =
+      pool->watchIdle(20ms, BufferPool::IdleCheck([&fast] { ++fast; }));
+  (void)pool->watchIdle(1s, BufferPool::IdleCheck([&slow] { ++slow; }));
+  const size_t goneHandle =
+      pool->watchIdle(20ms, BufferPool::IdleCheck([&gone] { ++gone; }));
+  pool->unwatchIdle(goneHandle);
+
+  (void)loop.runAfter(105ms, [&loop] { loop.quit(); });
+  loop.loop();
+
+  // Swept at the shortest timeout's pace, all checks on the same wakeups.
+  EXPECT_GE(fast, 5);
+  EXPECT_EQ(slow, fast);
+  EXPECT_EQ(gone, 0);
+  pool->unwatchIdle(fastHandle);
+}
+
+TEST(SegmentedBufferTest, SlicesAreLinkedNotCopied) {
+  const std::string payload = pattern(3 * kSlab);
+  auto slice = muduo::net::ByteSlice::copyOf(payload);
+
+  SegmentedBuffer buf;
+  buf.append(std::string_view{"head:"});
+  buf.append(slice);
+  buf.append(std::string_view{":tail"});
+  EXPECT_EQ(slice.useCount(), 2);
+  EXPECT_EQ(buf.readableBytes(), payload.size() + 10);
+  EXPECT_EQ(buf.internalCapacity(), 2 * kSlab);
+
+  std::array<iovec, 4> iov{};
+  ASSERT_EQ(buf.readableIovecs(iov), 3);
+  EXPECT_EQ(iov[1].iov_base, slice.data());
+  EXPECT_EQ(iov[1].iov_len, slice.size());
+
+  EXPECT_EQ(buf.retrieveAsString(5), "head:");
+  EXPECT_EQ(buf.peek(), slice.data());
+  EXPECT_EQ(buf.prependableBytes(), 0);
+  EXPECT_EQ(buf.retrieveAsString(payload.size()), payload);
+  EXPECT_EQ(slice.useCount(), 1);
+  EXPECT_EQ(buf.retrieveAllAsString(), ":tail");
+}
+
+TEST(SegmentedBufferTest, SmallSlicesAreCopied) {
+  auto slice = muduo::net::ByteSlice::copyOf(std::string_view{"small"});
+  SegmentedBuffer buf;
+  buf.append(slice);
+  EXPECT_EQ(slice.useCount(), 1);
+  EXPECT_EQ(buf.retrieveAllAsString(), "small");
+}
+
+TEST(SegmentedBufferTest, SliceIntoDrainedBuffer) {
+  SegmentedBuffer buf;
+  buf.append(std::string_view{"x"});
+  buf.retrieveAll();
+  auto slice = muduo::net::ByteSlice(pattern(kSlab));
+  buf.append(slice);
+  buf.append(std::string_view{"y"});
+  EXPECT_EQ(buf.frontSpan().size(), kSlab);
+  EXPECT_EQ(buf.retrieveAllAsString(), pattern(kSlab) + "y");
+  EXPECT_EQ(slice.useCount(), 1);
+}
+
+TEST(ByteSliceTest, OwnsMovedStorage) {
+  std::string str = pattern(4096);
+  const char *data = str.data();
+  const muduo::net::ByteSlice fromString(std::move(str));
+  EXPECT_EQ(fromString.chars().data(), data);
+  EXPECT_EQ(fromString.subslice(4000).chars(), pattern(4096).substr(4000));
+
+  muduo::net::Buffer buffer;
+  buffer.append(std::string_view{"buffered"});
+  const auto *bytes = buffer.peek();
+  const muduo::net::ByteSlice fromBuffer(std::move(buffer));
+  EXPECT_EQ(fromBuffer.data(), bytes);
+  EXPECT_EQ(fromBuffer.chars(), "buffered");
+  EXPECT_EQ(buffer.readableBytes(), 0);
+
+  const auto copy = fromBuffer;
+  EXPECT_EQ(fromBuffer.useCount(), 2);
+  EXPECT_TRUE(muduo::net::ByteSlice().empty());
+}
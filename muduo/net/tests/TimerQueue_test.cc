@@ -1,5 +1,8 @@
 #include "muduo/net/EventLoop.h"
 #include "muduo/net/EventLoopThread.h"
+#include "muduo/net/Timer.h"
+#include "muduo/net/poller/IoUringPoller.h"
+#include "muduo/net/timer/TimingWheel.h"
 #include "muduo/base/CurrentThread.h"
 
 #include <gtest/gtest.h>
@@ -196,3 +199,290 @@ TEST_F(TimerQueueTest, RunAfterHighConcurrencyNoLoss) {
 
   EXPECT_EQ(fired.load(std::memory_order_acquire), kTotalTasks);
 }
+
+class TimerBackendTest
+    : public ::testing::TestWithParam<muduo::net::TimerBackend> {};
+
+TEST_P(TimerBackendTest, ExpiresInOrderAndCancels) {
+  using namespace std::chrono_literals;
+
+  muduo::net::EventLoop loop(muduo::net::PollerBackend::kDefault, GetParam());
+  std::vector<std::string> events;
+  const auto start = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::duration cascadedAfter{};
+
+  (void)loop.runAfter(5ms, [&] { events.emplace_back("5ms"); });
+  // Beyond level 0 of the wheel, so it has to cascade before it fires.
+  (void)loop.runAfter(150ms, [&] {
+    cascadedAfter = std::chrono::steady_clock::now() - start;
+    events.emplace_back("150ms");
+  });
+  const auto cancelled =
+      loop.runAfter(40ms, [&] { events.emplace_back("cancelled"); });
+  const auto far = loop.runAfter(1h, [&] { events.emplace_back("1h"); });
+  int ticks = 0;
+  muduo::net::TimerId every;
+  every = loop.runEvery(10ms, [&] {
+    if (++ticks == 3) {
+      loop.cancel(every);
+    }
+  });
+  (void)loop.runAfter(20ms, [&] { loop.cancel(cancelled); });
+  (void)loop.runAfter(200ms, [&] {
+    loop.cancel(far);
+    loop.quit();
+  });
+  loop.loop();
+
+  EXPECT_EQ(events, (std::vector<std::string>{"5ms", "150ms"}));
+  EXPECT_GE(cascadedAfter, 150ms);
+  EXPECT_EQ(ticks, 3);
+}
+
+TEST_P(TimerBackendTest, ManyTimersWithCancellation) {
+  using namespace std::chrono_literals;
+
+  muduo::net::EventLoop loop(muduo::net::PollerBackend::kDefault, GetParam());
+  constexpr int kTimers = 10'000;
+  std::vector<muduo::net::TimerId> ids;
+  ids.reserve(kTimers);
+  int fired = 0;
+  for (int i = 0; i < kTimers; ++i) {
+    ids.push_back(loop.runAfter(std::chrono::microseconds(i * 7 % 80'000),
+                                [&fired] { ++fired; }));
+  }
+  for (int i = 0; i < kTimers; i += 2) {
+    loop.cancel(ids[static_cast<size_t>(i)]);
+  }
+  (void)loop.runAfter(150ms, [&loop] { loop.quit(); });
+  loop.loop();
+
+  EXPECT_EQ(fired, kTimers / 2);
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, TimerBackendTest,
+                         ::testing::Values(muduo::net::TimerBackend::kSet,
+                                           muduo::net::TimerBackend::kWheel));
+
+TEST_P(TimerBackendTest, SlackCoalescesJitteredTimers) {
+  using namespace std::chrono_literals;
+
+  muduo::net::EventLoop loop(muduo::net::PollerBackend::kDefault, GetParam());
+  constexpr int kTimers = 200;
+  int fired = 0;
+  bool early = false;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kTimers; ++i) {
+    // Heartbeats jittered over 4 ms, each willing to run 20 ms late.
+    const auto delay = 50ms + std::chrono::microseconds(i * 20);
+    (void)loop.runAfter(delay, 20ms, [&, delay] {
+      early = early || std::chrono::steady_clock::now() - start < delay;
+      ++fired;
+    });
+  }
+  (void)loop.runAfter(150ms, [&loop] { loop.quit(); });
+  loop.loop();
+
+  EXPECT_EQ(fired, kTimers);
+  EXPECT_FALSE(early);
+  const auto stats = loop.timerStats();
+  EXPECT_EQ(stats.expiredTimers, kTimers + 1);
+  // A couple of passes for the heartbeats, one for quit().
+  EXPECT_LE(stats.wakeups, 4);
+  EXPECT_GE(stats.coalescedWakeups, kTimers - 3);
+}
+
+TEST_P(TimerBackendTest, RunEveryWithSlackKeepsRepeating) {
+  using namespace std::chrono_literals;
+
+  muduo::net::EventLoop loop(muduo::net::PollerBackend::kDefault, GetParam());
+  int ticks = 0;
+  (void)loop.runEvery(5ms, 3ms, [&ticks] { ++ticks; });
+  (void)loop.runAfter(100ms, [&loop] { loop.quit(); });
+  loop.loop();
+
+  // At most 8 ms per period.
+  EXPECT_GE(ticks, 10);
+  EXPECT_LE(ticks, 20);
+}
+
+TEST(TimerTest, CoalesceStaysInsideTheSlackWindow) {
+  using namespace std::chrono_literals;
+
+  const muduo::Timestamp base = muduo::Timestamp::now();
+  EXPECT_EQ(muduo::net::Timer::coalesce(base, 0us), base);
+  const std::vector<std::chrono::microseconds> slacks{1us, 7us, 1ms, 20ms, 1s};
+  for (const auto slack : slacks) {
+    for (int i = 0; i < 100; ++i) {
+      const auto when =
+          muduo::Timestamp(base.microSecondsSinceEpoch() + i * 37);
+      const auto at = muduo::net::Timer::coalesce(when, slack);
+      EXPECT_GE(at, when);
+      EXPECT_LE(at.microSecondsSinceEpoch(),
+                when.microSecondsSinceEpoch() + slack.count());
+    }
+  }
+  // Overlapping windows agree on a common time.
+  const auto low = muduo::Timestamp(1'000'000'123);
+  EXPECT_EQ(muduo::net::Timer::coalesce(low, 10ms),
+            muduo::net::Timer::coalesce(
+                muduo::Timestamp(low.microSecondsSinceEpoch() + 500), 10ms));
+}
+
+class DeadlinePollingTest
+    : public ::testing::TestWithParam<muduo::net::PollerBackend> {
+protected:
+  void SetUp() override {
+    if (GetParam() == muduo::net::PollerBackend::kIoUring &&
+        !muduo::net::IoUringPoller::isSupported()) {
+      GTEST_SKIP() << "io_uring unavailable";
+    }
+  }
+};
+
+TEST_P(DeadlinePollingTest, ExpiresWithoutTimerfd) {
+  using namespace std::chrono_literals;
+
+  muduo::net::EventLoop loop(GetParam());
+  loop.setDeadlinePolling(true);
+  EXPECT_TRUE(loop.deadlinePolling());
+
+  std::vector<std::string> events;
+  (void)loop.runAfter(8ms, [&] { events.emplace_back("8ms"); });
+  (void)loop.runAfter(3ms, [&] { events.emplace_back("3ms"); });
+  const auto cancelled =
+      loop.runAfter(20ms, [&] { events.emplace_back("cancelled"); });
+  int ticks = 0;
+  muduo::net::TimerId every;
+  every = loop.runEvery(5ms, [&] {
+    if (++ticks == 3) {
+      loop.cancel(every);
+    }
+  });
+  (void)loop.runAfter(10ms, [&] { loop.cancel(cancelled); });
+  // Added from another thread while the loop sleeps with a long timeout.
+  std::jthread adder([&loop, &events] {
+    std::this_thread::sleep_for(30ms);
+    loop.runInLoop([&loop, &events] {
+      (void)loop.runAfter(1ms, [&loop, &events] {
+        events.emplace_back("late");
+        loop.quit();
+      });
+    });
+  });
+  loop.loop();
+
+  EXPECT_EQ(events, (std::vector<std::string>{"3ms", "8ms", "late"}));
+  EXPECT_EQ(ticks, 3);
+}
+
+TEST_P(DeadlinePollingTest, SubMillisecondTimeouts) {
+  using namespace std::chrono_literals;
+
+  // The wheel would round up to its 1 ms tick.
+  muduo::net::EventLoop loop(GetParam(), muduo::net::TimerBackend::kSet);
+  loop.setDeadlinePolling(true);
+
+  // Each timer arms the next; rounding the poll timeout up to whole
+  // milliseconds would take at least kChain ms.
+  constexpr int kChain = 100;
+  int fired = 0;
+  muduo::net::TimerCallback next;
+  next = muduo::net::TimerCallback([&] {
+    if (++fired == kChain) {
+      loop.quit();
+    } else {
+      (void)loop.runAfter(100us, [&next] { next(); });
+    }
+  });
+  const auto start = std::chrono::steady_clock::now();
+  (void)loop.runAfter(100us, [&next] { next(); });
+  loop.loop();
+
+  EXPECT_EQ(fired, kChain);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, kChain * 1ms);
+}
+
+INSTANTIATE_TEST_SUITE_P(Pollers, DeadlinePollingTest,
+                         ::testing::Values(muduo::net::PollerBackend::kEPoll,
+                                           muduo::net::PollerBackend::kPoll,
+                                           muduo::net::PollerBackend::kIoUring));
+
+namespace {
+
+muduo::Timestamp after(muduo::Timestamp time,
+                       std::chrono::microseconds delay) {
+  return muduo::Timestamp(time.timePoint() + delay);
+}
+
+} // namespace
+
+TEST(TimingWheelTest, NeverFiresEarlyAcrossLevels) {
+  using namespace std::chrono_literals;
+
+  muduo::net::TimingWheel wheel;
+  const muduo::Timestamp base = muduo::Timestamp::now();
+  const std::vector<std::chrono::microseconds> delays{
+      0us, 3ms, 64ms, 65ms, 4100ms, 300s, 5h, 1000h * 24};
+  std::vector<std::int64_t> sequences;
+  for (const auto delay : delays) {
+    const auto sequence = muduo::net::Timer::newSequence();
+    wheel.add({}, after(base, delay), {}, sequence, {});
+    sequences.push_back(sequence);
+  }
+  ASSERT_EQ(wheel.size(), delays.size());
+
+  std::vector<muduo::net::Timer *> expired;
+  for (size_t i = 0; i < delays.size(); ++i) {
+    const auto due = after(base, delays[i]);
+    // Just before the previous one's tick rounding could reach it.
+    wheel.takeExpired(after(due, -1us), expired);
+    EXPECT_TRUE(expired.empty()) << "delay " << delays[i].count();
+    const auto next = wheel.nextExpiration();
+    ASSERT_TRUE(next.valid());
+    EXPECT_LE(next, after(due, muduo::net::TimingWheel::kTick));
+
+    wheel.takeExpired(after(due, muduo::net::TimingWheel::kTick),
+                      expired);
+    ASSERT_EQ(expired.size(), 1u) << "delay " << delays[i].count();
+    EXPECT_EQ(expired.front()->sequence(), sequences[i]);
+    EXPECT_GE(expired.front()->expiration(), base);
+    wheel.release(*expired.front());
+    expired.clear();
+  }
+  EXPECT_EQ(wheel.size(), 0u);
+  EXPECT_FALSE(wheel.nextExpiration().valid());
+}
+
+TEST(TimingWheelTest, CancelAndRestartRecycleNodes) {
+  using namespace std::chrono_literals;
+
+  muduo::net::TimingWheel wheel;
+  const muduo::Timestamp base = muduo::Timestamp::now();
+  const auto repeating = muduo::net::Timer::newSequence();
+  wheel.add({}, after(base, 10ms), 10ms, repeating, {});
+  const auto once = muduo::net::Timer::newSequence();
+  wheel.add({}, after(base, 2s), {}, once, {});
+
+  EXPECT_TRUE(wheel.cancel(once));
+  EXPECT_FALSE(wheel.cancel(once));
+  EXPECT_EQ(wheel.size(), 1u);
+
+  std::vector<muduo::net::Timer *> expired;
+  muduo::Timestamp now = after(base, 11ms);
+  wheel.takeExpired(now, expired);
+  ASSERT_EQ(expired.size(), 1u);
+  // Taken out for running: not cancellable until it is handed back.
+  EXPECT_FALSE(wheel.cancel(repeating));
+  wheel.restart(*expired.front(), now);
+  expired.clear();
+  EXPECT_EQ(wheel.size(), 1u);
+
+  now = after(now, 11ms);
+  wheel.takeExpired(now, expired);
+  ASSERT_EQ(expired.size(), 1u);
+  wheel.restart(*expired.front(), now);
+  expired.clear();
+  EXPECT_TRUE(wheel.cancel(repeating));
+  EXPECT_EQ(wheel.size(), 0u);
+}
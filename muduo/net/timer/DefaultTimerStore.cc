@@ -0,0 +1,24 @@
+#include "muduo/net/timer/TimerStore.h"
+
+#include "muduo/net/EventLoop.h"
+#include "muduo/net/timer/SetTimerStore.h"
+#include "muduo/net/timer/TimingWheel.h"
+
+#include <cstdlib>
+
+using namespace muduo::net;
+
+std::unique_ptr<TimerStore> TimerStore::newTimerStore(TimerBackend backend) {
+  switch (backend) {
+  case TimerBackend::kSet:
+    return std::make_unique<SetTimerStore>();
+  case TimerBackend::kWheel:
+    return std::make_unique<TimingWheel>();
+  case TimerBackend::kDefault:
+  default:
+    if (::getenv("MUDUO_TIMER_WHEEL") != nullptr) {
+      return std::make_unique<TimingWheel>();
+    }
+    return std::make_unique<SetTimerStore>();
+  }
+}
@@ -0,0 +1,64 @@
+#include "muduo/net/timer/SetTimerStore.h"
+
+#include "muduo/net/Timer.h"
+
+#include <cassert>
+#include <limits>
+
+using namespace muduo;
+using namespace muduo::net;
+
+SetTimerStore::SetTimerStore() = default;
+
+SetTimerStore::~SetTimerStore() = default;
+
+void SetTimerStore::add(TimerCallback cb, Timestamp when,
+                        std::chrono::microseconds interval,
+                        std::int64_t sequence,
+                        std::chrono::microseconds slack) {
+  auto timer =
+      std::make_unique<Timer>(std::move(cb), when, interval, sequence, slack);
+  [[maybe_unused]] const auto [timerIt, timerInserted] =
+      timers_.insert(Entry(timer->expiration(), sequence));
+  assert(timerInserted);
+  [[maybe_unused]] const auto [ownerIt, ownerInserted] =
+      timerOwners_.emplace(sequence, std::move(timer));
+  assert(ownerInserted);
+}
+
+bool SetTimerStore::cancel(std::int64_t sequence) {
+  const auto ownerIt = timerOwners_.find(sequence);
+  if (ownerIt == timerOwners_.end() ||
+      timers_.erase(Entry(ownerIt->second->expiration(), sequence)) == 0) {
+    return false;
+  }
+  timerOwners_.erase(ownerIt);
+  return true;
+}
+
+void SetTimerStore::takeExpired(Timestamp now, std::vector<Timer *> &expired) {
+  const auto sentry = Entry(now, std::numeric_limits<TimerSequence>::max());
+  const auto end = timers_.upper_bound(sentry);
+  for (auto it = timers_.begin(); it != end; ++it) {
+    const auto ownerIt = timerOwners_.find(it->second);
+    assert(ownerIt != timerOwners_.end());
+    expired.push_back(ownerIt->second.get());
+  }
+  timers_.erase(timers_.begin(), end);
+}
+
+void SetTimerStore::restart(Timer &timer, Timestamp now) {
+  timer.restart(now);
+  [[maybe_unused]] const auto [timerIt, timerInserted] =
+      timers_.insert(Entry(timer.expiration(), timer.sequence()));
+  assert(timerInserted);
+}
+
+void SetTimerStore::release(Timer &timer) {
+  [[maybe_unused]] const auto erased = timerOwners_.erase(timer.sequence());
+  assert(erased == 1);
+}
+
+Timestamp SetTimerStore::nextExpiration() const {
+  return timers_.empty() ? Timestamp::invalid() : timers_.begin()->first;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "muduo/net/timer/TimerStore.h"
+
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+namespace muduo::net {
+
+// Timers ordered by (expiration, sequence) in a balanced tree: O(log n) add
+// and cancel, and expiry in exact expiration order.
+class SetTimerStore : public TimerStore {
+public:
+  SetTimerStore();
+  ~SetTimerStore() override;
+
+  void add(TimerCallback cb, Timestamp when, std::chrono::microseconds interval,
+           std::int64_t sequence, std::chrono::microseconds slack) override;
+  bool cancel(std::int64_t sequence) override;
+  void takeExpired(Timestamp now, std::vector<Timer *> &expired) override;
+  void restart(Timer &timer, Timestamp now) override;
+  void release(Timer &timer) override;
+
+  [[nodiscard]] Timestamp nextExpiration() const override;
+  [[nodiscard]] size_t size() const override { return timers_.size(); }
+
+private:
+  using TimerSequence = std::int64_t;
+  using Entry = std::pair<Timestamp, TimerSequence>;
+  using TimerList = std::set<Entry>;
+  // Pending and expired timers.
+  using TimerOwnerMap =
+      std::unordered_map<TimerSequence, std::unique_ptr<Timer>>;
+
+  TimerList timers_;
+  TimerOwnerMap timerOwners_;
+};
+
+} // namespace muduo::net
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "muduo/base/Timestamp.h"
+#include "muduo/base/noncopyable.h"
+#include "muduo/net/Callbacks.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace muduo::net {
+
+class Timer;
+enum class TimerBackend : std::uint8_t;
+
+// Pending timers of one TimerQueue, ordered by expiration. Owns the Timer
+// objects; the queue only drives expiry and the timerfd. Loop thread only.
+//
+// A timer taken out by takeExpired() stays alive, but is no longer pending,
+// until the queue hands it back through restart() or release().
+class TimerStore : muduo::noncopyable {
+public:
+  virtual ~TimerStore() = default;
+
+  // Keyed on Timer::expiration(), i.e. when after slack coalescing.
+  virtual void add(TimerCallback cb, Timestamp when,
+                   std::chrono::microseconds interval, std::int64_t sequence,
+                   std::chrono::microseconds slack) = 0;
+  // Destroys the timer if it is pending; false for unknown sequences and
+  // timers taken out by takeExpired().
+  virtual bool cancel(std::int64_t sequence) = 0;
+  // Appends the timers due at now to expired.
+  virtual void takeExpired(Timestamp now, std::vector<Timer *> &expired) = 0;
+  // Makes an expired repeating timer pending again, from now.
+  virtual void restart(Timer &timer, Timestamp now) = 0;
+  virtual void release(Timer &timer) = 0;
+
+  // When takeExpired() has to run next; invalid if nothing is pending. Never
+  // later than the earliest expiration.
+  [[nodiscard]] virtual Timestamp nextExpiration() const = 0;
+  [[nodiscard]] virtual size_t size() const = 0;
+
+  [[nodiscard]] static std::unique_ptr<TimerStore>
+  newTimerStore(TimerBackend backend);
+};
+
+} // namespace muduo::net
@@ -0,0 +1,226 @@
+#include "muduo/net/timer/TimingWheel.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <limits>
+
+using namespace muduo;
+using namespace muduo::net;
+
+static_assert(TimingWheel::kSlots == 64, "occupied_ holds one bit per slot");
+
+namespace {
+
+constexpr std::int64_t kNoTick = std::numeric_limits<std::int64_t>::max();
+constexpr std::int64_t kMaxDelta =
+    (std::int64_t{1} << (TimingWheel::kSlotBits * TimingWheel::kLevels)) - 1;
+
+[[nodiscard]] constexpr int levelShift(int level) {
+  return level * TimingWheel::kSlotBits;
+}
+
+} // namespace
+
+TimingWheel::TimingWheel()
+    : currentTick_(floorTick(Timestamp::now())),
+      indexBySequence_(&indexPool_) {
+  heads_.fill(kNil);
+  tails_.fill(kNil);
+}
+
+TimingWheel::~TimingWheel() = default;
+
+std::int64_t TimingWheel::floorTick(Timestamp time) {
+  return time.microSecondsSinceEpoch() / kTick.count();
+}
+
+std::int64_t TimingWheel::ceilTick(Timestamp time) {
+  return (time.microSecondsSinceEpoch() + kTick.count() - 1) / kTick.count();
+}
+
+void TimingWheel::add(TimerCallback cb, Timestamp when,
+                      std::chrono::microseconds interval,
+                      std::int64_t sequence,
+                      std::chrono::microseconds slack) {
+  // Slots are relative to currentTick_, which only moves in takeExpired().
+  // Catch up over idle time so that a short timer lands on level 0.
+  const std::int64_t nowTick = floorTick(Timestamp::now());
+  if (nowTick > currentTick_) {
+    currentTick_ =
+        std::max(currentTick_, std::min(nowTick, nextWorkTick() - 1));
+  }
+
+  NodeIndex index = kNil;
+  if (freeNodes_.empty()) {
+    index = static_cast<NodeIndex>(nodes_.size());
+    nodes_.emplace_back();
+  } else {
+    index = freeNodes_.back();
+    freeNodes_.pop_back();
+  }
+  nodes_[index].timer.emplace(std::move(cb), when, interval, sequence, slack);
+  [[maybe_unused]] const auto [it, inserted] =
+      indexBySequence_.emplace(sequence, index);
+  assert(inserted);
+  place(index);
+}
+
+bool TimingWheel::cancel(std::int64_t sequence) {
+  const NodeIndex index = indexOf(sequence);
+  if (index == kNil || nodes_[index].slot == kNoSlot) {
+    return false;
+  }
+  unlink(index);
+  release(*nodes_[index].timer);
+  return true;
+}
+
+void TimingWheel::takeExpired(Timestamp now, std::vector<Timer *> &expired) {
+  const std::int64_t target = floorTick(now);
+  moveSlot(kDueSlot, expired);
+  for (std::int64_t tick = nextWorkTick(); tick <= target;
+       tick = nextWorkTick()) {
+    currentTick_ = tick;
+    for (int level = kLevels - 1; level > 0; --level) {
+      const std::int64_t mask = (std::int64_t{1} << levelShift(level)) - 1;
+      if ((tick & mask) == 0) {
+        cascade(level,
+                static_cast<int>((tick >> levelShift(level)) & (kSlots - 1)));
+      }
+    }
+    moveSlot(static_cast<int>(tick & (kSlots - 1)), expired);
+    moveSlot(kDueSlot, expired);
+  }
+  currentTick_ = std::max(currentTick_, target);
+}
+
+void TimingWheel::restart(Timer &timer, Timestamp now) {
+  const NodeIndex index = indexOf(timer.sequence());
+  assert(index != kNil && nodes_[index].slot == kNoSlot);
+  timer.restart(now);
+  place(index);
+}
+
+void TimingWheel::release(Timer &timer) {
+  const auto it = indexBySequence_.find(timer.sequence());
+  assert(it != indexBySequence_.end());
+  const NodeIndex index = it->second;
+  indexBySequence_.erase(it);
+  assert(nodes_[index].slot == kNoSlot);
+  nodes_[index].timer.reset();
+  freeNodes_.push_back(index);
+}
+
+Timestamp TimingWheel::nextExpiration() const {
+  if (heads_[kDueSlot] != kNil) {
+    return Timestamp(currentTick_ * kTick.count());
+  }
+  const std::int64_t tick = nextWorkTick();
+  return tick == kNoTick ? Timestamp::invalid()
+                         : Timestamp(tick * kTick.count());
+}
+
+std::int64_t TimingWheel::nextWorkTick() const {
+  std::int64_t next = kNoTick;
+  for (int level = 0; level < kLevels; ++level) {
+    const std::uint64_t occupied = occupied_[static_cast<size_t>(level)];
+    if (occupied == 0) {
+      continue;
+    }
+    // Slot n of a level is due at the start of the next span whose index is
+    // n modulo kSlots; a level 0 span is one tick.
+    const std::int64_t span = currentTick_ >> levelShift(level);
+    const int from = static_cast<int>((span + 1) & (kSlots - 1));
+    const int ahead = std::countr_zero(std::rotr(occupied, from));
+    next = std::min(next, (span + 1 + ahead) << levelShift(level));
+  }
+  return next;
+}
+
+void TimingWheel::place(NodeIndex index) {
+  Node &node = nodes_[index];
+  const std::int64_t expiry = ceilTick(node.timer->expiration());
+  const std::int64_t delta = expiry - currentTick_;
+  if (delta <= 0) {
+    link(index, kDueSlot);
+    return;
+  }
+  // Timers beyond the top level sit in its last reachable slot and are
+  // placed again from there.
+  const std::int64_t reach = std::min(delta, kMaxDelta);
+  int level = 0;
+  while (level < kLevels - 1 &&
+         reach >= (std::int64_t{1} << levelShift(level + 1))) {
+    ++level;
+  }
+  const auto slot = static_cast<int>(
+      ((currentTick_ + reach) >> levelShift(level)) & (kSlots - 1));
+  link(index, level * kSlots + slot);
+}
+
+void TimingWheel::link(NodeIndex index, int slot) {
+  Node &node = nodes_[index];
+  assert(node.slot == kNoSlot);
+  node.slot = slot;
+  node.prev = tails_[static_cast<size_t>(slot)];
+  node.next = kNil;
+  if (node.prev == kNil) {
+    heads_[static_cast<size_t>(slot)] = index;
+  } else {
+    nodes_[node.prev].next = index;
+  }
+  tails_[static_cast<size_t>(slot)] = index;
+  if (slot != kDueSlot) {
+    occupied_[static_cast<size_t>(slot / kSlots)] |= std::uint64_t{1}
+                                                     << (slot % kSlots);
+  }
+  ++size_;
+}
+
+void TimingWheel::unlink(NodeIndex index) {
+  Node &node = nodes_[index];
+  const auto slot = static_cast<size_t>(node.slot);
+  if (node.prev == kNil) {
+    heads_[slot] = node.next;
+  } else {
+    nodes_[node.prev].next = node.next;
+  }
+  if (node.next == kNil) {
+    tails_[slot] = node.prev;
+  } else {
+    nodes_[node.next].prev = node.prev;
+  }
+  if (heads_[slot] == kNil && node.slot != kDueSlot) {
+    occupied_[slot / kSlots] &= ~(std::uint64_t{1} << (slot % kSlots));
+  }
+  node.slot = kNoSlot;
+  node.prev = kNil;
+  node.next = kNil;
+  --size_;
+}
+
+void TimingWheel::cascade(int level, int slot) {
+  NodeIndex index = heads_[static_cast<size_t>(level * kSlots + slot)];
+  while (index != kNil) {
+    const NodeIndex next = nodes_[index].next;
+    unlink(index);
+    place(index);
+    index = next;
+  }
+}
+
+void TimingWheel::moveSlot(int slot, std::vector<Timer *> &expired) {
+  NodeIndex index = heads_[static_cast<size_t>(slot)];
+  while (index != kNil) {
+    const NodeIndex next = nodes_[index].next;
+    unlink(index);
+    expired.push_back(&*nodes_[index].timer);
+    index = next;
+  }
+}
+
+TimingWheel::NodeIndex TimingWheel::indexOf(std::int64_t sequence) const {
+  const auto it = indexBySequence_.find(sequence);
+  return it == indexBySequence_.end() ? kNil : it->second;
+}
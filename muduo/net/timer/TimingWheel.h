@@ -0,0 +1,89 @@
+#pragma once
+
+#include "muduo/net/Timer.h"
+#include "muduo/net/timer/TimerStore.h"
+
+#include <array>
+#include <deque>
+#include <memory_resource>
+#include <optional>
+#include <unordered_map>
+
+namespace muduo::net {
+
+// Hierarchical timing wheel: kLevels wheels of kSlots slots, level n slot
+// spanning kSlots^n ticks of kTick. add() and cancel() are O(1): a timer is
+// linked into the slot of its expiry tick, and moved one level down when
+// the wheel reaches the start of that slot ("cascading"). Timers in one
+// tick expire together, in insertion order.
+//
+// Expiry is rounded up to the next tick, so a timer never fires early but
+// may fire up to kTick late. Nodes come from a slab and are recycled through
+// a free list.
+class TimingWheel : public TimerStore {
+public:
+  static constexpr std::chrono::microseconds kTick{1000};
+  static constexpr int kSlotBits = 6;
+  static constexpr int kSlots = 1 << kSlotBits;
+  // 2^36 ticks, about 795 days; later timers are parked at the far end and
+  // placed again when they get there.
+  static constexpr int kLevels = 6;
+
+  TimingWheel();
+  ~TimingWheel() override;
+
+  void add(TimerCallback cb, Timestamp when, std::chrono::microseconds interval,
+           std::int64_t sequence, std::chrono::microseconds slack) override;
+  bool cancel(std::int64_t sequence) override;
+  void takeExpired(Timestamp now, std::vector<Timer *> &expired) override;
+  void restart(Timer &timer, Timestamp now) override;
+  void release(Timer &timer) override;
+
+  // May be the start of a slot that has to cascade rather than an expiry.
+  [[nodiscard]] Timestamp nextExpiration() const override;
+  [[nodiscard]] size_t size() const override { return size_; }
+
+private:
+  using NodeIndex = std::uint32_t;
+  static constexpr NodeIndex kNil = UINT32_MAX;
+  static constexpr int kNumSlots = kLevels * kSlots;
+  // Past-due timers, expired by the next takeExpired().
+  static constexpr int kDueSlot = kNumSlots;
+  // Taken out by takeExpired(), not linked anywhere.
+  static constexpr int kNoSlot = -1;
+
+  struct Node {
+    std::optional<Timer> timer;
+    NodeIndex prev{kNil};
+    NodeIndex next{kNil};
+    int slot{kNoSlot};
+  };
+
+  [[nodiscard]] static std::int64_t floorTick(Timestamp time);
+  [[nodiscard]] static std::int64_t ceilTick(Timestamp time);
+  // First tick after currentTick_ with a slot to expire or cascade.
+  [[nodiscard]] std::int64_t nextWorkTick() const;
+
+  void place(NodeIndex index);
+  void link(NodeIndex index, int slot);
+  void unlink(NodeIndex index);
+  void cascade(int level, int slot);
+  void moveSlot(int slot, std::vector<Timer *> &expired);
+  [[nodiscard]] NodeIndex indexOf(std::int64_t sequence) const;
+
+  // Slab of nodes; a deque never moves them.
+  std::deque<Node> nodes_;
+  std::vector<NodeIndex> freeNodes_;
+  std::array<NodeIndex, kNumSlots + 1> heads_;
+  std::array<NodeIndex, kNumSlots + 1> tails_;
+  // Bit n of occupied_[level] is set while slot n of that level is non-empty.
+  std::array<std::uint64_t, kLevels> occupied_{};
+  // Every tick up to and including this one has been processed.
+  std::int64_t currentTick_;
+  size_t size_{0};
+
+  std::pmr::unsynchronized_pool_resource indexPool_;
+  std::pmr::unordered_map<std::int64_t, NodeIndex> indexBySequence_;
+};
+
+} // namespace muduo::net